@@ -0,0 +1,45 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import climate
+from esphome.const import CONF_ID
+
+CODEOWNERS = ["@sven819"]
+AUTO_LOAD = ["climate"]
+
+sharp_ac_ns = cg.esphome_ns.namespace("sharp_ac")
+SharpAcNode = sharp_ac_ns.class_("SharpAcNode", cg.Component)
+SharpAcGroup = sharp_ac_ns.class_("SharpAcGroup", climate.Climate, cg.Component)
+
+CONF_HANDSHAKE_SPACING = "handshake_spacing"
+CONF_REPORT_INTERVAL = "report_interval"
+CONF_GROUP = "group"
+
+# One climate entity that sets all units of the node with a single call
+GROUP_SCHEMA = climate.climate_schema(SharpAcGroup).extend(
+    {cv.GenerateID(): cv.declare_id(SharpAcGroup)}
+).extend(cv.COMPONENT_SCHEMA)
+
+# Optional `sharp_ac:` block for nodes with several units, every sharp_ac
+# climate joins it, see climate.py
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(SharpAcNode),
+        cv.Optional(CONF_HANDSHAKE_SPACING, default="500ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_REPORT_INTERVAL, default="0s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_GROUP): GROUP_SCHEMA,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    cg.add(var.setSpacing(config[CONF_HANDSHAKE_SPACING].total_milliseconds))
+    cg.add(var.setReportInterval(config[CONF_REPORT_INTERVAL].total_milliseconds))
+    await cg.register_component(var, config)
+
+    if CONF_GROUP in config:
+        conf = config[CONF_GROUP]
+        group = cg.new_Pvariable(conf[CONF_ID])
+        await cg.register_parented(group, var)
+        await climate.register_climate(group, conf)
+        await cg.register_component(group, conf)
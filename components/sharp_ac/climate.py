@@ -1,14 +1,22 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import climate, uart, select, switch, text_sensor, button
-from esphome.const import CONF_ID
+from esphome.const import CONF_ID, CONF_BAUD_RATE
+from esphome.core import CORE
+from . import sharp_ac_ns
 
-AUTO_LOAD = ["climate", "uart", "select", "switch", "text_sensor", "button"]
 CODEOWNERS = ["@sven819"]
 
+
+def AUTO_LOAD():
+    # The host platform has no UART component, see CONF_SERIAL_PORT
+    if CORE.is_host:
+        return ["climate", "select", "switch", "text_sensor", "button"]
+    return ["climate", "uart", "select", "switch", "text_sensor", "button"]
+
+
 CONF_SHARP_ID = "sharp_id"
 
-sharp_ac_ns = cg.esphome_ns.namespace("sharp_ac")
 SharpAc = sharp_ac_ns.class_("SharpAc", climate.Climate,uart.UARTDevice, cg.Component)
 
 VaneSelectVertical = sharp_ac_ns.class_("VaneSelectVertical", select.Select, cg.Component)
@@ -17,12 +25,18 @@ VaneSelectHorizontal = sharp_ac_ns.class_("VaneSelectHorizontal", select.Select,
 IonSwitch = sharp_ac_ns.class_("IonSwitch", switch.Switch)
 ConnectionStatusSensor = sharp_ac_ns.class_("ConnectionStatusSensor", text_sensor.TextSensor, cg.Component)
 ReconnectButton = sharp_ac_ns.class_("ReconnectButton", button.Button, cg.Component)
+TraceDumpButton = sharp_ac_ns.class_("TraceDumpButton", button.Button, cg.Component)
 
 CONF_HORIZONTAL_SWING_SELECT = "horizontal_vane_select"
 CONF_VERTICAL_SWING_SELECT = "vertical_vane_select"
 CONF_ION_SWITCH = "ion_switch"
 CONF_CONNECTION_STATUS = "connection_status"
 CONF_RECONNECT_BUTTON = "reconnect_button"
+CONF_FRAME_GAP = "frame_gap"
+CONF_TX_QUIET = "tx_quiet"
+CONF_TRACE_BUFFER_SIZE = "trace_buffer_size"
+CONF_TRACE_DUMP_BUTTON = "trace_dump_button"
+CONF_SERIAL_PORT = "serial_port"
 
 HORIZONTAL_SWING_OPTIONS = ["swing","left","center","right"]
 VERTICAL_SWING_OPTIONS = ["auto", "swing" , "up" , "up_center", "center", "down_center", "down"]
@@ -51,19 +65,48 @@ RECONNECT_BUTTON_SCHEMA = button.button_schema(ReconnectButton).extend(
     {cv.GenerateID(CONF_ID): cv.declare_id(ReconnectButton)}
 )
 
-CONFIG_SCHEMA = climate.climate_schema(SharpAc).extend(
+TRACE_DUMP_BUTTON_SCHEMA = button.button_schema(TraceDumpButton).extend(
+    {cv.GenerateID(CONF_ID): cv.declare_id(TraceDumpButton)}
+)
+
+BASE_SCHEMA = climate.climate_schema(SharpAc).extend(
     {
         cv.GenerateID(): cv.declare_id(SharpAc),
         cv.Optional(CONF_HORIZONTAL_SWING_SELECT): SELECT_SCHEMA_HORIZONTAL,
         cv.Optional(CONF_VERTICAL_SWING_SELECT): SELECT_SCHEMA_VERTICAL,
         cv.Optional(CONF_ION_SWITCH): ION_SCHEMA,
         cv.Optional(CONF_CONNECTION_STATUS): CONNECTION_STATUS_SCHEMA,
-        cv.Optional(CONF_RECONNECT_BUTTON): RECONNECT_BUTTON_SCHEMA
+        cv.Optional(CONF_RECONNECT_BUTTON): RECONNECT_BUTTON_SCHEMA,
+        cv.Optional(CONF_FRAME_GAP, default=4): cv.int_range(min=2, max=255),
+        cv.Optional(CONF_TX_QUIET, default=2): cv.int_range(min=0, max=255),
+        cv.Optional(CONF_TRACE_BUFFER_SIZE, default=0): cv.int_range(min=0, max=16384),
+        cv.Optional(CONF_TRACE_DUMP_BUTTON): TRACE_DUMP_BUTTON_SCHEMA
     }
-).extend(uart.UART_DEVICE_SCHEMA)
+)
+
+UART_SCHEMA = BASE_SCHEMA.extend(uart.UART_DEVICE_SCHEMA)
+
+# On the host platform the component opens the serial device itself, a USB
+# serial adapter on CN13 or a pty
+HOST_SCHEMA = BASE_SCHEMA.extend(
+    {
+        cv.Required(CONF_SERIAL_PORT): cv.string,
+        cv.Optional(CONF_BAUD_RATE, default=9600): cv.one_of(1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, int=True),
+    }
+)
+
+
+def CONFIG_SCHEMA(config):
+    if CORE.is_host:
+        return HOST_SCHEMA(config)
+    return UART_SCHEMA(config)
+
 
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
+    cg.add(var.setFrameGap(config[CONF_FRAME_GAP]))
+    cg.add(var.setTxQuiet(config[CONF_TX_QUIET]))
+    cg.add(var.setTraceSize(config[CONF_TRACE_BUFFER_SIZE]))
 
     if CONF_HORIZONTAL_SWING_SELECT in config:
         conf = config[CONF_HORIZONTAL_SWING_SELECT]
@@ -96,6 +139,22 @@ async def to_code(config):
         cg.add(var.setReconnectButton(btn))
         await cg.register_parented(btn, var)
 
-    await uart.register_uart_device(var, config)
+    if CONF_TRACE_DUMP_BUTTON in config:
+        conf = config[CONF_TRACE_DUMP_BUTTON]
+        btn = await button.new_button(conf)
+        cg.add(btn.set_parent(var))
+        cg.add(var.setTraceDumpButton(btn))
+        await cg.register_parented(btn, var)
+
+    # With a `sharp_ac:` block the climates of the node share its scheduler
+    if "sharp_ac" in CORE.config:
+        node = await cg.get_variable(CORE.config["sharp_ac"][CONF_ID])
+        cg.add(node.addUnit(var))
+
+    if CORE.is_host:
+        cg.add(var.setSerialPort(config[CONF_SERIAL_PORT]))
+        cg.add(var.setBaudRate(config[CONF_BAUD_RATE]))
+    else:
+        await uart.register_uart_device(var, config)
     await climate.register_climate(var, config)
     await cg.register_component(var, config)
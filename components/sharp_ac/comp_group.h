@@ -0,0 +1,62 @@
+#pragma once
+
+#include "esphome/components/climate/climate.h"
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+#include "comp_node.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // Time the units of a group command have to acknowledge it
+    const uint32_t SHARP_GROUP_TIMEOUT = 10000;
+
+    // The `group:` of a `sharp_ac:` block, one climate entity for all units
+    // of the node. The call is applied to the state of every connected
+    // unit, so fields it leaves out, the vanes and ion included, stay as
+    // each unit has them. Units that end up in the same state share one
+    // encoded command frame, and all units queue theirs in the same loop
+    // pass instead of one call after the other.
+    //
+    // A unit counts as acknowledged once the ACK for its own command came
+    // in. The command is complete when every unit acknowledged it, dropped
+    // its connection, acknowledged a later command instead or
+    // SHARP_GROUP_TIMEOUT passed; the result is logged.
+    class SharpAcGroup : public climate::Climate, public Component, public Parented<SharpAcNode>
+    {
+    public:
+      void control(const climate::ClimateCall &call) override;
+      climate::ClimateTraits traits() override;
+      void loop() override;
+      void dump_config() override;
+
+      // True while units of the last command are outstanding
+      bool isPending() const { return this->pending; }
+      // Units the last command was queued on, that acknowledged it and that
+      // were skipped or didn't acknowledge it
+      uint8_t getSent() const { return this->sent; }
+      uint8_t getAcked() const { return this->acked; }
+      uint8_t getFailed() const { return this->failed; }
+
+    private:
+      enum UnitResult : uint8_t
+      {
+        UNIT_WAITING,
+        UNIT_ACKED,
+        UNIT_FAILED
+      };
+
+      UnitResult results[SHARP_NODE_MAX_UNITS]{};
+      // Sequence number of the command queued on the unit
+      uint32_t commands[SHARP_NODE_MAX_UNITS]{};
+      uint32_t started{0};
+      bool pending{false};
+      uint8_t sent{0};
+      uint8_t acked{0};
+      uint8_t failed{0};
+    };
+
+  }
+}
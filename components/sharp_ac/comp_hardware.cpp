@@ -2,6 +2,9 @@
 #include "comp_vane_horizontal.h"
 #include "comp_vane_vertical.h"
 #include "comp_reconnect_button.h"
+#include "comp_trace_dump_button.h"
+#include "comp_node.h"
+#include "comp_group.h"
 
 namespace esphome
 {
@@ -14,12 +17,15 @@ namespace esphome
     }
 
     void ESPHomeStateCallback::on_ion_state_update(bool state) {
+      (void)state;
     }
 
     void ESPHomeStateCallback::on_vane_horizontal_update(SwingHorizontal val) {
+      (void)val;
     }
 
     void ESPHomeStateCallback::on_vane_vertical_update(SwingVertical val) {
+      (void)val;
     }
 
     void ESPHomeStateCallback::on_connection_status_update(int status) {
@@ -29,12 +35,17 @@ namespace esphome
     }
 
     SharpAc::SharpAc() {
+#ifdef USE_HOST
+      hardware_interface_ = std::make_unique<ESPHomeHardwareInterface>();
+#else
       hardware_interface_ = std::make_unique<ESPHomeHardwareInterface>(this);
+#endif
       state_callback_ = std::make_unique<ESPHomeStateCallback>(this);
       core_ = std::make_unique<SharpAcCore>(hardware_interface_.get(), state_callback_.get());
     }
     
-    ClimateTraits SharpAc::traits()
+    // Shared by the units and the group of a node
+    static ClimateTraits sharpTraits()
     {
       auto traits = esphome::climate::ClimateTraits();
       traits.set_supports_current_temperature(true);
@@ -65,29 +76,32 @@ namespace esphome
       return traits;
     }
 
-    void SharpAc::publishUpdate()
+    ClimateTraits SharpAc::traits()
     {
-      const auto& state = core_->getState();
-      
-      this->target_temperature = state.temperature;
-      this->current_temperature = core_->getCurrentTemperature();
-      
+      return sharpTraits();
+    }
+
+    // Target temperature, fan mode, mode, preset and swing mode of the entity
+    static void climateFromState(climate::Climate *climate, const SharpState &state)
+    {
+      climate->target_temperature = state.temperature;
+
       switch (state.fan)
       {
       case FanMode::auto_fan:
-        this->fan_mode = ClimateFanMode::CLIMATE_FAN_AUTO;
+        climate->fan_mode = ClimateFanMode::CLIMATE_FAN_AUTO;
         break;
       case FanMode::low:
-        this->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+        climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
         break;
       case FanMode::mid:
-        this->fan_mode = ClimateFanMode::CLIMATE_FAN_MEDIUM;
+        climate->fan_mode = ClimateFanMode::CLIMATE_FAN_MEDIUM;
         break;
       case FanMode::high:
-        this->fan_mode = ClimateFanMode::CLIMATE_FAN_MEDIUM;
+        climate->fan_mode = ClimateFanMode::CLIMATE_FAN_MEDIUM;
         break;
       case FanMode::highest:
-        this->fan_mode = ClimateFanMode::CLIMATE_FAN_HIGH;
+        climate->fan_mode = ClimateFanMode::CLIMATE_FAN_HIGH;
         break;
       default:
         ESP_LOGD("sharp_ac", "UNKNOWN FAN MODE");
@@ -96,16 +110,16 @@ namespace esphome
       switch (state.mode)
       {
       case PowerMode::fan:
-        this->mode = ClimateMode::CLIMATE_MODE_FAN_ONLY;
+        climate->mode = ClimateMode::CLIMATE_MODE_FAN_ONLY;
         break;
       case PowerMode::cool:
-        this->mode = ClimateMode::CLIMATE_MODE_COOL;
+        climate->mode = ClimateMode::CLIMATE_MODE_COOL;
         break;
       case PowerMode::heat:
-        this->mode = ClimateMode::CLIMATE_MODE_HEAT;
+        climate->mode = ClimateMode::CLIMATE_MODE_HEAT;
         break;
       case PowerMode::dry:
-        this->mode = ClimateMode::CLIMATE_MODE_DRY;
+        climate->mode = ClimateMode::CLIMATE_MODE_DRY;
         break;
       default:
         ESP_LOGD("sharp_ac", "UNKNOWN MODE");
@@ -113,30 +127,38 @@ namespace esphome
 
       if (!state.state)
       {
-        this->mode = ClimateMode::CLIMATE_MODE_OFF;
+        climate->mode = ClimateMode::CLIMATE_MODE_OFF;
       }
 
       switch (state.preset)
       {
       case Preset::ECO:
-        this->preset = ClimatePreset::CLIMATE_PRESET_ECO;
+        climate->preset = ClimatePreset::CLIMATE_PRESET_ECO;
         break;
       case Preset::FULLPOWER:
-        this->preset = ClimatePreset::CLIMATE_PRESET_BOOST;
+        climate->preset = ClimatePreset::CLIMATE_PRESET_BOOST;
         break;
       default:
-        this->preset = ClimatePreset::CLIMATE_PRESET_NONE;
+        climate->preset = ClimatePreset::CLIMATE_PRESET_NONE;
         break;
       }
 
       if (state.swingH == SwingHorizontal::swing && state.swingV == SwingVertical::swing)
-        this->swing_mode = ClimateSwingMode::CLIMATE_SWING_BOTH;
+        climate->swing_mode = ClimateSwingMode::CLIMATE_SWING_BOTH;
       else if (state.swingH == SwingHorizontal::swing)
-        this->swing_mode = ClimateSwingMode::CLIMATE_SWING_HORIZONTAL;
+        climate->swing_mode = ClimateSwingMode::CLIMATE_SWING_HORIZONTAL;
       else if (state.swingV == SwingVertical::swing)
-        this->swing_mode = ClimateSwingMode::CLIMATE_SWING_VERTICAL;
+        climate->swing_mode = ClimateSwingMode::CLIMATE_SWING_VERTICAL;
       else
-        this->swing_mode = ClimateSwingMode::CLIMATE_SWING_OFF;
+        climate->swing_mode = ClimateSwingMode::CLIMATE_SWING_OFF;
+    }
+
+    void SharpAc::publishUpdate()
+    {
+      const auto& state = core_->getState();
+
+      climateFromState(this, state);
+      this->current_temperature = core_->getCurrentTemperature();
 
       if (this->ionSwitch != nullptr)
         this->ionSwitch->publish_state(state.ion);
@@ -150,144 +172,114 @@ namespace esphome
       this->publish_state();
     }
 
-    void SharpAc::control(const ClimateCall &call)
+    // The fields of the call on top of state, for a unit and for the group
+    static void stateFromCall(const ClimateCall &call, SharpState &state)
     {
-      ESP_LOGD("sharp_ac", "=== Climate Control Called ===");
-
       if (call.get_mode().has_value())
       {
-        ClimateMode newMode = call.get_mode().value();
-        ESP_LOGD("sharp_ac", "Setting mode: %d (%s)", (int)newMode, 
-                 newMode == ClimateMode::CLIMATE_MODE_OFF ? "OFF" :
-                 newMode == ClimateMode::CLIMATE_MODE_COOL ? "COOL" :
-                 newMode == ClimateMode::CLIMATE_MODE_HEAT ? "HEAT" :
-                 newMode == ClimateMode::CLIMATE_MODE_DRY ? "DRY" :
-                 newMode == ClimateMode::CLIMATE_MODE_FAN_ONLY ? "FAN" : "UNKNOWN");
-
-        switch (newMode)
+        switch (call.get_mode().value())
         {
         case ClimateMode::CLIMATE_MODE_OFF:
-          ESP_LOGD("sharp_ac", "Sending OFF command to core");
-          core_->controlMode(PowerMode::cool, false);
+          state.state = false;
           break;
         case ClimateMode::CLIMATE_MODE_COOL:
-          ESP_LOGD("sharp_ac", "Sending COOL ON command to core");
-          core_->controlMode(PowerMode::cool, true);
+          state.state = true;
+          state.mode = PowerMode::cool;
           break;
         case ClimateMode::CLIMATE_MODE_HEAT:
-          ESP_LOGD("sharp_ac", "Sending HEAT ON command to core");
-          core_->controlMode(PowerMode::heat, true);
+          state.state = true;
+          state.mode = PowerMode::heat;
           break;
         case ClimateMode::CLIMATE_MODE_DRY:
-          ESP_LOGD("sharp_ac", "Sending DRY ON command to core");
-          core_->controlMode(PowerMode::dry, true);
+          state.state = true;
+          state.mode = PowerMode::dry;
           break;
         case ClimateMode::CLIMATE_MODE_FAN_ONLY:
-          ESP_LOGD("sharp_ac", "Sending FAN ONLY ON command to core");
-          core_->controlMode(PowerMode::fan, true);
+          state.state = true;
+          state.mode = PowerMode::fan;
           break;
         default:
-          ESP_LOGE("sharp_ac", "Unsupported mode: %d", (int)newMode);
+          ESP_LOGE("sharp_ac", "Unsupported mode: %d", (int)call.get_mode().value());
         }
       }
 
       if (call.get_target_temperature().has_value())
-      {
-        float temp = call.get_target_temperature().value();
-        ESP_LOGD("sharp_ac", "Setting target temperature: %.1f°C", temp);
-        ESP_LOGD("sharp_ac", "Sending temperature command to core");
-        core_->controlTemperature((int)temp);
-      }
+        state.temperature = (int)call.get_target_temperature().value();
 
       if (call.get_fan_mode().has_value())
       {
-        ClimateFanMode fanMode = call.get_fan_mode().value();
-        ESP_LOGD("sharp_ac", "Setting fan mode: %d (%s)", (int)fanMode,
-                 fanMode == ClimateFanMode::CLIMATE_FAN_AUTO ? "AUTO" :
-                 fanMode == ClimateFanMode::CLIMATE_FAN_LOW ? "LOW" :
-                 fanMode == ClimateFanMode::CLIMATE_FAN_MEDIUM ? "MEDIUM" :
-                 fanMode == ClimateFanMode::CLIMATE_FAN_HIGH ? "HIGH" : "UNKNOWN");
-
-        switch (fanMode)
+        switch (call.get_fan_mode().value())
         {
         case ClimateFanMode::CLIMATE_FAN_AUTO:
-          ESP_LOGD("sharp_ac", "Sending AUTO FAN command to core");
-          core_->controlFan(FanMode::auto_fan);
+          state.fan = FanMode::auto_fan;
           break;
         case ClimateFanMode::CLIMATE_FAN_LOW:
-          ESP_LOGD("sharp_ac", "Sending LOW FAN command to core");
-          core_->controlFan(FanMode::low);
+          state.fan = FanMode::low;
           break;
         case ClimateFanMode::CLIMATE_FAN_MEDIUM:
-          ESP_LOGD("sharp_ac", "Sending MEDIUM FAN command to core");
-          core_->controlFan(FanMode::mid);
+          state.fan = FanMode::mid;
           break;
         case ClimateFanMode::CLIMATE_FAN_HIGH:
-          ESP_LOGD("sharp_ac", "Sending HIGH FAN command to core");
-          core_->controlFan(FanMode::highest);
+          state.fan = FanMode::highest;
           break;
         default:
-          ESP_LOGE("sharp_ac", "Unsupported fan mode: %d", (int)fanMode);
+          ESP_LOGE("sharp_ac", "Unsupported fan mode: %d", (int)call.get_fan_mode().value());
         }
       }
 
       if (call.get_preset().has_value())
       {
-        ClimatePreset preset = call.get_preset().value();
-        ESP_LOGD("sharp_ac", "Setting preset: %d (%s)", (int)preset,
-                 preset == ClimatePreset::CLIMATE_PRESET_ECO ? "ECO" :
-                 preset == ClimatePreset::CLIMATE_PRESET_BOOST ? "BOOST" :
-                 preset == ClimatePreset::CLIMATE_PRESET_NONE ? "NONE" : "UNKNOWN");
-
-        switch (preset)
+        switch (call.get_preset().value())
         {
         case ClimatePreset::CLIMATE_PRESET_ECO:
-          ESP_LOGD("sharp_ac", "Sending ECO preset command to core");
-          core_->controlPreset(Preset::ECO);
+          state.preset = Preset::ECO;
           break;
         case ClimatePreset::CLIMATE_PRESET_BOOST:
-          ESP_LOGD("sharp_ac", "Sending BOOST preset command to core");
-          core_->controlPreset(Preset::FULLPOWER);
+          state.preset = Preset::FULLPOWER;
           break;
         default:
-          ESP_LOGD("sharp_ac", "Sending NONE preset command to core");
-          core_->controlPreset(Preset::NONE);
+          state.preset = Preset::NONE;
           break;
         }
       }
 
       if (call.get_swing_mode().has_value())
       {
-        ClimateSwingMode swingMode = call.get_swing_mode().value();
-        ESP_LOGD("sharp_ac", "Setting swing mode: %d (%s)", (int)swingMode,
-                 swingMode == ClimateSwingMode::CLIMATE_SWING_OFF ? "OFF" :
-                 swingMode == ClimateSwingMode::CLIMATE_SWING_BOTH ? "BOTH" :
-                 swingMode == ClimateSwingMode::CLIMATE_SWING_HORIZONTAL ? "HORIZONTAL" :
-                 swingMode == ClimateSwingMode::CLIMATE_SWING_VERTICAL ? "VERTICAL" : "UNKNOWN");
-
-        switch (swingMode)
+        switch (call.get_swing_mode().value())
         {
         case ClimateSwingMode::CLIMATE_SWING_OFF:
-          ESP_LOGD("sharp_ac", "Sending SWING OFF command to core (middle/mid position)");
-          core_->controlSwing(SwingHorizontal::middle, SwingVertical::mid);
+          state.swingH = SwingHorizontal::middle;
+          state.swingV = SwingVertical::mid;
           break;
         case ClimateSwingMode::CLIMATE_SWING_BOTH:
-          ESP_LOGD("sharp_ac", "Sending BOTH SWING command to core");
-          core_->controlSwing(SwingHorizontal::swing, SwingVertical::swing);
+          state.swingH = SwingHorizontal::swing;
+          state.swingV = SwingVertical::swing;
           break;
         case ClimateSwingMode::CLIMATE_SWING_HORIZONTAL:
-          ESP_LOGD("sharp_ac", "Sending HORIZONTAL SWING command to core");
-          core_->controlSwing(SwingHorizontal::swing, SwingVertical::mid);
+          state.swingH = SwingHorizontal::swing;
+          state.swingV = SwingVertical::mid;
           break;
         case ClimateSwingMode::CLIMATE_SWING_VERTICAL:
-          ESP_LOGD("sharp_ac", "Sending VERTICAL SWING command to core");
-          core_->controlSwing(SwingHorizontal::middle, SwingVertical::swing);
+          state.swingH = SwingHorizontal::middle;
+          state.swingV = SwingVertical::swing;
           break;
         default:
-          ESP_LOGE("sharp_ac", "Unsupported swing mode: %d", (int)swingMode);
+          ESP_LOGE("sharp_ac", "Unsupported swing mode: %d", (int)call.get_swing_mode().value());
         }
       }
-      
+    }
+
+    void SharpAc::control(const ClimateCall &call)
+    {
+      ESP_LOGD("sharp_ac", "=== Climate Control Called ===");
+
+      // One frame for the whole call, settings it leaves out stay as they are
+      SharpState target = core_->getState();
+      stateFromCall(call, target);
+      SharpCommandFrame frame = target.toFrame();
+      frame.setChecksum();
+      core_->applyCommand(target, frame);
+
       // Publish optimistic state immediately after sending command
       // This prevents the UI from showing the old state briefly
       ESP_LOGD("sharp_ac", "Publishing optimistic state update");
@@ -313,12 +305,63 @@ namespace esphome
 
     void SharpAc::setup()
     {
+#ifdef USE_HOST
+      if (!hardware_interface_->open(this->serialPort.c_str(), this->baudRate))
+      {
+        ESP_LOGE("sharp_ac", "Can't open serial port %s: %s", this->serialPort.c_str(), hardware_interface_->lastError());
+        this->mark_failed();
+        return;
+      }
+      // The port is always 8E1: start bit + 8 data bits + parity + stop bit
+      uint32_t baudRate = this->baudRate;
+      uint8_t bits = 11;
+#else
+      // Start bit + data bits + parity + stop bits
+      uint32_t baudRate = this->parent_->get_baud_rate();
+      uint8_t bits = 1 + this->parent_->get_data_bits() + this->parent_->get_stop_bits();
+      if (this->parent_->get_parity() != uart::UART_CONFIG_PARITY_NONE)
+        bits++;
+#endif
+      core_->setFrameGap(this->frameGap);
+      core_->setTxQuiet(this->txQuiet);
+      core_->setLineTiming(baudRate, bits);
+      core_->setTraceSize(this->traceSize);
+
       core_->setup();
       if (connectionStatusSensor != nullptr) {
         connectionStatusSensor->publish_state("Disconnected");
       }
     }
 
+    void SharpAc::dump_config()
+    {
+      LOG_CLIMATE("", "Sharp AC", this);
+#ifdef USE_HOST
+      ESP_LOGCONFIG("sharp_ac", "  Serial port: %s at %u baud", this->serialPort.c_str(), (unsigned)this->baudRate);
+#endif
+      ESP_LOGCONFIG("sharp_ac", "  Frame gap: %u character times", this->frameGap);
+      ESP_LOGCONFIG("sharp_ac", "  TX quiet time: %u character times", this->txQuiet);
+      ESP_LOGCONFIG("sharp_ac", "  Frame trace: %u bytes", this->traceSize);
+
+      const SharpRxStats &stats = core_->getRxStats();
+      static const char *const types[SharpFrameTypeCount] = {"none", "ack", "handshake", "mode", "status", "unknown"};
+      for (int i = 1; i < SharpFrameTypeCount; i++)
+      {
+        ESP_LOGCONFIG("sharp_ac", "  RX %-9s frames: %u, checksum errors: %u, truncated: %u", types[i],
+                      (unsigned)stats.frames[i], (unsigned)stats.checksumErrors[i], (unsigned)stats.truncated[i]);
+      }
+      ESP_LOGCONFIG("sharp_ac", "  RX dropped bytes: %u, resyncs: %u", (unsigned)stats.droppedBytes, (unsigned)stats.resyncs);
+      ESP_LOGCONFIG("sharp_ac", "  RX inter-byte gaps (chars) <1:%u 1:%u 2-3:%u 4-7:%u 8-15:%u 16-31:%u 32-63:%u 64+:%u",
+                    (unsigned)stats.gapHistogram[0], (unsigned)stats.gapHistogram[1], (unsigned)stats.gapHistogram[2],
+                    (unsigned)stats.gapHistogram[3], (unsigned)stats.gapHistogram[4], (unsigned)stats.gapHistogram[5],
+                    (unsigned)stats.gapHistogram[6], (unsigned)stats.gapHistogram[7]);
+
+      const SharpTxStats &tx = core_->getTxStats();
+      ESP_LOGCONFIG("sharp_ac", "  TX frames: %u, deferred: %u, coalesced: %u, dropped: %u, commands acked: %u",
+                    (unsigned)tx.frames, (unsigned)tx.deferred, (unsigned)tx.coalesced, (unsigned)tx.dropped,
+                    (unsigned)tx.acked);
+    }
+
     void SharpAc::loop()
     {
       core_->loop();
@@ -353,6 +396,218 @@ namespace esphome
       }
     }
 
+    void SharpAc::dumpTrace()
+    {
+      const SharpFrameTrace &trace = core_->getTrace();
+      if (!trace.enabled())
+      {
+        ESP_LOGI("sharp_ac", "Frame trace is disabled, set trace_buffer_size to enable it");
+        return;
+      }
+
+      ESP_LOGI("sharp_ac", "Frame trace: %u frames, %u recorded, %u overwritten, now @%u",
+               (unsigned)trace.count(), (unsigned)trace.getRecorded(), (unsigned)trace.getOverwritten(),
+               (unsigned)millis());
+      SharpTraceEntry entry;
+      char line[SHARP_TRACE_LINE_SIZE];
+      for (SharpFrameTrace::Cursor cursor = trace.first(); trace.next(cursor, entry);)
+      {
+        entry.format(line, sizeof(line));
+        ESP_LOGI("sharp_ac", "%s", line);
+      }
+    }
+
+    void SharpAcNode::addUnit(SharpAc *unit)
+    {
+      uint8_t slot = this->scheduler.getUnits();
+      if (!unit->getCore()->setScheduler(&this->scheduler))
+      {
+        ESP_LOGW("sharp_ac", "'%s' not added to the node, it takes %u units", unit->get_name().c_str(),
+                 (unsigned)SHARP_NODE_MAX_UNITS);
+        return;
+      }
+      this->units[slot] = unit;
+    }
+
+    void SharpAcNode::loop()
+    {
+      if (this->reportInterval == 0)
+        return;
+      if (millis() - this->lastReport >= this->reportInterval)
+        this->logReport();
+    }
+
+    void SharpAcNode::dump_config()
+    {
+      ESP_LOGCONFIG("sharp_ac", "Sharp AC node:");
+      ESP_LOGCONFIG("sharp_ac", "  Units: %u, handshake spacing: %u ms, report every %u ms",
+                    (unsigned)this->scheduler.getUnits(), (unsigned)this->scheduler.getSpacing(),
+                    (unsigned)this->reportInterval);
+      this->logReport();
+    }
+
+    void SharpAcNode::logReport()
+    {
+      uint32_t now = millis();
+      uint32_t frames = this->scheduler.getFrames();
+      uint32_t elapsed = now - this->lastReport;
+      float perMinute = elapsed > 0 ? (frames - this->framesAtReport) * 60000.0f / elapsed : 0.0f;
+      this->lastReport = now;
+      this->framesAtReport = frames;
+
+      ESP_LOGI("sharp_ac", "Node: %u units, %.1f frames/min, response p50 %.1f ms, p99 %.1f ms, max %.1f ms",
+               (unsigned)this->scheduler.getUnits(), perMinute, this->scheduler.latencyPercentile(50) / 1000.0f,
+               this->scheduler.latencyPercentile(99) / 1000.0f, this->scheduler.getMaxLatency() / 1000.0f);
+      for (uint8_t i = 0; i < this->scheduler.getUnits(); i++)
+      {
+        const SharpNodeUnitStats &stats = this->scheduler.getStats(i);
+        int status = this->units[i]->getCore()->getStatus();
+        ESP_LOGI("sharp_ac", "  %s: %s, %u requests, %u received, %u polls, %u handshakes, %u timeouts",
+                 this->units[i]->get_name().c_str(), status == 8 ? "connected" : "connecting",
+                 (unsigned)stats.requests, (unsigned)stats.received, (unsigned)stats.polls,
+                 (unsigned)stats.handshakes, (unsigned)stats.timeouts);
+      }
+    }
+
+    ClimateTraits SharpAcGroup::traits()
+    {
+      auto traits = sharpTraits();
+      traits.set_supports_current_temperature(false);
+      return traits;
+    }
+
+    static bool sameState(const SharpState &a, const SharpState &b)
+    {
+      return a.state == b.state && a.mode == b.mode && a.fan == b.fan && a.swingH == b.swingH &&
+             a.swingV == b.swingV && a.temperature == b.temperature && a.ion == b.ion && a.preset == b.preset;
+    }
+
+    void SharpAcGroup::control(const ClimateCall &call)
+    {
+      SharpAcNode *node = this->parent_;
+      uint8_t units = node->getScheduler().getUnits();
+
+      // Units with the same resulting state share one frame
+      SharpState states[SHARP_NODE_MAX_UNITS];
+      SharpCommandFrame frames[SHARP_NODE_MAX_UNITS];
+      uint8_t frameCount = 0;
+
+      // Shown on the group: the call on top of the first connected unit
+      SharpState shown;
+      bool shownSet = false;
+
+      this->started = millis();
+      this->sent = 0;
+      this->acked = 0;
+      this->failed = 0;
+      for (uint8_t i = 0; i < units; i++)
+      {
+        SharpAc *unit = node->getUnit(i);
+        SharpAcCore *core = unit->getCore();
+        if (core->getStatus() != 8)
+        {
+          ESP_LOGW("sharp_ac", "Group: '%s' is not connected, skipped", unit->get_name().c_str());
+          this->results[i] = UNIT_FAILED;
+          this->failed++;
+          continue;
+        }
+
+        // Fields the call leaves out keep the unit's own setting
+        SharpState target = core->getState();
+        stateFromCall(call, target);
+        uint8_t f = 0;
+        while (f < frameCount && !sameState(states[f], target))
+          f++;
+        if (f == frameCount)
+        {
+          states[f] = target;
+          frames[f] = target.toFrame();
+          frames[f].setChecksum();
+          frameCount++;
+        }
+
+        this->commands[i] = core->applyCommand(target, frames[f]);
+        unit->publishUpdate();
+        this->results[i] = UNIT_WAITING;
+        this->sent++;
+        if (!shownSet)
+        {
+          shown = target;
+          shownSet = true;
+        }
+      }
+      ESP_LOGD("sharp_ac", "Group: %u frames queued on %u of %u units", (unsigned)frameCount, (unsigned)this->sent,
+               (unsigned)units);
+
+      if (!shownSet)
+        stateFromCall(call, shown);
+      climateFromState(this, shown);
+      this->publish_state();
+
+      // Reports right away when no unit was connected
+      this->pending = true;
+      this->loop();
+    }
+
+    void SharpAcGroup::loop()
+    {
+      if (!this->pending)
+        return;
+
+      SharpAcNode *node = this->parent_;
+      uint32_t elapsed = millis() - this->started;
+      bool expired = elapsed >= SHARP_GROUP_TIMEOUT;
+      uint8_t waiting = 0;
+      for (uint8_t i = 0; i < node->getScheduler().getUnits(); i++)
+      {
+        if (this->results[i] != UNIT_WAITING)
+          continue;
+        SharpAcCore *core = node->getUnit(i)->getCore();
+        // An ACK for a later command means this one was replaced in the
+        // queue or its own ACK got lost
+        int32_t ahead = static_cast<int32_t>(core->getAckedCommand() - this->commands[i]);
+        if (ahead == 0)
+        {
+          this->results[i] = UNIT_ACKED;
+          this->acked++;
+        }
+        else if (ahead > 0 || core->getStatus() != 8 || expired)
+        {
+          this->results[i] = UNIT_FAILED;
+          this->failed++;
+        }
+        else
+        {
+          waiting++;
+        }
+      }
+      if (waiting > 0)
+        return;
+
+      this->pending = false;
+      ESP_LOGI("sharp_ac", "Group: %u of %u units acknowledged in %u ms", (unsigned)this->acked,
+               (unsigned)(this->acked + this->failed), (unsigned)elapsed);
+      for (uint8_t i = 0; i < node->getScheduler().getUnits(); i++)
+      {
+        if (this->results[i] == UNIT_FAILED)
+          ESP_LOGW("sharp_ac", "  %s: not acknowledged", node->getUnit(i)->get_name().c_str());
+      }
+    }
+
+    void SharpAcGroup::dump_config()
+    {
+      LOG_CLIMATE("", "Sharp AC group", this);
+      ESP_LOGCONFIG("sharp_ac", "  Units: %u", (unsigned)this->parent_->getScheduler().getUnits());
+    }
+
+    void TraceDumpButton::press_action()
+    {
+      if (this->parent_ != nullptr)
+      {
+        this->parent_->dumpTrace();
+      }
+    }
+
     void ReconnectButton::press_action()
     {
       ESP_LOGI("sharp_ac", "Reconnect button pressed - resetting connection");
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "esphome/core/defines.h"
 #include "esphome/components/climate/climate.h"
+#ifndef USE_HOST
 #include "esphome/components/uart/uart.h"
+#endif
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/select/select.h"
 #include "esphome/components/text_sensor/text_sensor.h"
@@ -15,6 +18,10 @@
 #include "core_frame.h"
 #include "core_messages.h"
 
+#ifdef USE_HOST
+#include "host_serial.h"
+#endif
+
 #include <memory>
 #include <cstdarg>
 
@@ -34,8 +41,39 @@ namespace esphome
     class VaneSelectHorizontal;
     class ConnectionStatusSensor;
     class ReconnectButton;
+    class TraceDumpButton;
     class SharpAc; 
 
+#ifdef USE_HOST
+    // The host platform has no UART component, the serial device is opened
+    // directly. Time and logging still go through ESPHome.
+    class ESPHomeHardwareInterface : public SharpSerialPort {
+    public:
+      unsigned long get_millis() override {
+        return millis();
+      }
+
+      unsigned long get_micros() override {
+        return micros();
+      }
+
+      void log_debug(const char* tag, const char* format, ...) override {
+        va_list args;
+        va_start(args, format);
+        esp_log_vprintf_(ESPHOME_LOG_LEVEL_DEBUG, tag, __LINE__, format, args);
+        va_end(args);
+      }
+
+      // DEBUG output compiled out by the logger's level
+      bool log_debug_enabled() override {
+        return ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG;
+      }
+
+      std::string format_hex_pretty(const uint8_t *data, size_t len) override {
+        return esphome::format_hex_pretty(data, len);
+      }
+    };
+#else
     class ESPHomeHardwareInterface : public SharpAcHardwareInterface {
     public:
       ESPHomeHardwareInterface(uart::UARTDevice* uart_device) : uart_device_(uart_device) {}
@@ -64,6 +102,10 @@ namespace esphome
         return millis();
       }
 
+      unsigned long get_micros() override {
+        return micros();
+      }
+
       void log_debug(const char* tag, const char* format, ...) override {
         va_list args;
         va_start(args, format);
@@ -71,6 +113,11 @@ namespace esphome
         va_end(args);
       }
 
+      // DEBUG output compiled out by the logger's level
+      bool log_debug_enabled() override {
+        return ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG;
+      }
+
       std::string format_hex_pretty(const uint8_t *data, size_t len) override {
         return esphome::format_hex_pretty(data, len);
       }
@@ -78,6 +125,7 @@ namespace esphome
     private:
       uart::UARTDevice* uart_device_;
     };
+#endif
 
     class ESPHomeStateCallback : public SharpAcStateCallback {
     public:
@@ -93,7 +141,11 @@ namespace esphome
       SharpAc* sharp_ac_;
     };
 
+#ifdef USE_HOST
+    class SharpAc : public climate::Climate, public Component
+#else
     class SharpAc : public climate::Climate, public uart::UARTDevice, public Component
+#endif
     {
     public:
       SharpAc();
@@ -101,6 +153,7 @@ namespace esphome
       void control(const climate::ClimateCall &call) override;
       void loop() override;
       void setup() override;
+      void dump_config() override;
       esphome::climate::ClimateTraits traits() override;
 
       void setIon(bool state);
@@ -131,19 +184,63 @@ namespace esphome
         this->reconnectButton = button;
       };
 
+      void setFrameGap(uint8_t chars)
+      {
+        this->frameGap = chars;
+      };
+
+      void setTxQuiet(uint8_t chars)
+      {
+        this->txQuiet = chars;
+      };
+
+      void setTraceSize(uint16_t bytes)
+      {
+        this->traceSize = bytes;
+      };
+
+      void setTraceDumpButton(button::Button *button)
+      {
+        this->traceDumpButton = button;
+      };
+
+#ifdef USE_HOST
+      void setSerialPort(const std::string &path)
+      {
+        this->serialPort = path;
+      };
+
+      void setBaudRate(uint32_t baudRate)
+      {
+        this->baudRate = baudRate;
+      };
+#endif
+
+      SharpAcCore *getCore() { return core_.get(); }
+
       void updateConnectionStatus(int status);
       void triggerReconnect();
+      // Logs the frame trace at INFO, oldest frame first
+      void dumpTrace();
 
     private:
       std::unique_ptr<ESPHomeHardwareInterface> hardware_interface_;
       std::unique_ptr<ESPHomeStateCallback> state_callback_;
       std::unique_ptr<SharpAcCore> core_;
 
-      switch_::Switch *ionSwitch;
-      VaneSelectVertical *vaneVertical;
-      VaneSelectHorizontal *vaneHorizontal;
+      switch_::Switch *ionSwitch{nullptr};
+      VaneSelectVertical *vaneVertical{nullptr};
+      VaneSelectHorizontal *vaneHorizontal{nullptr};
       text_sensor::TextSensor *connectionStatusSensor{nullptr};
       button::Button *reconnectButton{nullptr};
+      button::Button *traceDumpButton{nullptr};
+      uint8_t frameGap{4};
+      uint8_t txQuiet{2};
+      uint16_t traceSize{0};
+#ifdef USE_HOST
+      std::string serialPort;
+      uint32_t baudRate{9600};
+#endif
     };
   }
 }
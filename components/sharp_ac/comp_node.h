@@ -0,0 +1,42 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+#include "core_scheduler.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    class SharpAc;
+
+    // The `sharp_ac:` block: every sharp_ac climate of the node joins its
+    // SharpAcScheduler, which staggers polls, handshakes and retries across
+    // them. The report has the node's frames per minute, response times
+    // and each unit's counters.
+    class SharpAcNode : public Component
+    {
+    public:
+      void addUnit(SharpAc *unit);
+      void setSpacing(uint32_t millis) { this->scheduler.setSpacing(millis); }
+      // 0 logs the report only with the config dump
+      void setReportInterval(uint32_t millis) { this->reportInterval = millis; }
+
+      void loop() override;
+      void dump_config() override;
+      void logReport();
+
+      const SharpAcScheduler &getScheduler() const { return this->scheduler; }
+      // Units by scheduler slot
+      SharpAc *getUnit(uint8_t slot) const { return slot < this->scheduler.getUnits() ? this->units[slot] : nullptr; }
+
+    private:
+      SharpAcScheduler scheduler;
+      SharpAc *units[SHARP_NODE_MAX_UNITS]{};
+      uint32_t reportInterval{0};
+      uint32_t lastReport{0};
+      uint32_t framesAtReport{0};
+    };
+
+  }
+}
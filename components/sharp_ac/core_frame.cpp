@@ -1,35 +1,43 @@
 #include <cstring>
+#include <cstdio>
 #include "core_types.h"
 #include "core_frame.h"
 #include "core_state.h"
 
 SharpFrame::SharpFrame(char c) : size(1)
 {
-    data = new uint8_t[size];
     data[0] = static_cast<uint8_t>(c);
 }
 SharpFrame::SharpFrame() : size(0)
 {
 }
 
-SharpFrame::SharpFrame(const uint8_t *arr, size_t sz) : size(sz)
+SharpFrame::SharpFrame(const uint8_t *arr, size_t sz) : size(sz < SHARP_MAX_FRAME_SIZE ? sz : SHARP_MAX_FRAME_SIZE)
 {
-    data = new uint8_t[sz];
-    memcpy(data, arr, sz);
+    memcpy(data, arr, size);
 }
 
-SharpFrame::~SharpFrame()
+SharpFrame::SharpFrame(const SharpFrame &other) : size(other.size)
 {
-    delete[] data;
+    memcpy(data, other.data, size);
 }
 
-SharpFrame::SharpFrame(const SharpFrame &other) : size(other.size)
+SharpFrame &SharpFrame::operator=(const SharpFrame &other)
 {
-    data = new uint8_t[size];
-    memcpy(data, other.data, size);
+    if (this != &other)
+    {
+        memcpy(data, other.data, other.size);
+        size = other.size;
+    }
+    return *this;
+}
+
+uint8_t *SharpFrame::getData()
+{
+    return data;
 }
 
-uint8_t *SharpFrame::getData() const
+const uint8_t *SharpFrame::getData() const
 {
     return data;
 }
@@ -41,10 +49,10 @@ size_t SharpFrame::getSize() const
 
 int SharpFrame::setSize(size_t sz)
 {
-    if (this->size == 0)
+    if (this->size == 0 && sz <= SHARP_MAX_FRAME_SIZE)
     {
         this->size = sz;
-        this->data = new uint8_t[this->size];
+        memset(this->data, 0, sz);
         return 1;
     }
     return 0;
@@ -54,6 +62,33 @@ void SharpFrame::print()
 {
 }
 
+// Same layout as ESPHome's format_hex_pretty, without a heap allocated string
+size_t SharpFrame::formatHex(char *out, size_t outSize) const
+{
+    static const char digits[] = "0123456789ABCDEF";
+    size_t pos = 0;
+
+    if (outSize == 0)
+        return 0;
+
+    for (size_t i = 0; i < this->size && pos + 3 < outSize; i++)
+    {
+        if (i > 0)
+            out[pos++] = '.';
+        out[pos++] = digits[this->data[i] >> 4];
+        out[pos++] = digits[this->data[i] & 0x0F];
+    }
+    out[pos] = '\0';
+
+    if (this->size > 1)
+    {
+        int n = snprintf(out + pos, outSize - pos, " (%u)", static_cast<unsigned>(this->size));
+        if (n > 0)
+            pos += static_cast<size_t>(n) < outSize - pos ? n : outSize - pos - 1;
+    }
+    return pos;
+}
+
 void SharpFrame::setChecksum()
 {
     this->data[size - 1] = calcChecksum();
@@ -76,6 +111,25 @@ uint8_t SharpFrame::calcChecksum()
     return checksum;
 }
 
+SharpRxFrame::SharpRxFrame() : SharpFrame(), type(SharpFrameType::none), handler(SHARP_NO_HANDLER)
+{
+}
+
+SharpRxFrame::SharpRxFrame(const uint8_t *arr, size_t sz, SharpFrameType type, uint8_t handler)
+    : SharpFrame(arr, sz), type(type), handler(handler)
+{
+}
+
+SharpFrameType SharpRxFrame::getType() const
+{
+    return this->type;
+}
+
+uint8_t SharpRxFrame::getHandler() const
+{
+    return this->handler;
+}
+
 SharpStatusFrame::SharpStatusFrame(const uint8_t *arr) : SharpFrame(arr, 18)
 {
 }
@@ -97,13 +151,17 @@ int SharpModeFrame::getTemperature()
 
 bool SharpModeFrame::getState()
 {
-    // Only check Bit 7 (0x80) for actual power state
-    return (this->data[8] & 0x80) != 0;
+    // Response frames (0xFC): Bit 7 (0x80) of byte[8]
+    // Command frames (0xFB): byte[5] is 0x21 when off, 0x31/0x61/0x71 when on
+    if (this->data[2] == 0xFC)
+        return (this->data[8] & 0x80) != 0;
+    else  // 0xFB command frames, byte[8] holds the vanes
+        return (this->data[5] & 0xF0) != 0x20;
 }
 
 Preset SharpModeFrame::getPreset(){
     // Response frames (0xFC): byte[7] bit-based (0x40=ECO, 0x80=FULLPOWER)
-    // Command frames (0xFB): byte[7]=0x10 for ECO, byte[10]=0x01 for FULLPOWER
+    // Command frames (0xFB): byte[7]=0x10 for ECO, byte[10] bit 0 for FULLPOWER
     if (this->data[2] == 0xFC) {
         // Response frame format 
         if((this->data[7] & 0x40) == 0x40)
@@ -112,7 +170,7 @@ Preset SharpModeFrame::getPreset(){
             return Preset::FULLPOWER; 
     } else {
         // Command frame format (0xFB) 
-        if(this->data[10] == 0x01)
+        if((this->data[10] & 0x01) == 0x01)
             return Preset::FULLPOWER;
         else if(this->data[7] == 0x10)
             return Preset::ECO; 
@@ -165,8 +223,12 @@ PowerMode SharpModeFrame::getPowerMode()
 bool SharpModeFrame::getIon()
 {
     // Check Bit 2 (0x04) for Ion/Plasmacluster state
-    // 0x84, 0x94, 0x04 all have Ion ON
-    return (this->data[8] & 0x04) != 0;
+    // Response frames (0xFC): byte[8], 0x84, 0x94, 0x04 all have Ion ON
+    // Command frames (0xFB): byte[11], 0xE4, 0xF4, 0x1C have Ion ON
+    if (this->data[2] == 0xFC)
+        return (this->data[8] & 0x04) != 0;
+    else
+        return (this->data[11] & 0x04) != 0;
 }
 
 SharpCommandFrame::SharpCommandFrame() : SharpFrame()
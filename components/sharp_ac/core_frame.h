@@ -6,27 +6,50 @@
 
 class SharpState;
 
+const size_t SHARP_HEADER_SIZE = 8;
+const size_t SHARP_MAX_FRAME_SIZE = 64;
+const uint8_t SHARP_NO_HANDLER = 0xFF;
+// "DC.0B.FC (14)": three characters per byte plus the length suffix
+const size_t SHARP_HEX_BUFFER_SIZE = SHARP_MAX_FRAME_SIZE * 3 + 8;
+
+// Frames keep their bytes inline so the steady state RX/TX path never
+// touches the heap
 class SharpFrame
 {
 protected:
-    uint8_t *data;
+    uint8_t data[SHARP_MAX_FRAME_SIZE];
     size_t size;
 
 public:
     SharpFrame();
     SharpFrame(char c);
     SharpFrame(const uint8_t *arr, size_t sz);
-    ~SharpFrame();
     SharpFrame(const SharpFrame &other);
-    uint8_t *getData() const;
+    SharpFrame &operator=(const SharpFrame &other);
+    uint8_t *getData();
+    const uint8_t *getData() const;
     size_t getSize() const;
     int setSize(size_t sz);
     void print();
+    size_t formatHex(char *out, size_t outSize) const;
     virtual void setChecksum();
     bool validateChecksum();
     uint8_t calcChecksum();
 };
 
+class SharpRxFrame : public SharpFrame
+{
+public:
+    SharpRxFrame();
+    SharpRxFrame(const uint8_t *arr, size_t sz, SharpFrameType type, uint8_t handler = SHARP_NO_HANDLER);
+    SharpFrameType getType() const;
+    uint8_t getHandler() const;
+
+private:
+    SharpFrameType type;
+    uint8_t handler;
+};
+
 class SharpStatusFrame : public SharpFrame
 {
 public:
@@ -1,6 +1,8 @@
 #include "core_logic.h"
+#include "core_registry.h"
 #include <iostream>
 #include <cstdarg>
+#include <cstring>
 
 namespace esphome
 {
@@ -13,6 +15,122 @@ namespace esphome
       hardware->log_debug(TAG, "SharpAcCore initialized successfully");
     }
 
+    // Message constants leave out the checksum, the frame gets a zeroed byte
+    // for it that write_frame() fills in
+    static SharpFrame messageFrame(const uint8_t *msg, size_t size)
+    {
+      SharpFrame frame;
+      frame.setSize(size + 1);
+      memcpy(frame.getData(), msg, size);
+      return frame;
+    }
+
+    static bool isCommand(const SharpFrame &frame)
+    {
+      return frame.getSize() > 2 && frame.getData()[0] == 0xdd && frame.getData()[2] == 0xfb;
+    }
+
+    void SharpAcCore::write_frame(SharpFrame &frame)
+    {
+      frame.setChecksum();
+      this->queue_frame(frame);
+    }
+
+    void SharpAcCore::queue_frame(SharpFrame &frame)
+    {
+      frame.print();
+
+      if (isCommand(frame))
+        queuedCommand++;
+      this->enqueue(frame);
+    }
+
+    // Queues without numbering, a re-sent command keeps its number
+    void SharpAcCore::enqueue(SharpFrame &frame)
+    {
+      if (txCount == 0 && this->lineQuiet())
+      {
+        this->transmit(frame);
+        return;
+      }
+
+      txStats.deferred++;
+
+      // A newer command frame carries the complete state, it replaces a
+      // command that is still waiting for the line
+      bool command = isCommand(frame);
+      for (int i = 0; command && i < txCount; i++)
+      {
+        SharpFrame &queued = txQueue[(txHead + i) % txQueueSize];
+        if (isCommand(queued))
+        {
+          queued = frame;
+          txStats.coalesced++;
+          return;
+        }
+      }
+
+      if (txCount == txQueueSize)
+      {
+        hardware->log_debug(TAG, "TX queue full, dropping oldest frame");
+        txHead = (txHead + 1) % txQueueSize;
+        txCount--;
+        txStats.dropped++;
+      }
+      txQueue[(txHead + txCount) % txQueueSize] = frame;
+      txCount++;
+    }
+
+    // Half duplex: nothing in progress from the AC, no byte for txQuiet
+    // character times and our own previous frame fully shifted out
+    bool SharpAcCore::lineQuiet()
+    {
+      uint32_t now = hardware->get_micros();
+      uint32_t quiet = parser.getCharMicros() * this->txQuiet;
+      if (hardware->available() > 0 || !parser.idle(now, quiet))
+        return false;
+      return txStats.frames == 0 || static_cast<int32_t>(now - txBusyUntil) >= static_cast<int32_t>(quiet);
+    }
+
+    void SharpAcCore::flushTx()
+    {
+      if (txCount > 0 && this->lineQuiet())
+      {
+        this->transmit(txQueue[txHead]);
+        txHead = (txHead + 1) % txQueueSize;
+        txCount--;
+      }
+    }
+
+    void SharpAcCore::transmit(SharpFrame &frame)
+    {
+      if (frame.getSize() == 1 && frame.getData()[0] == 0x06) {
+        hardware->log_debug(TAG, "TX: ACK");
+      } else {
+        if (hardware->log_debug_enabled())
+        {
+          char hex[SHARP_HEX_BUFFER_SIZE];
+          frame.formatHex(hex, sizeof(hex));
+          hardware->log_debug(TAG, "TX: %s", hex);
+        }
+        awaitingResponse = true;
+        lastRequestTime = this->nowMillis();
+        lastRequest = frame;
+        if (isCommand(frame))
+        {
+          commandSent = true;
+          sentCommand = queuedCommand;
+        }
+        if (scheduler)
+          scheduler->onRequest(slot, hardware->get_micros());
+      }
+
+      trace.record(true, frame.getData(), frame.getSize(), this->nowMillis());
+      txStats.frames++;
+      txBusyUntil = hardware->get_micros() + frame.getSize() * parser.getCharMicros();
+      hardware->write_array(frame.getData(), frame.getSize());
+    }
+
     void SharpAcCore::write_ack()
     {
       SharpACKFrame frame;
@@ -26,22 +144,29 @@ namespace esphome
     void SharpAcCore::startInit()
     {
       // Don't send if we're already waiting for a response
-      if (awaitingResponse) {
+      if (awaitingResponse || txCount > 0) {
         return;
       }
+      // Another core of the node may have just started its handshake. An
+      // init_msg sent again mid-handshake is not a new start.
+      bool starting = this->status == 0;
+      if (starting && scheduler && !scheduler->claimStart(this->nowMillis()))
+        return;
 
       if (this->connectionStart == 0) {
         hardware->log_debug(TAG, "Initializing connection...");
-        this->connectionStart = hardware->get_millis();
+        this->connectionStart = this->nowMillis();
       }
 
-      SharpFrame frame(init_msg, sizeof(init_msg) + 1);
+      SharpFrame frame = messageFrame(init_msg, sizeof(init_msg));
       this->write_frame(frame);
+      if (starting && scheduler)
+        scheduler->onHandshake(slot);
     }
 
     void SharpAcCore::sendInitMsg(const uint8_t *arr, size_t size)
     {
-      SharpFrame frame(arr, size);
+      SharpFrame frame = messageFrame(arr, size);
       this->write_frame(frame);
       this->status++;
       
@@ -56,124 +181,149 @@ namespace esphome
       }
     }
 
-    void SharpAcCore::init(SharpFrame &frame)
+    void SharpAcCore::dispatch(SharpRxFrame &frame)
     {
-      if (frame.getSize() == 0)
+      if (frame.getHandler() == SHARP_NO_HANDLER)
         return;
 
-      switch (frame.getData()[0])
+      (this->*SharpMessageRegistry::get(frame.getHandler()).handle)(frame);
+    }
+
+    void SharpAcCore::onAck(SharpRxFrame &frame)
+    {
+      (void)frame;
+      if (this->status == 2 || this->status == 7)
       {
-      case 0x06:
-        if (this->status == 2 || this->status == 7)
-        {
-          this->status++;
-          
-          // Notify status change
-          if (callback) {
-            callback->on_connection_status_update(this->status);
-          }
-          
-          // Log progress for ACK steps (status 2->3 and 7->8)
-          if (this->status < 8) {
-            hardware->log_debug(TAG, "Connecting (%d/8)...", this->status);
-          } else {
-            hardware->log_debug(TAG, "Connected");
-          }
+        this->status++;
+        
+        // Notify status change
+        if (callback) {
+          callback->on_connection_status_update(this->status);
+        }
+        
+        // Log progress for ACK steps (status 2->3 and 7->8)
+        if (this->status < 8) {
+          hardware->log_debug(TAG, "Connecting (%d/8)...", this->status);
+        } else {
+          hardware->log_debug(TAG, "Connected");
+          // The handshake just read the status, the first poll waits for
+          // the slot's phase
+          if (scheduler)
+            previousMillis = scheduler->pollPeriodStart(slot, this->nowMillis(), interval);
         }
-        break;
-      case 0x02:
+      }
+      else if (this->status == 8 && commandSent)
+      {
+        commandSent = false;
+        ackedCommand = sentCommand;
+        txStats.acked++;
+      }
+    }
+
+    void SharpAcCore::onHandshake(SharpRxFrame &frame)
+    {
+      if (frame.getData()[0] == 0x02)
+      {
         if (this->status == 0)
-          sendInitMsg(init_msg2, sizeof(init_msg2) + 1);
+          sendInitMsg(init_msg2, sizeof(init_msg2));
         else if (this->status == 1)
-          sendInitMsg(subscribe_msg, sizeof(subscribe_msg) + 1);
-        break;
-      case 0x03:
+          sendInitMsg(subscribe_msg, sizeof(subscribe_msg));
+      }
+      else
+      {
         if (this->status == 3)
-          sendInitMsg(subscribe_msg2, sizeof(subscribe_msg2) + 1);
+          sendInitMsg(subscribe_msg2, sizeof(subscribe_msg2));
         else if (this->status == 4)
-          sendInitMsg(get_state, sizeof(get_state) + 1);
-        break;
-      case 0xdc:
-        if (this->status == 5)
-          sendInitMsg(get_status, sizeof(get_status) + 1);
-        else if (this->status == 6)
-          sendInitMsg(connected_msg, sizeof(connected_msg) + 1);
-
-        this->processUpdate(frame);
-        break;
+          sendInitMsg(get_state, sizeof(get_state));
       }
     }
 
-    SharpFrame SharpAcCore::readMsg()
+    // The last handshake steps are answered by the state and status frames
+    void SharpAcCore::continueHandshake()
     {
-      uint8_t msg[18];
-      uint8_t msg_id = hardware->peek();
+      if (this->status == 5)
+        sendInitMsg(get_status, sizeof(get_status));
+      else if (this->status == 6)
+        sendInitMsg(connected_msg, sizeof(connected_msg));
+    }
 
-      if (msg_id == 0x06 || msg_id == 0x00)
-      {
-        uint8_t singleByte = hardware->read();
-        SharpFrame frame(singleByte);
+    void SharpAcCore::onUnknown(SharpRxFrame &frame)
+    {
+      (void)frame;
+    }
 
-        hardware->log_debug(TAG, "RX: ACK");
-        awaitingResponse = false;
-        
-        return frame;
+    SharpRxFrame SharpAcCore::readMsg()
+    {
+      uint8_t chunk[SHARP_MAX_FRAME_SIZE];
+      uint32_t resyncs = parser.getStats().resyncs;
+      uint32_t dropped = parser.getStats().droppedBytes;
+      uint32_t now = hardware->get_micros();
+      bool received = false;
+
+      SharpRxFrame frame = parser.next();
+      while (frame.getType() == SharpFrameType::none)
+      {
+        size_t len = parser.wanted();
+        size_t available = hardware->available();
+        if (len > available)
+          len = available;
+        if (len == 0)
+          break;
+
+        len = hardware->read_array(chunk, len);
+        if (len == 0)
+          break;
+        parser.push(chunk, len, now);
+        received = true;
+        frame = parser.next();
       }
 
-      int size = 8;
+      // An idle gap on the line ends the frame in progress
+      if (frame.getType() == SharpFrameType::none && !received && parser.checkGap(now))
+        hardware->log_debug(TAG, "RX: incomplete frame dropped (line idle)");
 
-      if (hardware->available() < 8)
+      if (parser.getStats().resyncs != resyncs)
       {
-        if (this->errCounter < 5)
-        {
-          this->errCounter++;
-          return SharpFrame(msg, 0);
-        }
-        else
-        {
-          this->errCounter = 0;
-          uint8_t singleByte = hardware->read();
-          SharpFrame frame(singleByte);
-          
-          hardware->log_debug(TAG, "RX: %s (error recovery)", hardware->format_hex_pretty(&singleByte, 1).c_str());
-          
-          return frame;
-        }
+        const SharpRxStats &stats = parser.getStats();
+        uint32_t checksumErrors = 0;
+        for (int i = 0; i < SharpFrameTypeCount; i++)
+          checksumErrors += stats.checksumErrors[i];
+        hardware->log_debug(TAG, "RX: resynchronized (%u checksum errors, %u bytes dropped so far)",
+                            (unsigned)checksumErrors, (unsigned)stats.droppedBytes);
       }
-      this->errCounter = 0;
 
-      hardware->read_array(msg, 8);
+      // Part of the answer is lost, ask again instead of waiting for the
+      // response timeout
+      if (parser.getStats().droppedBytes != dropped && awaitingResponse && this->status == 8)
+        retryPending = true;
+
+      if (frame.getType() == SharpFrameType::none)
+        return frame;
+
+      trace.record(false, frame.getData(), frame.getSize(), this->nowMillis());
 
-      if (msg_id == 0x02)
-        size += msg[6];
-      else if (msg_id == 0x03 && msg[1] == 0xfe && msg[2] == 0x00)
-        size = 17;
-      else if (msg_id == 0xdc)
+      if (frame.getType() == SharpFrameType::ack)
       {
-        if (msg[1] == 0x0b)
-          size = 14;
-        else if (msg[1] == 0x0F)
-          size = 18;
+        hardware->log_debug(TAG, "RX: ACK");
       }
-      if (size > 8)
+      else if (hardware->log_debug_enabled())
       {
-        hardware->read_array(msg + 8, size - 8);
-        SharpFrame frame(msg, size);
-        
-        hardware->log_debug(TAG, "RX: %s", hardware->format_hex_pretty(frame.getData(), frame.getSize()).c_str());
-        
+        char hex[SHARP_HEX_BUFFER_SIZE];
+        frame.formatHex(hex, sizeof(hex));
+        hardware->log_debug(TAG, "RX: %s", hex);
+      }
+      
+      // Mark that we received a valid response. Unknown frames don't count,
+      // resyncing over a damaged answer yields those and the request still
+      // has to time out.
+      if (frame.getType() != SharpFrameType::unknown)
+      {
+        if (scheduler)
+          scheduler->onResponse(slot, now);
         awaitingResponse = false;
-        
-        return frame;
+        retries = 0;
       }
 
-      SharpFrame frame(msg, size);
-      
-      hardware->log_debug(TAG, "RX: %s", hardware->format_hex_pretty(frame.getData(), frame.getSize()).c_str());
-      
-      // Mark that we received a valid response
-      awaitingResponse = false;
-      
       return frame;
     }
 
@@ -271,46 +421,56 @@ namespace esphome
       return result;
     }
 
-    void SharpAcCore::processUpdate(SharpFrame &frame)
+    // Status-Frames (18 Byte): Only Temperature (no state update needed)
+    void SharpAcCore::onStatusResponse(SharpRxFrame &frame)
     {
-      if (frame.getSize() == 0 || frame.getSize() == 1) {
-        return;
+      this->continueHandshake();
+
+      SharpStatusFrame status(frame.getData());
+      this->currentTemperature = status.getTemperature();
+      hardware->log_debug(TAG, "Current temp: %.1f°C", this->currentTemperature);
+      // Publish only temperature update without changing state
+      this->publishUpdate();
+    }
+
+    // Mode-Frames (14 Byte): Full State
+    void SharpAcCore::onModeResponse(SharpRxFrame &rx)
+    {
+      this->continueHandshake();
+
+      SharpModeFrame frame(rx.getData());
+      FanMode fan = frame.getFanMode();
+      PowerMode mode = frame.getPowerMode();
+      SwingHorizontal swingH = frame.getSwingHorizontal();
+      SwingVertical swingV = frame.getSwingVertical();
+
+      // A nibble that names no known value keeps the previous setting
+      if (!isKnown(fan) || !isKnown(mode) || !isKnown(swingH) || !isKnown(swingV))
+        hardware->log_debug(TAG, "Mode frame with unknown values, keeping previous ones");
+      if (isKnown(fan))
+        this->state.fan = fan;
+      if (isKnown(mode))
+        this->state.mode = mode;
+      if (isKnown(swingH))
+        this->state.swingH = swingH;
+      if (isKnown(swingV))
+        this->state.swingV = swingV;
+      this->state.state = frame.getState();
+      this->state.preset = frame.getPreset();
+      this->state.ion = frame.getIon();
+
+      if (this->state.state)
+      {
+        if (this->state.mode == PowerMode::cool || this->state.mode == PowerMode::heat)
+          this->state.temperature = frame.getTemperature();
       }
       
-      // Status-Frames (18 Byte): Only Temperature (no state update needed)
-      if (frame.getSize() == 18)
-      {
-        SharpStatusFrame *status = static_cast<SharpStatusFrame *>(&frame);
-        this->currentTemperature = status->getTemperature();
-        hardware->log_debug(TAG, "Current temp: %.1f°C", this->currentTemperature);
-        // Publish only temperature update without changing state
+      // Only publish update if we have received at least one temperature reading
+      // This prevents showing 0°C before the first status frame
+      if (this->currentTemperature > 0.0f) {
         this->publishUpdate();
-      }
-      // Mode-Frames (14 Byte): Full State
-      else if (frame.getSize() >= 14)
-      {
-        SharpModeFrame *status = static_cast<SharpModeFrame *>(&frame);
-        this->state.fan = status->getFanMode();
-        this->state.mode = status->getPowerMode();
-        this->state.state = status->getState();
-        this->state.swingH = status->getSwingHorizontal();
-        this->state.swingV = status->getSwingVertical();
-        this->state.preset = status->getPreset();
-        this->state.ion = status->getIon();
-
-        if (this->state.state)
-        {
-          if (this->state.mode == PowerMode::cool || this->state.mode == PowerMode::heat)
-            this->state.temperature = status->getTemperature();
-        }
-        
-        // Only publish update if we have received at least one temperature reading
-        // This prevents showing 0°C before the first status frame
-        if (this->currentTemperature > 0.0f) {
-          this->publishUpdate();
-        } else {
-          hardware->log_debug(TAG, "Waiting for temperature reading...");
-        }
+      } else {
+        hardware->log_debug(TAG, "Waiting for temperature reading...");
       }
     }
 
@@ -383,52 +543,149 @@ namespace esphome
       this->write_frame(frame);
     }
 
+    uint32_t SharpAcCore::applyCommand(const SharpState &target, const SharpFrame &frame)
+    {
+      this->state = target;
+      SharpFrame queued(frame);
+      this->queue_frame(queued);
+      return this->queuedCommand;
+    }
+
     void SharpAcCore::resetConnection()
     {
       this->status = 0;
       this->awaitingResponse = false;
+      this->commandSent = false;
+      this->retries = 0;
+      this->retryPending = false;
       this->connectionStart = 0;
+      this->parser.reset();
+      this->txCount = 0;
       
       if (callback) {
         callback->on_connection_status_update(0);
       }
     }
 
+    void SharpAcCore::setLineTiming(uint32_t baudRate, uint8_t bitsPerChar)
+    {
+      if (baudRate == 0 || bitsPerChar == 0)
+        return;
+      this->baudRate = baudRate;
+      this->bitsPerChar = bitsPerChar;
+      parser.setTiming(bitsPerChar * 1000000UL / baudRate, this->frameGap);
+    }
+
+    void SharpAcCore::setFrameGap(uint8_t chars)
+    {
+      this->frameGap = chars;
+      parser.setTiming(this->bitsPerChar * 1000000UL / this->baudRate, chars);
+    }
+
+    void SharpAcCore::setTraceSize(size_t bytes)
+    {
+      trace.setCapacity(bytes);
+    }
+
+    void SharpAcCore::setTxQuiet(uint8_t chars)
+    {
+      this->txQuiet = chars;
+    }
+
+    bool SharpAcCore::setScheduler(SharpAcScheduler *scheduler)
+    {
+      int slot = scheduler->add(this);
+      if (slot < 0)
+      {
+        hardware->log_debug(TAG, "Node scheduler full, this unit runs on its own timing");
+        return false;
+      }
+      this->scheduler = scheduler;
+      this->slot = static_cast<uint8_t>(slot);
+      return true;
+    }
+
     void SharpAcCore::checkTimeout()
     {
       if (!awaitingResponse) {
         return; 
       }
 
-      unsigned long currentMillis = hardware->get_millis();
+      uint32_t currentMillis = this->nowMillis();
       if (currentMillis - lastRequestTime >= responseTimeout) {
+        if (this->status == 8 && this->retryRequest())
+          return;
         hardware->log_debug(TAG, "Timeout - no response for 10s, reconnecting...");
+        if (scheduler)
+          scheduler->onTimeout(slot);
         resetConnection();
       }
     }
 
+    // Puts the last request on the line again, at most maxRetries times
+    // until an answer comes in
+    bool SharpAcCore::retryRequest()
+    {
+      if (this->retries >= maxRetries)
+        return false;
+      this->retries++;
+      txStats.retried++;
+      hardware->log_debug(TAG, "No valid answer, sending the request again (%d/%d)", this->retries, this->maxRetries);
+      // Restarts the timeout even while the frame waits for the line
+      this->lastRequestTime = this->nowMillis();
+      SharpFrame frame(lastRequest);
+      this->enqueue(frame);
+      return true;
+    }
+
+    uint32_t SharpAcCore::millisUntilDue()
+    {
+      if (txCount > 0 || retryPending || parser.pending() || hardware->available() > 0)
+        return 0;
+      // Not connected and nothing outstanding: startInit() sends right away,
+      // or once the node's scheduler lets it
+      if (this->status != 8 && !awaitingResponse)
+        return this->status == 0 && scheduler ? scheduler->millisUntilStart(this->nowMillis()) : 0;
+
+      uint32_t currentMillis = this->nowMillis();
+      uint32_t due = UINT32_MAX;
+
+      if (awaitingResponse)
+      {
+        uint32_t elapsed = currentMillis - lastRequestTime;
+        if (elapsed >= responseTimeout)
+          return 0;
+        due = responseTimeout - elapsed;
+      }
+
+      if (this->status == 8)
+      {
+        uint32_t elapsed = currentMillis - previousMillis;
+        if (elapsed >= interval)
+          return 0;
+        if (interval - elapsed < due)
+          due = interval - elapsed;
+      }
+      return due;
+    }
+
     void SharpAcCore::loop()
     {
-      unsigned long currentMillis = hardware->get_millis();
+      uint32_t currentMillis = this->nowMillis();
 
       checkTimeout();
 
-      if (hardware->available() > 0) {
+      if (hardware->available() > 0 || parser.pending()) {
       
-          SharpFrame frame = this->readMsg();
+          SharpRxFrame frame = this->readMsg();
           frame.print();
 
-          if (status < 8)
-          {
-              this->init(frame);
-          }
-          else
-          {
-            this->processUpdate(frame);
-            if (frame.getSize() > 1) {
+          // Frames are only acknowledged once the handshake is complete
+          bool connected = status == 8;
+          this->dispatch(frame);
+          if (connected && frame.getSize() > 1) {
             this->write_ack();
           }
-          }
           
       
      }
@@ -440,12 +697,24 @@ namespace esphome
       {
         if (currentMillis - previousMillis >= interval)
         {
-          previousMillis = currentMillis;
+          previousMillis = scheduler ? scheduler->pollPeriodStart(slot, currentMillis, interval) : currentMillis;
+          if (scheduler)
+            scheduler->onPoll(slot);
 
-          SharpFrame frame(get_status, sizeof(get_status) + 1);
+          SharpFrame frame = messageFrame(get_status, sizeof(get_status));
           this->write_frame(frame);
         }
       }
+
+      // Once the rest of a damaged answer is off the line
+      if (retryPending && txCount == 0 && this->lineQuiet())
+      {
+        retryPending = false;
+        if (awaitingResponse && this->status == 8)
+          this->retryRequest();
+      }
+
+      this->flushTx();
      
       }
     }
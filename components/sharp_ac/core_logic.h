@@ -8,6 +8,9 @@
 #include "core_state.h"
 #include "core_frame.h"
 #include "core_messages.h"
+#include "core_parser.h"
+#include "core_trace.h"
+#include "core_scheduler.h"
 
 namespace esphome
 {
@@ -24,7 +27,11 @@ namespace esphome
       virtual uint8_t peek() = 0;
       virtual uint8_t read() = 0;
       virtual unsigned long get_millis() = 0;
+      virtual unsigned long get_micros() { return get_millis() * 1000UL; }
       virtual void log_debug(const char* tag, const char* format, ...) = 0;
+      // False when log_debug() output goes nowhere, the core then doesn't
+      // format frames for it
+      virtual bool log_debug_enabled() { return true; }
       virtual std::string format_hex_pretty(const uint8_t *data, size_t len) = 0;
     };
 
@@ -38,6 +45,20 @@ namespace esphome
       virtual void on_connection_status_update(int status) = 0;
     };
 
+    struct SharpMessageHandlers;
+
+    struct SharpTxStats
+    {
+      uint32_t frames;
+      uint32_t deferred;
+      uint32_t coalesced;
+      uint32_t dropped;
+      // Command frames the AC acknowledged
+      uint32_t acked;
+      // Requests sent again after a damaged or missing answer
+      uint32_t retried;
+    };
+
     class SharpAcCore
     {
     public:
@@ -46,6 +67,9 @@ namespace esphome
 
       void loop();
       void setup();
+      // Milliseconds until loop() has time driven work (poll, response
+      // timeout), 0 if it has work now
+      uint32_t millisUntilDue();
 
       void setIon(bool state);
       void setVaneHorizontal(SwingHorizontal val);
@@ -54,33 +78,52 @@ namespace esphome
       void publishUpdate();
       const SharpState& getState() const { return state; }
       float getCurrentTemperature() const { return currentTemperature; }
+      const SharpRxStats &getRxStats() const { return parser.getStats(); }
+      const SharpTxStats &getTxStats() const { return txStats; }
+      const SharpFrameTrace &getTrace() const { return trace; }
 
       void controlMode(PowerMode mode, bool state);
       void controlFan(FanMode fan);
       void controlSwing(SwingHorizontal h, SwingVertical v);
       void controlTemperature(int temperature);
       void controlPreset(Preset preset);
+      // Takes over a state whose command frame, checksum included, was
+      // encoded once for all units of a group that share it, and queues that
+      // frame. Returns the command's sequence number, see getAckedCommand()
+      uint32_t applyCommand(const SharpState &target, const SharpFrame &frame);
+      // Sequence number of the last command frame the AC acknowledged, 0
+      // until the first. Command frames are numbered when they are queued.
+      uint32_t getAckedCommand() const { return ackedCommand; }
       void resetConnection();
 
+      // UART framing used to turn idle gaps on the line into frame ends
+      void setLineTiming(uint32_t baudRate, uint8_t bitsPerChar);
+      void setFrameGap(uint8_t chars);
+      // Quiet time on the line, in character times, required before we transmit
+      void setTxQuiet(uint8_t chars);
+      // Bytes of RAM for the frame trace ring buffer, 0 turns it off
+      void setTraceSize(size_t bytes);
+      // Shares poll phases and handshake starts with the other cores of the
+      // node, false if the scheduler has no slot left
+      bool setScheduler(SharpAcScheduler *scheduler);
+      int getStatus() const { return status; }
+
     protected:
-      std::string analyzeByte(uint8_t byte, size_t position, bool isStatusFrame);
+      // Message handlers, dispatched through the registry in core_registry.h
+      friend struct SharpMessageHandlers;
+      void onAck(SharpRxFrame &frame);
+      void onHandshake(SharpRxFrame &frame);
+      void onModeResponse(SharpRxFrame &frame);
+      void onStatusResponse(SharpRxFrame &frame);
+      void onUnknown(SharpRxFrame &frame);
 
-      void write_frame(SharpFrame &frame)
-      {
-        frame.setChecksum();
-        frame.print();
-        
-        if (frame.getSize() == 1 && frame.getData()[0] == 0x06) {
-          hardware->log_debug(TAG, "TX: ACK");
-        } else {
-          hardware->log_debug(TAG, "TX: %s", hardware->format_hex_pretty(frame.getData(), frame.getSize()).c_str());
-          awaitingResponse = true;
-          lastRequestTime = hardware->get_millis();
-        }
-        
-        hardware->write_array(frame.getData(), frame.getSize());
-      }
+      std::string analyzeByte(uint8_t byte, size_t position, bool isStatusFrame);
 
+      // Frames are queued and only put on the line once the AC is not
+      // sending, see flushTx()
+      void write_frame(SharpFrame &frame);
+      // Same for a frame that already has its checksum
+      void queue_frame(SharpFrame &frame);
       void write_ack();
 
     private:
@@ -88,22 +131,62 @@ namespace esphome
       SharpAcStateCallback* callback;
 
       void sendInitMsg(const uint8_t *arr, size_t size);
-      int errCounter = 0;
+      SharpFrameParser parser;
+      uint32_t baudRate = 9600;
+      uint8_t bitsPerChar = 11;
+      uint8_t frameGap = 4;
+      uint8_t txQuiet = 2;
+
+      static const int txQueueSize = 4;
+      SharpFrame txQueue[txQueueSize];
+      int txHead = 0;
+      int txCount = 0;
+      uint32_t txBusyUntil = 0;
+      // A command frame went out and its ACK is still to come
+      bool commandSent = false;
+      // Sequence numbers of the last command frame queued, put on the line
+      // and acknowledged. At most one command waits in the queue, so the
+      // one transmitted is always the last one queued.
+      uint32_t queuedCommand = 0;
+      uint32_t sentCommand = 0;
+      uint32_t ackedCommand = 0;
+      SharpTxStats txStats = {};
+      SharpFrameTrace trace;
+      SharpAcScheduler *scheduler = nullptr;
+      uint8_t slot = 0;
+
+      // The last request put on the line and how often it was sent again
+      // without an answer in between
+      SharpFrame lastRequest;
+      uint8_t retries = 0;
+      // Bytes of an answer were dropped, see retryRequest()
+      bool retryPending = false;
+
+      bool lineQuiet();
+      void enqueue(SharpFrame &frame);
+      void flushTx();
+      void transmit(SharpFrame &frame);
+      bool retryRequest();
 
     protected:
       SharpState state;
-      void init(SharpFrame &frame);
-      SharpFrame readMsg();
-      void processUpdate(SharpFrame &frame);
+      SharpRxFrame readMsg();
+      void dispatch(SharpRxFrame &frame);
+      void continueHandshake();
       void startInit();
       void checkTimeout();
       int status = 0;
-      unsigned long connectionStart = 0;
-      unsigned long previousMillis = 0;
-      unsigned long lastRequestTime = 0;
+      // millis() timestamps. They wrap after ~49.7 days, so they are only
+      // ever compared as uint32_t differences
+      uint32_t nowMillis() { return static_cast<uint32_t>(hardware->get_millis()); }
+      uint32_t connectionStart = 0;
+      uint32_t previousMillis = 0;
+      uint32_t lastRequestTime = 0;
       bool awaitingResponse = false;
-      const long interval = 60000;
-      const long responseTimeout = 10000; // 10 seconds
+      const uint32_t interval = 60000;
+      const uint32_t responseTimeout = 10000; // 10 seconds
+      // Re-sends of an unanswered request before the connection is reset
+      const uint8_t maxRetries = 2;
       float currentTemperature = 0.0f;
     };
   }
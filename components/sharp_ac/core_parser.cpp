@@ -0,0 +1,189 @@
+#include <cstring>
+#include "core_parser.h"
+#include "core_registry.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // Bytes the parser will resynchronize on. Registered single byte noise
+    // (0x00) is consumed when it leads the buffer but never resynced to.
+    static bool plausibleHeader(uint8_t byte)
+    {
+      uint8_t slot = dispatchTable.slot[byte];
+      return slot != SHARP_NO_HANDLER && messageHandlers[slot].type != SharpFrameType::unknown;
+    }
+
+    SharpFrameParser::SharpFrameParser() : length(0), lastByteMicros(0), seenByte(false)
+    {
+      memset(&stats, 0, sizeof(stats));
+      // 9600 baud 8E1
+      setTiming(11 * 1000000UL / 9600, 4);
+    }
+
+    void SharpFrameParser::setTiming(uint32_t charMicros, uint8_t gapChars)
+    {
+      this->charMicros = charMicros > 0 ? charMicros : 1;
+      this->gapMicros = this->charMicros * gapChars;
+    }
+
+    size_t SharpFrameParser::wanted() const
+    {
+      if (length == 0)
+        return 1;
+
+      size_t need = SharpMessageRegistry::headerBytes(buffer[0]);
+      if (length < need)
+        return need - length;
+
+      uint8_t slot = SharpMessageRegistry::find(buffer, need);
+      if (slot == SHARP_NO_HANDLER)
+        return 0;
+
+      size_t expected = SharpMessageRegistry::frameLength(slot, buffer);
+      if (expected > SHARP_MAX_FRAME_SIZE || expected <= length)
+        return 0;
+      return expected - length;
+    }
+
+    size_t SharpFrameParser::push(const uint8_t *data, size_t len, uint32_t nowMicros)
+    {
+      if (len == 0)
+        return 0;
+
+      if (seenByte)
+      {
+        // Bytes are only seen when loop() gets to read them, so the time
+        // between reads says nothing certain about the line: these bytes may
+        // have followed the previous ones back to back. Only checkGap() on a
+        // read that found nothing ends a frame. The histogram records the
+        // read-to-read time less the time the chunk took on the line.
+        uint32_t elapsed = nowMicros - lastByteMicros;
+        uint32_t busy = len * charMicros;
+        uint32_t gap = elapsed > busy ? elapsed - busy : 0;
+
+        uint32_t chars = gap / charMicros;
+        int bucket = 0;
+        while (chars > 0 && bucket < SharpGapBuckets - 1)
+        {
+          chars >>= 1;
+          bucket++;
+        }
+        stats.gapHistogram[bucket]++;
+      }
+      stats.gapHistogram[0] += seenByte ? len - 1 : 0;
+      seenByte = true;
+      lastByteMicros = nowMicros;
+
+      size_t space = SHARP_MAX_FRAME_SIZE - length;
+      if (len > space)
+        len = space;
+      memcpy(buffer + length, data, len);
+      length += len;
+      return len;
+    }
+
+    SharpRxFrame SharpFrameParser::next()
+    {
+      while (length > 0)
+      {
+        if (dispatchTable.slot[buffer[0]] == SHARP_NO_HANDLER)
+        {
+          resync();
+          continue;
+        }
+
+        size_t need = SharpMessageRegistry::headerBytes(buffer[0]);
+        if (length < need)
+          break;
+
+        uint8_t slot = SharpMessageRegistry::find(buffer, need);
+        if (slot == SHARP_NO_HANDLER)
+        {
+          resync();
+          continue;
+        }
+
+        size_t expected = SharpMessageRegistry::frameLength(slot, buffer);
+        if (expected > SHARP_MAX_FRAME_SIZE)
+        {
+          resync();
+          continue;
+        }
+        if (length < expected)
+          break;
+
+        const SharpMessageHandler &handler = SharpMessageRegistry::get(slot);
+        SharpFrameType type = handler.type;
+        SharpRxFrame frame(buffer, expected, type, slot);
+        if (handler.checksummed && !frame.validateChecksum())
+        {
+          stats.checksumErrors[static_cast<int>(type)]++;
+          resync();
+          continue;
+        }
+
+        stats.frames[static_cast<int>(type)]++;
+        discard(expected);
+        return frame;
+      }
+      return SharpRxFrame();
+    }
+
+    bool SharpFrameParser::checkGap(uint32_t nowMicros)
+    {
+      if (length == 0 || nowMicros - lastByteMicros < gapMicros)
+        return false;
+
+      truncate();
+      return true;
+    }
+
+    bool SharpFrameParser::idle(uint32_t nowMicros, uint32_t quietMicros) const
+    {
+      return length == 0 && (!seenByte || nowMicros - lastByteMicros >= quietMicros);
+    }
+
+    void SharpFrameParser::skip()
+    {
+      if (length > 0)
+        resync();
+    }
+
+    void SharpFrameParser::reset()
+    {
+      length = 0;
+    }
+
+    // The line went idle before the frame in progress was complete
+    void SharpFrameParser::truncate()
+    {
+      uint8_t slot = SharpMessageRegistry::find(buffer, length);
+      SharpFrameType type = slot == SHARP_NO_HANDLER ? SharpFrameType::unknown : SharpMessageRegistry::get(slot).type;
+      stats.truncated[static_cast<int>(type)]++;
+      stats.droppedBytes += length;
+      length = 0;
+    }
+
+    void SharpFrameParser::discard(size_t count)
+    {
+      if (count > length)
+        count = length;
+      memmove(buffer, buffer + count, length - count);
+      length -= count;
+    }
+
+    // Drop the first byte and everything up to the next byte a registered
+    // frame can start with
+    void SharpFrameParser::resync()
+    {
+      size_t skip = 1;
+      while (skip < length && !plausibleHeader(buffer[skip]))
+        skip++;
+
+      stats.droppedBytes += skip;
+      stats.resyncs++;
+      discard(skip);
+    }
+  }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "core_types.h"
+#include "core_frame.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // Inter-byte gap buckets in character times: <1, 1, 2-3, 4-7, ... 64+
+    const int SharpGapBuckets = 8;
+
+    struct SharpRxStats
+    {
+      uint32_t frames[SharpFrameTypeCount];
+      uint32_t checksumErrors[SharpFrameTypeCount];
+      uint32_t truncated[SharpFrameTypeCount];
+      uint32_t droppedBytes;
+      uint32_t resyncs;
+      uint32_t gapHistogram[SharpGapBuckets];
+    };
+
+    // Reassembles the RX byte stream into frames using the message registry.
+    // Frames the registry marks as checksummed are validated; bad frames and
+    // bytes that cannot start a frame are dropped and the stream is
+    // resynchronized on the next plausible header byte.
+    //
+    // Byte arrival is timestamped: a frame still in progress when the line
+    // has been idle for the frame gap (in character times) is truncated.
+    // Timestamps are taken when bytes are read, so bytes delivered in one
+    // read count as back-to-back in the gap histogram.
+    class SharpFrameParser
+    {
+    public:
+      SharpFrameParser();
+
+      void setTiming(uint32_t charMicros, uint8_t gapChars);
+      uint32_t getCharMicros() const { return charMicros; }
+
+      // Bytes needed to complete the frame in progress, 0 if next() has work
+      size_t wanted() const;
+      size_t push(const uint8_t *data, size_t len, uint32_t nowMicros);
+      SharpRxFrame next();
+      // Drops the frame in progress if the line went idle, true if it did
+      bool checkGap(uint32_t nowMicros);
+
+      bool pending() const { return length > 0; }
+      // No frame in progress and no byte seen for quietMicros
+      bool idle(uint32_t nowMicros, uint32_t quietMicros) const;
+      // Give up on the frame in progress and look for the next header
+      void skip();
+      void reset();
+
+      const SharpRxStats &getStats() const { return stats; }
+
+    private:
+      void discard(size_t count);
+      void resync();
+      void truncate();
+
+      uint8_t buffer[SHARP_MAX_FRAME_SIZE];
+      size_t length;
+      SharpRxStats stats;
+
+      uint32_t charMicros;
+      uint32_t gapMicros;
+      uint32_t lastByteMicros;
+      bool seenByte;
+    };
+  }
+}
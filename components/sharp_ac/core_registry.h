@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "core_types.h"
+#include "core_frame.h"
+#include "core_logic.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // A message the AC can send us: the header bytes that identify it, how
+    // long the frame is and which SharpAcCore handler consumes it.
+    //
+    // Frame length is `length`, plus the value of byte `lengthIndex` when
+    // lengthIndex is non-zero (byte 0 is always the header, never a length).
+    // Only frames with `checksummed` set are dropped on a bad checksum, the
+    // protocol defines one for the 0xdc state frames but no capture shows
+    // how the AC checksums its handshake replies.
+    struct SharpMessageHandler
+    {
+      uint8_t header[3];
+      uint8_t headerLength;
+      uint8_t length;
+      uint8_t lengthIndex;
+      bool checksummed;
+      SharpFrameType type;
+      void (SharpAcCore::*handle)(SharpRxFrame &frame);
+    };
+
+    // The handlers are protected members of SharpAcCore, this friend hands
+    // out pointers to them for the registry below
+    struct SharpMessageHandlers
+    {
+      typedef void (SharpAcCore::*Handler)(SharpRxFrame &frame);
+      static constexpr Handler ack() { return &SharpAcCore::onAck; }
+      static constexpr Handler handshake() { return &SharpAcCore::onHandshake; }
+      static constexpr Handler modeResponse() { return &SharpAcCore::onModeResponse; }
+      static constexpr Handler statusResponse() { return &SharpAcCore::onStatusResponse; }
+      static constexpr Handler unknown() { return &SharpAcCore::onUnknown; }
+    };
+
+    // Message registry. To support a new frame add an entry here, a
+    // handler on SharpAcCore and its accessor above, the read loop does not
+    // need to change.
+    // Entries sharing a first header byte must be adjacent, most specific
+    // first; the last entry of a group acts as its fallback.
+    constexpr SharpMessageHandler messageHandlers[] = {
+        {{0x06}, 1, 1, 0, false, SharpFrameType::ack, SharpMessageHandlers::ack()},
+        {{0x00}, 1, 1, 0, false, SharpFrameType::unknown, SharpMessageHandlers::unknown()},
+        {{0x02}, 1, 8, 6, false, SharpFrameType::handshake, SharpMessageHandlers::handshake()},
+        {{0x03, 0xfe, 0x00}, 3, 17, 0, false, SharpFrameType::handshake, SharpMessageHandlers::handshake()},
+        {{0x03}, 1, 8, 0, false, SharpFrameType::handshake, SharpMessageHandlers::handshake()},
+        {{0xdc, 0x0b}, 2, 14, 0, true, SharpFrameType::mode_response, SharpMessageHandlers::modeResponse()},
+        {{0xdc, 0x0f}, 2, 18, 0, true, SharpFrameType::status_response, SharpMessageHandlers::statusResponse()},
+        {{0xdc}, 1, 8, 0, true, SharpFrameType::unknown, SharpMessageHandlers::unknown()},
+    };
+
+    constexpr size_t messageHandlerCount = sizeof(messageHandlers) / sizeof(messageHandlers[0]);
+
+    static_assert(messageHandlerCount < SHARP_NO_HANDLER, "Too many message handlers");
+
+    // First registry entry for a header byte, resolved at compile time
+    constexpr uint8_t sharpDispatchSlot(uint8_t header, size_t i)
+    {
+      return i == messageHandlerCount ? SHARP_NO_HANDLER
+             : messageHandlers[i].header[0] == header ? static_cast<uint8_t>(i)
+                                                      : sharpDispatchSlot(header, i + 1);
+    }
+
+    constexpr bool sharpHandlersGrouped(size_t i)
+    {
+      return i >= messageHandlerCount ||
+             ((messageHandlers[i - 1].header[0] == messageHandlers[i].header[0] ||
+               sharpDispatchSlot(messageHandlers[i].header[0], 0) == i) &&
+              sharpHandlersGrouped(i + 1));
+    }
+
+    static_assert(sharpHandlersGrouped(1), "Message handlers with the same header byte must be adjacent");
+
+    template <size_t... I>
+    struct SharpIndexSequence
+    {
+    };
+
+    template <size_t N, size_t... I>
+    struct SharpMakeIndexSequence
+    {
+      typedef typename SharpMakeIndexSequence<N - 1, N - 1, I...>::type type;
+    };
+
+    template <size_t... I>
+    struct SharpMakeIndexSequence<0, I...>
+    {
+      typedef SharpIndexSequence<I...> type;
+    };
+
+    struct SharpDispatchTable
+    {
+      uint8_t slot[256];
+    };
+
+    template <size_t... I>
+    constexpr SharpDispatchTable sharpMakeDispatchTable(SharpIndexSequence<I...>)
+    {
+      return SharpDispatchTable{{sharpDispatchSlot(static_cast<uint8_t>(I), 0)...}};
+    }
+
+    // Header byte -> registry slot, one indexed lookup per frame
+    constexpr SharpDispatchTable dispatchTable =
+        sharpMakeDispatchTable(SharpMakeIndexSequence<256>::type());
+
+    static_assert(dispatchTable.slot[0x06] == 0, "ACK must resolve to the first handler");
+    static_assert(dispatchTable.slot[0xff] == SHARP_NO_HANDLER, "Unregistered headers must not resolve");
+
+    class SharpMessageRegistry
+    {
+    public:
+      // Number of leading bytes needed before find() can decide
+      static size_t headerBytes(uint8_t header)
+      {
+        uint8_t slot = dispatchTable.slot[header];
+        if (slot != SHARP_NO_HANDLER && messageHandlers[slot].length == 1)
+          return 1;
+        return SHARP_HEADER_SIZE;
+      }
+
+      // Registry slot matching the leading bytes, SHARP_NO_HANDLER if none
+      static uint8_t find(const uint8_t *data, size_t len)
+      {
+        if (len == 0)
+          return SHARP_NO_HANDLER;
+
+        for (uint8_t i = dispatchTable.slot[data[0]];
+             i < messageHandlerCount && messageHandlers[i].header[0] == data[0]; i++)
+        {
+          const SharpMessageHandler &handler = messageHandlers[i];
+          if (len < handler.headerLength)
+            return SHARP_NO_HANDLER;
+
+          bool match = true;
+          for (uint8_t b = 1; b < handler.headerLength; b++)
+            match &= data[b] == handler.header[b];
+          if (match)
+            return i;
+        }
+        return SHARP_NO_HANDLER;
+      }
+
+      // Total frame length for a slot, given at least headerBytes() bytes
+      static size_t frameLength(uint8_t slot, const uint8_t *data)
+      {
+        const SharpMessageHandler &handler = messageHandlers[slot];
+        size_t length = handler.length;
+        if (handler.lengthIndex != 0)
+          length += data[handler.lengthIndex];
+        return length;
+      }
+
+      static const SharpMessageHandler &get(uint8_t slot)
+      {
+        return messageHandlers[slot];
+      }
+    };
+  }
+}
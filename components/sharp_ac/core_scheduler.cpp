@@ -0,0 +1,125 @@
+#include "core_scheduler.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    SharpAcScheduler::SharpAcScheduler()
+        : units(0), spacing(500), started(false), lastStart(0), latencyCount(0), latencyNext(0), maxLatency(0)
+    {
+      for (uint8_t i = 0; i < SHARP_NODE_MAX_UNITS; i++)
+      {
+        cores[i] = nullptr;
+        stats[i] = SharpNodeUnitStats();
+        requestMicros[i] = 0;
+        awaiting[i] = false;
+      }
+    }
+
+    int SharpAcScheduler::add(SharpAcCore *core)
+    {
+      if (units == SHARP_NODE_MAX_UNITS)
+        return -1;
+      cores[units] = core;
+      return units++;
+    }
+
+    // The phase is taken from now modulo interval, so it holds across
+    // polls that run late. Where millis() wraps every ~49.7 days one period
+    // comes out shorter, the phases stay apart.
+    uint32_t SharpAcScheduler::pollPeriodStart(uint8_t slot, uint32_t now, uint32_t interval) const
+    {
+      if (units == 0 || interval == 0)
+        return now;
+      uint32_t offset = static_cast<uint32_t>(static_cast<uint64_t>(slot) * interval / units);
+      uint32_t phase = (now % interval + interval - offset) % interval;
+      return now - phase;
+    }
+
+    uint32_t SharpAcScheduler::millisUntilStart(uint32_t now) const
+    {
+      if (!started)
+        return 0;
+      uint32_t elapsed = now - lastStart;
+      return elapsed >= spacing ? 0 : spacing - elapsed;
+    }
+
+    bool SharpAcScheduler::claimStart(uint32_t now)
+    {
+      if (this->millisUntilStart(now) > 0)
+        return false;
+      started = true;
+      lastStart = now;
+      return true;
+    }
+
+    void SharpAcScheduler::onRequest(uint8_t slot, uint32_t micros)
+    {
+      stats[slot].requests++;
+      requestMicros[slot] = micros;
+      awaiting[slot] = true;
+    }
+
+    void SharpAcScheduler::onResponse(uint8_t slot, uint32_t micros)
+    {
+      stats[slot].received++;
+      if (!awaiting[slot])
+        return;
+      awaiting[slot] = false;
+
+      uint32_t latency = micros - requestMicros[slot];
+      latencies[latencyNext] = latency;
+      latencyNext = (latencyNext + 1) % SHARP_NODE_LATENCY_SAMPLES;
+      if (latencyCount < SHARP_NODE_LATENCY_SAMPLES)
+        latencyCount++;
+      if (latency > maxLatency)
+        maxLatency = latency;
+    }
+
+    void SharpAcScheduler::onTimeout(uint8_t slot)
+    {
+      stats[slot].timeouts++;
+      awaiting[slot] = false;
+    }
+
+    void SharpAcScheduler::onHandshake(uint8_t slot)
+    {
+      stats[slot].handshakes++;
+    }
+
+    void SharpAcScheduler::onPoll(uint8_t slot)
+    {
+      stats[slot].polls++;
+    }
+
+    uint32_t SharpAcScheduler::getFrames() const
+    {
+      uint32_t frames = 0;
+      for (uint8_t i = 0; i < units; i++)
+        frames += stats[i].requests + stats[i].received;
+      return frames;
+    }
+
+    uint32_t SharpAcScheduler::latencyPercentile(uint8_t percent) const
+    {
+      if (latencyCount == 0)
+        return 0;
+
+      // Insertion sort of a copy, a few dozen entries when a report is due
+      uint32_t sorted[SHARP_NODE_LATENCY_SAMPLES];
+      for (uint8_t i = 0; i < latencyCount; i++)
+      {
+        uint32_t value = latencies[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > value; j--)
+          sorted[j] = sorted[j - 1];
+        sorted[j] = value;
+      }
+
+      if (percent > 100)
+        percent = 100;
+      size_t rank = (static_cast<size_t>(percent) * (latencyCount - 1) + 50) / 100;
+      return sorted[rank];
+    }
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    class SharpAcCore;
+
+    // Cores a scheduler takes, one per UART of the node
+    const uint8_t SHARP_NODE_MAX_UNITS = 8;
+    // Response times kept for the node's percentiles
+    const uint8_t SHARP_NODE_LATENCY_SAMPLES = 32;
+
+    struct SharpNodeUnitStats
+    {
+      uint32_t requests;
+      // Frames decoded, answers and whatever the AC sent by itself
+      uint32_t received;
+      uint32_t timeouts;
+      // init_msg sent, first attempts and retries
+      uint32_t handshakes;
+      uint32_t polls;
+    };
+
+    // Shared by the cores of one node, so that their time driven work
+    // doesn't line up: without it every core starts its handshake at boot,
+    // polls a minute after connecting and retries 10s after a timeout, all
+    // at the same moment when the ACs were powered together.
+    //
+    // - Polls keep each core's interval but are spread evenly over it by
+    //   slot, on the node's millis() clock.
+    // - Handshake starts and retries are spaced at least spacing apart
+    //   across the node, in the order the cores ask.
+    //
+    // It also meters the cores' traffic for a node report: request and
+    // response counts per unit and the time from writing a request until
+    // the answer is decoded. Everything is fixed size, no heap.
+    class SharpAcScheduler
+    {
+    public:
+      SharpAcScheduler();
+
+      // Slot of the core, -1 once SHARP_NODE_MAX_UNITS are taken. Called
+      // by SharpAcCore::setScheduler().
+      int add(SharpAcCore *core);
+      uint8_t getUnits() const { return units; }
+      SharpAcCore *getCore(uint8_t slot) const { return slot < units ? cores[slot] : nullptr; }
+
+      // Minimum time between two handshake starts on the node
+      void setSpacing(uint32_t millis) { spacing = millis; }
+      uint32_t getSpacing() const { return spacing; }
+
+      // Start of the slot's poll period that contains now. The next poll is
+      // due interval after it.
+      uint32_t pollPeriodStart(uint8_t slot, uint32_t now, uint32_t interval) const;
+
+      // 0 if a handshake may start now
+      uint32_t millisUntilStart(uint32_t now) const;
+      // True if a handshake may start now, which then counts as started
+      bool claimStart(uint32_t now);
+
+      // Metering, called by the cores
+      void onRequest(uint8_t slot, uint32_t micros);
+      void onResponse(uint8_t slot, uint32_t micros);
+      void onTimeout(uint8_t slot);
+      void onHandshake(uint8_t slot);
+      void onPoll(uint8_t slot);
+
+      const SharpNodeUnitStats &getStats(uint8_t slot) const { return stats[slot]; }
+      // Requests sent and frames received by all units so far
+      uint32_t getFrames() const;
+      // percent in [0, 100] over the kept response times of all units, in
+      // microseconds, 0 without any
+      uint32_t latencyPercentile(uint8_t percent) const;
+      uint32_t getMaxLatency() const { return maxLatency; }
+
+    private:
+      SharpAcCore *cores[SHARP_NODE_MAX_UNITS];
+      SharpNodeUnitStats stats[SHARP_NODE_MAX_UNITS];
+      uint32_t requestMicros[SHARP_NODE_MAX_UNITS];
+      bool awaiting[SHARP_NODE_MAX_UNITS];
+      uint8_t units;
+
+      uint32_t spacing;
+      bool started;
+      uint32_t lastStart;
+
+      uint32_t latencies[SHARP_NODE_LATENCY_SAMPLES];
+      uint8_t latencyCount;
+      uint8_t latencyNext;
+      uint32_t maxLatency;
+    };
+  }
+}
@@ -34,4 +34,6 @@ public:
         ion = other.ion;
         preset = other.preset;
     }
+
+    SharpState &operator=(const SharpState &other) = default;
 };
\ No newline at end of file
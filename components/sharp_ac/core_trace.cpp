@@ -0,0 +1,128 @@
+#include "core_trace.h"
+
+#include <cstdio>
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    size_t SharpTraceEntry::format(char *out, size_t outSize) const
+    {
+      if (outSize == 0)
+        return 0;
+
+      int n = snprintf(out, outSize, "@%u %s: ", (unsigned)this->millis, this->tx ? "TX" : "RX");
+      if (n < 0 || static_cast<size_t>(n) >= outSize)
+        return outSize - 1;
+
+      // Same as the RX:/TX: debug log lines
+      if (this->size == 1 && this->data[0] == 0x06)
+      {
+        int ack = snprintf(out + n, outSize - n, "ACK");
+        return ack > 0 && static_cast<size_t>(n + ack) < outSize ? n + ack : outSize - 1;
+      }
+
+      SharpFrame frame(this->data, this->size);
+      return n + frame.formatHex(out + n, outSize - n);
+    }
+
+    SharpFrameTrace::SharpFrameTrace()
+        : buffer(nullptr), capacity(0), head(0), tail(0), used(0), entries(0), recorded(0), overwritten(0)
+    {
+    }
+
+    SharpFrameTrace::~SharpFrameTrace()
+    {
+      delete[] buffer;
+    }
+
+    void SharpFrameTrace::setCapacity(size_t bytes)
+    {
+      delete[] buffer;
+      buffer = nullptr;
+      capacity = 0;
+
+      // Room for at least one frame of the largest size
+      if (bytes > 0)
+      {
+        if (bytes < SHARP_TRACE_ENTRY_OVERHEAD + SHARP_MAX_FRAME_SIZE)
+          bytes = SHARP_TRACE_ENTRY_OVERHEAD + SHARP_MAX_FRAME_SIZE;
+        buffer = new uint8_t[bytes];
+        capacity = bytes;
+      }
+      this->clear();
+    }
+
+    void SharpFrameTrace::clear()
+    {
+      head = 0;
+      tail = 0;
+      used = 0;
+      entries = 0;
+      recorded = 0;
+      overwritten = 0;
+    }
+
+    void SharpFrameTrace::put(uint8_t byte)
+    {
+      buffer[head] = byte;
+      head = (head + 1) % capacity;
+      used++;
+    }
+
+    void SharpFrameTrace::dropOldest()
+    {
+      size_t size = SHARP_TRACE_ENTRY_OVERHEAD + (at(tail) & 0x7F);
+      tail = (tail + size) % capacity;
+      used -= size;
+      entries--;
+      overwritten++;
+    }
+
+    void SharpFrameTrace::record(bool tx, const uint8_t *data, size_t len, uint32_t millis)
+    {
+      if (capacity == 0 || len == 0)
+        return;
+      if (len > SHARP_MAX_FRAME_SIZE)
+        len = SHARP_MAX_FRAME_SIZE;
+
+      size_t size = SHARP_TRACE_ENTRY_OVERHEAD + len;
+      while (capacity - used < size)
+        this->dropOldest();
+
+      this->put(static_cast<uint8_t>((tx ? 0x80 : 0x00) | len));
+      for (int i = 0; i < 4; i++)
+        this->put(static_cast<uint8_t>(millis >> (8 * i)));
+      for (size_t i = 0; i < len; i++)
+        this->put(data[i]);
+
+      entries++;
+      recorded++;
+    }
+
+    SharpFrameTrace::Cursor SharpFrameTrace::first() const
+    {
+      Cursor cursor = {tail, entries};
+      return cursor;
+    }
+
+    bool SharpFrameTrace::next(Cursor &cursor, SharpTraceEntry &entry) const
+    {
+      if (cursor.remaining == 0 || capacity == 0)
+        return false;
+
+      uint8_t flags = at(cursor.pos);
+      entry.tx = (flags & 0x80) != 0;
+      entry.size = flags & 0x7F;
+      entry.millis = 0;
+      for (int i = 0; i < 4; i++)
+        entry.millis |= static_cast<uint32_t>(at(cursor.pos + 1 + i)) << (8 * i);
+      for (size_t i = 0; i < entry.size; i++)
+        entry.data[i] = at(cursor.pos + SHARP_TRACE_ENTRY_OVERHEAD + i);
+
+      cursor.pos = (cursor.pos + SHARP_TRACE_ENTRY_OVERHEAD + entry.size) % capacity;
+      cursor.remaining--;
+      return true;
+    }
+  }
+}
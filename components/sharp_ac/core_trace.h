@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "core_frame.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // Per entry: one byte with the direction (bit 7 = TX) and frame length,
+    // millis() as four bytes little endian, then the frame bytes
+    const size_t SHARP_TRACE_ENTRY_OVERHEAD = 5;
+    // "@4294967295 TX: " in front of the hex dump
+    const size_t SHARP_TRACE_LINE_SIZE = SHARP_HEX_BUFFER_SIZE + 20;
+
+    struct SharpTraceEntry
+    {
+      uint32_t millis;
+      bool tx;
+      uint8_t size;
+      uint8_t data[SHARP_MAX_FRAME_SIZE];
+
+      // "@123456 RX: DC.0B.FC... (14)", the capture log layout the host
+      // tools read
+      size_t format(char *out, size_t outSize) const;
+    };
+
+    // Ring buffer of the last RX/TX frames in binary form. Recording copies
+    // the bytes and nothing else, formatting only happens when the trace is
+    // read. The oldest entries are dropped to make room for new ones.
+    class SharpFrameTrace
+    {
+    public:
+      struct Cursor
+      {
+        size_t pos;
+        size_t remaining;
+      };
+
+      SharpFrameTrace();
+      ~SharpFrameTrace();
+
+      // Allocates the buffer once, 0 turns tracing off
+      void setCapacity(size_t bytes);
+      size_t getCapacity() const { return capacity; }
+      bool enabled() const { return capacity > 0; }
+
+      void record(bool tx, const uint8_t *data, size_t len, uint32_t millis);
+      void clear();
+
+      // Entries held, oldest first: for (Cursor c = first(); next(c, entry);)
+      size_t count() const { return entries; }
+      Cursor first() const;
+      bool next(Cursor &cursor, SharpTraceEntry &entry) const;
+
+      uint32_t getRecorded() const { return recorded; }
+      uint32_t getOverwritten() const { return overwritten; }
+
+    private:
+      SharpFrameTrace(const SharpFrameTrace &) = delete;
+      SharpFrameTrace &operator=(const SharpFrameTrace &) = delete;
+
+      uint8_t at(size_t pos) const { return buffer[pos % capacity]; }
+      void put(uint8_t byte);
+      void dropOldest();
+
+      uint8_t *buffer;
+      size_t capacity;
+      size_t head;
+      size_t tail;
+      size_t used;
+      size_t entries;
+      uint32_t recorded;
+      uint32_t overwritten;
+    };
+  }
+}
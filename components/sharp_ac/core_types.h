@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 const int IonMode = 0x80;
 
 enum class PowerMode
@@ -43,4 +45,43 @@ enum class SwingHorizontal
     middle = 0x1,
     right = 0x2,
     left = 0x3,
-};
\ No newline at end of file
+};
+
+// Decoded nibbles only name a setting if they match one of the values above,
+// anything else read off the line must not reach the state
+inline bool isKnown(PowerMode mode)
+{
+    return mode == PowerMode::heat || mode == PowerMode::cool || mode == PowerMode::dry || mode == PowerMode::fan;
+}
+
+inline bool isKnown(FanMode fan)
+{
+    return fan == FanMode::low || fan == FanMode::mid || fan == FanMode::high || fan == FanMode::highest ||
+           fan == FanMode::auto_fan;
+}
+
+inline bool isKnown(SwingVertical swing)
+{
+    uint8_t value = static_cast<uint8_t>(swing);
+    return swing == SwingVertical::swing || (value >= 0x8 && value <= 0xD);
+}
+
+inline bool isKnown(SwingHorizontal swing)
+{
+    return swing == SwingHorizontal::swing || swing == SwingHorizontal::middle || swing == SwingHorizontal::right ||
+           swing == SwingHorizontal::left;
+}
+
+enum class SharpFrameType
+{
+    none,
+    ack,
+    handshake,
+    mode_response,
+    status_response,
+    unknown,
+    // Number of frame types, keep last
+    count
+};
+
+const int SharpFrameTypeCount = static_cast<int>(SharpFrameType::count);
\ No newline at end of file
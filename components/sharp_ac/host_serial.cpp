@@ -0,0 +1,245 @@
+#include "host_serial.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "core_frame.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // How long a write waits for room in the kernel buffer before the
+    // rest of the frame is dropped
+    static const int WRITE_TIMEOUT_MS = 100;
+
+    static uint64_t monotonicMicros()
+    {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+    }
+
+    static bool baudConstant(uint32_t baudRate, speed_t *speed)
+    {
+      switch (baudRate)
+      {
+      case 1200:
+        *speed = B1200;
+        return true;
+      case 2400:
+        *speed = B2400;
+        return true;
+      case 4800:
+        *speed = B4800;
+        return true;
+      case 9600:
+        *speed = B9600;
+        return true;
+      case 19200:
+        *speed = B19200;
+        return true;
+      case 38400:
+        *speed = B38400;
+        return true;
+      case 57600:
+        *speed = B57600;
+        return true;
+      case 115200:
+        *speed = B115200;
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    static bool isPty(int fd)
+    {
+      const char *name = ttyname(fd);
+      return name != nullptr && (strncmp(name, "/dev/pts/", 9) == 0 || strncmp(name, "/dev/ttys", 9) == 0);
+    }
+
+    SharpSerialPort::SharpSerialPort() : startMicros(monotonicMicros()) {}
+
+    SharpSerialPort::~SharpSerialPort()
+    {
+      this->close();
+    }
+
+    void SharpSerialPort::fail(const char *what)
+    {
+      this->error = std::string(what) + ": " + strerror(errno);
+      this->close();
+    }
+
+    bool SharpSerialPort::open(const char *path, uint32_t baudRate)
+    {
+      this->close();
+
+      speed_t speed;
+      if (!baudConstant(baudRate, &speed))
+      {
+        this->error = "unsupported baud rate " + std::to_string(baudRate);
+        return false;
+      }
+
+      this->fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+      if (this->fd < 0)
+      {
+        this->fail(path);
+        return false;
+      }
+
+      struct termios tio;
+      if (tcgetattr(this->fd, &tio) != 0)
+      {
+        this->fail("tcgetattr");
+        return false;
+      }
+      cfmakeraw(&tio);
+      // Non-blocking reads, loop() polls available()
+      tio.c_cc[VMIN] = 0;
+      tio.c_cc[VTIME] = 0;
+      tcflag_t hardware = tio.c_cflag;
+      tio.c_cflag &= ~(CSIZE | CSTOPB | PARODD | CRTSCTS);
+      tio.c_cflag |= CS8 | PARENB | CLOCAL | CREAD;
+      cfsetispeed(&tio, speed);
+      cfsetospeed(&tio, speed);
+      if (tcsetattr(this->fd, TCSANOW, &tio) != 0)
+      {
+        // Once a pty is in raw mode Linux refuses parity changes on it.
+        // There is no line, raw mode alone is what matters.
+        tio.c_cflag = hardware;
+        if (!isPty(this->fd) || tcsetattr(this->fd, TCSANOW, &tio) != 0)
+        {
+          this->fail("tcsetattr");
+          return false;
+        }
+      }
+      tcflush(this->fd, TCIOFLUSH);
+
+      this->error.clear();
+      return true;
+    }
+
+    void SharpSerialPort::close()
+    {
+      if (this->fd >= 0)
+        ::close(this->fd);
+      this->fd = -1;
+      this->peeked = false;
+    }
+
+    size_t SharpSerialPort::available()
+    {
+      if (this->fd < 0)
+        return 0;
+      int pending = 0;
+      if (ioctl(this->fd, FIONREAD, &pending) != 0 || pending < 0)
+        pending = 0;
+      return static_cast<size_t>(pending) + (this->peeked ? 1 : 0);
+    }
+
+    size_t SharpSerialPort::read_array(uint8_t *data, size_t len)
+    {
+      size_t n = 0;
+      if (len > 0 && this->peeked)
+      {
+        data[n++] = this->peekByte;
+        this->peeked = false;
+      }
+      while (n < len && this->fd >= 0)
+      {
+        ssize_t got = ::read(this->fd, data + n, len - n);
+        if (got > 0)
+          n += static_cast<size_t>(got);
+        else if (got < 0 && errno == EINTR)
+          continue;
+        else
+          break;
+      }
+      return n;
+    }
+
+    uint8_t SharpSerialPort::peek()
+    {
+      if (!this->peeked && this->read_array(&this->peekByte, 1) == 1)
+        this->peeked = true;
+      return this->peeked ? this->peekByte : 0;
+    }
+
+    uint8_t SharpSerialPort::read()
+    {
+      uint8_t value = 0;
+      this->read_array(&value, 1);
+      return value;
+    }
+
+    void SharpSerialPort::write_array(const uint8_t *data, size_t len)
+    {
+      size_t n = 0;
+      while (n < len && this->fd >= 0)
+      {
+        ssize_t sent = ::write(this->fd, data + n, len - n);
+        if (sent > 0)
+        {
+          n += static_cast<size_t>(sent);
+          continue;
+        }
+        if (sent < 0 && errno == EINTR)
+          continue;
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+          break;
+
+        struct pollfd pfd = {this->fd, POLLOUT, 0};
+        if (poll(&pfd, 1, WRITE_TIMEOUT_MS) <= 0)
+          break;
+      }
+      if (n < len)
+        this->log_debug("sharp_ac", "Serial write dropped %u of %u bytes", (unsigned)(len - n), (unsigned)len);
+    }
+
+    unsigned long SharpSerialPort::get_millis()
+    {
+      return static_cast<uint32_t>((monotonicMicros() - this->startMicros) / 1000);
+    }
+
+    unsigned long SharpSerialPort::get_micros()
+    {
+      return static_cast<uint32_t>(monotonicMicros() - this->startMicros);
+    }
+
+    void SharpSerialPort::log_debug(const char *tag, const char *format, ...)
+    {
+      if (!this->verbose)
+        return;
+      va_list args;
+      va_start(args, format);
+      fprintf(stderr, "[%s] ", tag);
+      vfprintf(stderr, format, args);
+      fputc('\n', stderr);
+      va_end(args);
+    }
+
+    std::string SharpSerialPort::format_hex_pretty(const uint8_t *data, size_t len)
+    {
+      SharpFrame frame(data, len);
+      char hex[SHARP_HEX_BUFFER_SIZE];
+      frame.formatHex(hex, sizeof(hex));
+      return hex;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "core_logic.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // SharpAcHardwareInterface on a POSIX serial device, for the ESPHome
+    // host platform and the host tools. Works with a USB serial adapter on
+    // CN13 as well as with the slave side of a pty pair, which has no line
+    // settings to speak of.
+    class SharpSerialPort : public SharpAcHardwareInterface
+    {
+    public:
+      SharpSerialPort();
+      ~SharpSerialPort() override;
+
+      // Opens the device raw and non-blocking at `baudRate`, 8 data bits,
+      // even parity, one stop bit, the way CN13 talks. Returns false and
+      // keeps the reason in lastError() if the device can't be used.
+      bool open(const char *path, uint32_t baudRate = 9600);
+      void close();
+      bool isOpen() const { return this->fd >= 0; }
+      int getFd() const { return this->fd; }
+      const char *lastError() const { return this->error.c_str(); }
+
+      size_t read_array(uint8_t *data, size_t len) override;
+      size_t available() override;
+      void write_array(const uint8_t *data, size_t len) override;
+      uint8_t peek() override;
+      uint8_t read() override;
+      unsigned long get_millis() override;
+      unsigned long get_micros() override;
+      // Prints to stderr, only when verbose is set
+      void log_debug(const char *tag, const char *format, ...) override;
+      bool log_debug_enabled() override { return this->verbose; }
+      std::string format_hex_pretty(const uint8_t *data, size_t len) override;
+
+      bool verbose{false};
+
+    private:
+      void fail(const char *what);
+
+      int fd{-1};
+      // One byte read ahead by peek()
+      bool peeked{false};
+      uint8_t peekByte{0};
+      uint64_t startMicros;
+      std::string error;
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,30 @@
+#include <cstdlib>
+#include <new>
+
+#include "alloc_hook.h"
+
+static AllocCounters counters = {0, 0, 0};
+
+AllocCounters alloc_counters() {
+    return counters;
+}
+
+static void* counted_alloc(size_t size) {
+    counters.allocations++;
+    counters.bytes += size;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+static void counted_free(void* ptr) {
+    if (ptr) counters.frees++;
+    free(ptr);
+}
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
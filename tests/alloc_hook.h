@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+// ============================================================================
+// Heap Allocation Tracking
+// ============================================================================
+//
+// Linking alloc_hook.cpp replaces the global operator new/delete of a test
+// binary with counting versions. Only test and benchmark binaries link it,
+// the component never sees it.
+
+struct AllocCounters {
+    unsigned long allocations;
+    unsigned long frees;
+    unsigned long bytes;
+};
+
+AllocCounters alloc_counters();
+
+// Allocations made between construction and the accessor calls
+class AllocScope {
+public:
+    AllocScope() : start(alloc_counters()) {}
+
+    unsigned long allocations() const { return alloc_counters().allocations - start.allocations; }
+    unsigned long frees() const { return alloc_counters().frees - start.frees; }
+    unsigned long bytes() const { return alloc_counters().bytes - start.bytes; }
+
+private:
+    AllocCounters start;
+};
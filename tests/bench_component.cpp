@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "component_rig.h"
+#include "alloc_hook.h"
+
+// ============================================================================
+// Benchmark Harness
+// ============================================================================
+//
+// Same harness as bench_core, plus the log lines each operation formats.
+// On the device every ESP_LOGD below the configured level still costs a
+// level check, at DEBUG it costs a vsnprintf and a UART write.
+
+static volatile uint32_t sink;
+
+template <typename F>
+void run_benchmark(const char* name, long iterations, F body) {
+    for (long i = 0; i < iterations / 10 + 1; i++) {
+        body(i);
+    }
+
+    AllocScope allocs;
+    unsigned long logs = stub_log_count();
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    unsigned long allocations = allocs.allocations();
+    logs = stub_log_count() - logs;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("  %-40s %10.1f ns/op %8.2f allocs/op %6.1f logs/op\n", name, ns / iterations,
+           static_cast<double>(allocations) / iterations, static_cast<double>(logs) / iterations);
+}
+
+static const uint8_t cool_frame[14] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80};
+static const uint8_t heat_frame[14] = {0xdc, 0x0b, 0xfc, 0x73, 0x16, 0x51, 0x3d, 0x40, 0x84};
+
+// ============================================================================
+// State Publishing
+// ============================================================================
+
+void bench_publish(long iterations) {
+    printf("\n=== State -> entities ===\n");
+
+    ComponentRig rig;
+    rig.connect();
+    run_benchmark("SharpAc::publishUpdate (all entities)", iterations, [&](long) {
+        rig.ac.publishUpdate();
+        sink += rig.ac.mode;
+    });
+
+    ComponentRig bare(false);
+    run_benchmark("SharpAc::publishUpdate (climate only)", iterations, [&](long) {
+        bare.ac.publishUpdate();
+        sink += bare.ac.mode;
+    });
+
+    run_benchmark("VaneSelectHorizontal::setVal", iterations, [&](long i) {
+        rig.vaneH.setVal(i & 1 ? SwingHorizontal::left : SwingHorizontal::swing);
+        sink += rig.vaneH.state.size();
+    });
+
+    run_benchmark("VaneSelectVertical::setVal", iterations, [&](long i) {
+        rig.vaneV.setVal(i & 1 ? SwingVertical::low : SwingVertical::swing);
+        sink += rig.vaneV.state.size();
+    });
+
+    run_benchmark("SharpAc::updateConnectionStatus", iterations, [&](long i) {
+        rig.ac.updateConnectionStatus(i & 7 ? 8 : 3);
+        sink += rig.status.state.size();
+    });
+
+    // Mode frame on the line through loop() to the published entities
+    run_benchmark("mode frame -> loop() -> publish", iterations, [&](long i) {
+        rig.receive(i & 1 ? heat_frame : cool_frame, 14);
+        rig.step();
+        rig.uart.tx.clear();
+        sink += rig.ac.mode;
+    });
+}
+
+// ============================================================================
+// Home Assistant Calls
+// ============================================================================
+
+void bench_control(long iterations) {
+    printf("\n=== Home Assistant call -> command ===\n");
+
+    ComponentRig rig;
+    rig.connect();
+
+    run_benchmark("control() target temperature", iterations, [&](long i) {
+        rig.ac.make_call().set_target_temperature(static_cast<float>(18 + (i & 7))).perform();
+        rig.uart.tx.clear();
+        sink += rig.ac.mode;
+    });
+
+    run_benchmark("control() mode + temp + fan + swing", iterations, [&](long i) {
+        rig.ac.make_call()
+            .set_mode(i & 1 ? climate::CLIMATE_MODE_COOL : climate::CLIMATE_MODE_HEAT)
+            .set_target_temperature(22)
+            .set_fan_mode(climate::CLIMATE_FAN_HIGH)
+            .set_swing_mode(climate::CLIMATE_SWING_BOTH)
+            .perform();
+        rig.uart.tx.clear();
+        sink += rig.ac.mode;
+    });
+
+    run_benchmark("VaneSelectVertical::control", iterations, [&](long i) {
+        rig.vaneV.make_call(i & 1 ? "up" : "down_center");
+        rig.uart.tx.clear();
+        sink += rig.ac.mode;
+    });
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 100000;
+
+    printf("\n╔════════════════════════════════════════════════════════════╗\n");
+    printf("║          Sharp AC Component Benchmarks (Host Stub)         ║\n");
+    printf("╚════════════════════════════════════════════════════════════╝\n");
+    printf("  %ld iterations per benchmark\n", iterations);
+
+    bench_publish(iterations);
+    bench_control(iterations);
+
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "core_logic.h"
+#include "core_frame.h"
+#include "core_messages.h"
+#include "core_types.h"
+#include "core_state.h"
+#include "test_hardware.h"
+#include "alloc_hook.h"
+
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Benchmark Harness
+// ============================================================================
+
+// Keeps the optimizer from discarding benchmarked results
+static volatile uint32_t sink;
+
+template <typename F>
+void run_benchmark(const char* name, long iterations, F body) {
+    // Warm up caches and lazily grown buffers
+    for (long i = 0; i < iterations / 10 + 1; i++) {
+        body(i);
+    }
+
+    AllocScope allocs;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    unsigned long allocations = allocs.allocations();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("  %-40s %10.1f ns/op %8.2f allocs/op\n", name, ns / iterations,
+           static_cast<double>(allocations) / iterations);
+}
+
+// ============================================================================
+// Core with access to the RX path
+// ============================================================================
+
+class BenchSharpAcCore : public SharpAcCore {
+public:
+    BenchSharpAcCore(SharpAcHardwareInterface* hardware, SharpAcStateCallback* callback)
+        : SharpAcCore(hardware, callback) {
+        this->status = 8;
+        this->currentTemperature = 22.0f;
+    }
+
+    SharpRxFrame read() { return this->readMsg(); }
+};
+
+static const uint8_t mode_frame[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0xb2};
+static const uint8_t command_frame[] = {0xdd, 0x0b, 0xfb, 0x60, 0xcf, 0x31, 0x32, 0x00, 0xf9, 0x80, 0x00, 0xe4, 0x81, 0x8a};
+
+// ============================================================================
+// Frame Benchmarks
+// ============================================================================
+
+void bench_frames(long iterations) {
+    printf("\n=== Frames ===\n");
+
+    run_benchmark("SharpFrame construction", iterations, [](long) {
+        SharpFrame frame(mode_frame, sizeof(mode_frame));
+        sink += frame.getData()[3];
+    });
+
+    SharpFrame original(mode_frame, sizeof(mode_frame));
+    run_benchmark("SharpFrame copy", iterations, [&](long) {
+        SharpFrame copy(original);
+        sink += copy.getData()[3];
+    });
+
+    run_benchmark("SharpFrame::calcChecksum", iterations, [&](long i) {
+        original.getData()[4] = static_cast<uint8_t>(i);
+        sink += original.calcChecksum();
+    });
+
+    SharpState state;
+    SharpCommandFrame command;
+    run_benchmark("SharpCommandFrame::setData", iterations, [&](long i) {
+        state.temperature = 16 + (i % 15);
+        command.setData(&state);
+        sink += command.getData()[4];
+    });
+
+    run_benchmark("SharpCommandFrame setData+setChecksum", iterations, [&](long i) {
+        state.temperature = 16 + (i % 15);
+        command.setData(&state);
+        command.setChecksum();
+        sink += command.getData()[13];
+    });
+
+    SharpModeFrame response(mode_frame);
+    SharpModeFrame echo(command_frame);
+    run_benchmark("SharpModeFrame getters (0xFC)", iterations, [&](long) {
+        sink += response.getTemperature() + response.getState() + static_cast<int>(response.getFanMode()) +
+                static_cast<int>(response.getPowerMode()) + static_cast<int>(response.getSwingVertical()) +
+                static_cast<int>(response.getSwingHorizontal()) + static_cast<int>(response.getPreset()) +
+                response.getIon();
+    });
+    run_benchmark("SharpModeFrame getters (0xFB)", iterations, [&](long) {
+        sink += echo.getTemperature() + echo.getState() + static_cast<int>(echo.getFanMode()) +
+                static_cast<int>(echo.getPowerMode()) + static_cast<int>(echo.getSwingVertical()) +
+                static_cast<int>(echo.getSwingHorizontal()) + static_cast<int>(echo.getPreset()) +
+                echo.getIon();
+    });
+}
+
+// ============================================================================
+// RX Path Benchmarks
+// ============================================================================
+
+void bench_read(long iterations) {
+    printf("\n=== readMsg() (per 14 byte frame) ===\n");
+
+    TestHardwareInterface hw;
+    TestStateCallback cb;
+    BenchSharpAcCore core(&hw, &cb);
+
+    run_benchmark("readMsg bulk delivery", iterations, [&](long i) {
+        if (i % 1024 == 0) hw.reset();
+        hw.inject_rx_data(mode_frame, sizeof(mode_frame));
+        SharpRxFrame frame = core.read();
+        sink += frame.getSize();
+    });
+
+    run_benchmark("readMsg byte-at-a-time delivery", iterations, [&](long i) {
+        if (i % 1024 == 0) hw.reset();
+        for (size_t b = 0; b < sizeof(mode_frame); b++) {
+            hw.inject_rx_data(mode_frame + b, 1);
+            SharpRxFrame frame = core.read();
+            sink += frame.getSize();
+        }
+    });
+}
+
+// ============================================================================
+// loop() Benchmarks
+// ============================================================================
+
+void bench_loop(long iterations) {
+    printf("\n=== SharpAcCore::loop() ===\n");
+
+    TestHardwareInterface hw;
+    hw.capture_frames = false;
+    TestStateCallback cb;
+    BenchSharpAcCore core(&hw, &cb);
+
+    run_benchmark("loop() idle", iterations, [&](long) {
+        hw.advance_time(1);
+        core.loop();
+    });
+
+    // One cycle: the AC sends a mode frame, loop() decodes it and ACKs it
+    // once the line is quiet
+    run_benchmark("loop() mode frame + ACK cycle", iterations, [&](long i) {
+        if (i % 1024 == 0) hw.reset();
+        hw.inject_rx_data(mode_frame, sizeof(mode_frame));
+        core.loop();
+        hw.advance_time(20);
+        core.loop();
+    });
+
+    run_benchmark("loop() command + ACK cycle", iterations, [&](long i) {
+        if (i % 1024 == 0) hw.reset();
+        core.controlTemperature(16 + (i % 15));
+        hw.advance_time(20);
+        core.loop();
+        static const uint8_t ack = 0x06;
+        hw.inject_rx_data(&ack, 1);
+        core.loop();
+    });
+}
+
+// ============================================================================
+// Main Benchmark Runner
+// ============================================================================
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+
+    printf("\n╔════════════════════════════════════════════════════════════╗\n");
+    printf("║          Sharp AC Core Micro-Benchmarks                    ║\n");
+    printf("╚════════════════════════════════════════════════════════════╝\n");
+    printf("  %ld iterations per benchmark\n", iterations);
+
+    bench_frames(iterations);
+    bench_read(iterations / 10);
+    bench_loop(iterations / 10);
+
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "core_logic.h"
+#include "simulator.h"
+#include "emulated_ac.h"
+#include "fault_injection.h"
+
+using namespace esphome::sharp_ac;
+
+static const uint64_t SECOND = 1000000ULL;
+static const uint64_t MINUTE = 60 * SECOND;
+
+// ============================================================================
+// Recovery Benchmark
+// ============================================================================
+//
+// A connected core talks to the emulated AC through the fault injector. One
+// fault at a time is injected around a status poll, while the answer is
+// on the line, and the run continues until the core is connected again
+// and has decoded a mode or status frame sent after the fault. Until the
+// next fault, frames the AC sent that the core never decoded and writes
+// that never reached the line count as lost.
+//
+// Every fault class has a recovery limit and none may cost a reconnect. A
+// damaged answer is asked for again as soon as the line is quiet, only a
+// poll that never reached the AC waits for the 10 s response timeout.
+
+struct FaultProfile {
+    FaultClass type;
+    uint32_t amount;
+    uint64_t limit;
+};
+
+struct RecoveryReport {
+    uint32_t faults;
+    uint32_t recovered;
+    SimLatency recovery;
+    uint64_t framesLost;
+    uint64_t reconnects;
+};
+
+class FaultRun {
+public:
+    Simulator sim;
+    EmulatedAc ac;
+    FaultInjectingHardware faults;
+    SharpAcCore core;
+
+    explicit FaultRun(uint64_t seed) : sim(seed), faults(&sim, seed ^ 0x5eed), core(&faults, &sim) {
+        ac.faults.delayMicros = 2000;
+        ac.faults.jitterMicros = 8000;
+        sim.attach(&core, &ac);
+        core.setup();
+    }
+
+    // Frames of a known type, garbage that happens to pass as an unknown
+    // frame after a fault does not count
+    uint64_t decoded() const {
+        const SharpRxStats& stats = core.getRxStats();
+        uint64_t frames = 0;
+        for (int i = 0; i < SharpFrameTypeCount; i++) {
+            if (i != static_cast<int>(SharpFrameType::unknown)) frames += stats.frames[i];
+        }
+        return frames;
+    }
+
+    uint64_t responses() const {
+        const SharpRxStats& stats = core.getRxStats();
+        return stats.frames[static_cast<int>(SharpFrameType::mode_response)] +
+               stats.frames[static_cast<int>(SharpFrameType::status_response)];
+    }
+
+    // Runs in loop interval steps until the next status poll was written
+    bool runUntilPoll(uint64_t limit) {
+        uint64_t polls = sim.getStats().polls;
+        uint64_t end = sim.now() + limit;
+        while (sim.getStats().polls == polls && sim.now() < end) sim.run(16000);
+        return sim.getStats().polls != polls;
+    }
+};
+
+static void measure(const FaultProfile& profile, uint32_t count, uint64_t seed, RecoveryReport& report) {
+    FaultRun run(seed);
+    SimRandom rng(seed);
+    memset(&report, 0, sizeof(report));
+
+    if (!run.sim.runUntilConnected(10 * SECOND)) return;
+    // Warm up: one regular poll
+    run.runUntilPoll(2 * MINUTE);
+    run.sim.run(SECOND);
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!run.runUntilPoll(2 * MINUTE)) {
+            // Polling stopped for good, nothing left to measure
+            break;
+        }
+
+        // Aimed at the next poll, a minute after this one. RX faults land
+        // somewhere in the answer, which starts 2..10ms after the poll is
+        // on the line, a write failure hits the poll itself.
+        uint64_t at = run.sim.getLastPoll() + MINUTE + rng.uniform(0, 25000);
+        if (profile.type == FaultClass::write_failure) at = run.sim.getLastPoll() + MINUTE - 1000;
+        Fault fault = {profile.type, at, profile.amount};
+        run.faults.schedule(fault);
+        report.faults++;
+
+        uint64_t peerBefore = run.sim.getStats().peerFrames;
+        uint64_t decodedBefore = run.decoded();
+        uint32_t failedBefore = run.faults.getStats().writesFailed;
+        uint64_t reconnectsBefore = run.sim.getStats().reconnects;
+        uint64_t responsesAfterFault = 0;
+        // The simulator clock has no offset, it is the device clock
+        uint64_t start = at;
+
+        // Recovered: connected, and a response sent after the fault decoded
+        bool recovered = false;
+        while (run.sim.now() < start + 2 * MINUTE) {
+            run.sim.run(16000);
+            if (!run.faults.quiet()) {
+                responsesAfterFault = run.responses();
+                continue;
+            }
+            if (run.sim.getStatus() == 8 && run.responses() > responsesAfterFault && run.sim.now() > start) {
+                recovered = true;
+                break;
+            }
+        }
+        if (recovered && run.sim.now() - start <= profile.limit) {
+            report.recovered++;
+            report.recovery.add(run.sim.now() - start);
+        }
+
+        // Let the traffic of the fault settle before counting
+        run.sim.run(30 * SECOND);
+        uint64_t peerFrames = run.sim.getStats().peerFrames - peerBefore;
+        uint64_t decoded = run.decoded() - decodedBefore;
+        report.framesLost += peerFrames > decoded ? peerFrames - decoded : 0;
+        report.framesLost += run.faults.getStats().writesFailed - failedBefore;
+        report.reconnects += run.sim.getStats().reconnects - reconnectsBefore;
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 50;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+
+    printf("\n╔════════════════════════════════════════════════════════════╗\n");
+    printf("║         Sharp AC Fault Recovery Benchmark                  ║\n");
+    printf("╚════════════════════════════════════════════════════════════╝\n");
+    printf("\n%u faults per class, seed %llu, 9600 baud 8E1\n\n", count, (unsigned long long)seed);
+
+    static const FaultProfile profiles[] = {
+        {FaultClass::byte_loss, 1, SECOND},
+        {FaultClass::byte_loss, 4, SECOND},
+        {FaultClass::corruption, 1, SECOND},
+        {FaultClass::truncation, 6, SECOND},
+        {FaultClass::stall, 50000, SECOND},
+        {FaultClass::stall, 2000000, 3 * SECOND},
+        {FaultClass::write_failure, 1, 11 * SECOND},
+    };
+
+    printf("  %-26s %9s %12s %12s %12s %11s\n", "fault", "recovered", "avg ms", "max ms", "lost/fault",
+           "reconnects");
+    bool allRecovered = true;
+    auto wallStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++) {
+        const FaultProfile& profile = profiles[i];
+        RecoveryReport report;
+        measure(profile, count, seed + i, report);
+
+        char name[40];
+        if (profile.type == FaultClass::stall) {
+            snprintf(name, sizeof(name), "%s %u ms", faultClassName(profile.type), profile.amount / 1000);
+        } else {
+            snprintf(name, sizeof(name), "%s x%u", faultClassName(profile.type), profile.amount);
+        }
+        printf("  %-26s %4u/%-4u %12.1f %12.1f %12.2f %11llu\n", name, report.recovered, report.faults,
+               report.recovery.averageMicros() / 1000.0, report.recovery.maxMicros / 1000.0,
+               report.faults ? static_cast<double>(report.framesLost) / report.faults : 0.0,
+               (unsigned long long)report.reconnects);
+        allRecovered &= report.faults == count && report.recovered == report.faults && report.reconnects == 0;
+    }
+    double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    printf("\n  %.1f ms wall time\n", wall);
+
+    if (!allRecovered) {
+        printf("\n✗ Not every fault was recovered from within its limit and without a reconnect\n");
+        return 1;
+    }
+    return 0;
+}
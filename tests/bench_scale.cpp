@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "core_logic.h"
+#include "simulator.h"
+#include "emulated_ac.h"
+#include "alloc_hook.h"
+
+using namespace esphome::sharp_ac;
+
+static const uint64_t SECOND = 1000000ULL;
+static const uint64_t MINUTE = 60 * SECOND;
+static const uint64_t HOUR = 60 * MINUTE;
+
+// ============================================================================
+// Scaling Benchmark
+// ============================================================================
+//
+// N cores in one process, each with an emulated AC on its own simulated
+// 9600 baud line, run for a simulated hour on one thread the way
+// tools/gateway.cpp runs them: a unit's loop() is called when a byte
+// arrives on its line or its millisUntilDue() expires, earliest first.
+// Every unit gets a command every 5 minutes on average.
+//
+// The host is one CPU: the time each loop() call really takes is added to
+// the simulated clock, and a unit due while another one runs waits for
+// it. Command-to-ACK latency therefore grows once the units keep the CPU
+// busy, on top of the line time. Serial I/O costs no syscalls here, so
+// the capacity column is an upper bound for the protocol work alone.
+
+static const uint64_t CHAR_MICROS = 11 * SECOND / 9600;
+static const uint64_t COMMAND_EVERY = 5 * MINUTE;
+
+struct HostCpu {
+    uint64_t clock = 0;
+    // Run time not yet a whole microsecond on the clock
+    uint64_t carryNanos = 0;
+
+    void charge(uint64_t nanos) {
+        carryNanos += nanos;
+        clock += carryNanos / 1000;
+        carryNanos %= 1000;
+    }
+};
+
+class BenchUnit : public SharpAcHardwareInterface, public SharpAcStateCallback, public SimLine {
+public:
+    BenchUnit(HostCpu& cpu, uint64_t seed) : cpu(cpu), rng(seed) {
+        AllocScope allocs;
+        core.reset(new SharpAcCore(this, this));
+        coreBytes = sizeof(SharpAcCore) + allocs.bytes();
+    }
+
+    SharpAcCore& getCore() { return *core; }
+    int getStatus() const { return status; }
+    size_t getCoreBytes() const { return coreBytes; }
+    uint64_t getFrames() const { return framesOut + framesIn(); }
+
+    // Next time a byte from the AC is complete on the line, UINT64_MAX if
+    // none is on its way
+    uint64_t nextArrival() const {
+        for (size_t i = 0; i < rx.size(); i++) {
+            if (rx[i].time > cpu.clock) return rx[i].time;
+        }
+        return UINT64_MAX;
+    }
+
+    void command(int temperature) {
+        commandAt = cpu.clock;
+        acksBefore = acks();
+        core->controlTemperature(temperature);
+    }
+
+    bool commandPending() const { return commandAt != 0; }
+
+    // After loop(): the command's ACK arrived, returns its latency
+    bool takeAck(uint64_t& micros) {
+        if (commandAt == 0 || acks() == acksBefore) return false;
+        micros = cpu.clock - commandAt;
+        commandAt = 0;
+        return true;
+    }
+
+    // SimLine
+    SimRandom& random() override { return rng; }
+
+    void send(const uint8_t* data, size_t len, uint64_t delayMicros = 0) override {
+        uint64_t start = replyBase + delayMicros;
+        if (start < acLineFree) start = acLineFree;
+        for (size_t i = 0; i < len; i++) {
+            RxByte byte = {start + (i + 1) * CHAR_MICROS, data[i]};
+            rx.push_back(byte);
+        }
+        acLineFree = start + len * CHAR_MICROS;
+    }
+
+    // SharpAcHardwareInterface
+    size_t read_array(uint8_t* data, size_t len) override {
+        size_t count = 0;
+        while (count < len && !rx.empty() && rx.front().time <= cpu.clock) {
+            data[count++] = rx.front().value;
+            rx.pop_front();
+        }
+        return count;
+    }
+
+    size_t available() override {
+        size_t count = 0;
+        for (size_t i = 0; i < rx.size() && rx[i].time <= cpu.clock; i++) count++;
+        return count;
+    }
+
+    // The AC gets the frame once it is through the line, its answer starts
+    // from there
+    void write_array(const uint8_t* data, size_t len) override {
+        uint64_t start = cpu.clock > coreLineFree ? cpu.clock : coreLineFree;
+        coreLineFree = start + len * CHAR_MICROS;
+        framesOut++;
+        replyBase = coreLineFree;
+        ac.receive(*this, data, len);
+    }
+
+    uint8_t peek() override { return available() ? rx.front().value : 0; }
+
+    uint8_t read() override {
+        uint8_t value = 0;
+        read_array(&value, 1);
+        return value;
+    }
+
+    unsigned long get_millis() override { return static_cast<uint32_t>(cpu.clock / 1000); }
+    unsigned long get_micros() override { return static_cast<uint32_t>(cpu.clock); }
+
+    void log_debug(const char* tag, const char* format, ...) override {
+        (void)tag;
+        (void)format;
+    }
+
+    std::string format_hex_pretty(const uint8_t* data, size_t len) override {
+        SharpFrame frame(data, len);
+        char hex[SHARP_HEX_BUFFER_SIZE];
+        frame.formatHex(hex, sizeof(hex));
+        return hex;
+    }
+
+    // SharpAcStateCallback
+    void on_state_update() override {}
+    void on_ion_state_update(bool state) override { (void)state; }
+    void on_vane_horizontal_update(SwingHorizontal val) override { (void)val; }
+    void on_vane_vertical_update(SwingVertical val) override { (void)val; }
+    void on_connection_status_update(int status) override { this->status = status; }
+
+    // Scheduling state, owned by the benchmark loop
+    uint64_t due = 0;
+    uint32_t generation = 0;
+
+private:
+    struct RxByte {
+        uint64_t time;
+        uint8_t value;
+    };
+
+    uint64_t acks() const { return core->getRxStats().frames[static_cast<int>(SharpFrameType::ack)]; }
+
+    uint64_t framesIn() const {
+        const SharpRxStats& stats = core->getRxStats();
+        uint64_t frames = 0;
+        for (int i = 0; i < SharpFrameTypeCount; i++) frames += stats.frames[i];
+        return frames;
+    }
+
+    HostCpu& cpu;
+    SimRandom rng;
+    EmulatedAc ac;
+    std::unique_ptr<SharpAcCore> core;
+    size_t coreBytes;
+    std::deque<RxByte> rx;
+    uint64_t replyBase = 0;
+    uint64_t acLineFree = 0;
+    uint64_t coreLineFree = 0;
+    uint64_t framesOut = 0;
+    int status = 0;
+    uint64_t commandAt = 0;
+    uint64_t acksBefore = 0;
+};
+
+struct ScaleReport {
+    size_t units;
+    uint32_t connected;
+    uint64_t frames;
+    uint64_t loops;
+    double cpuSeconds;
+    double coreBytes;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t max;
+};
+
+static uint64_t percentile(std::vector<uint64_t>& samples, double p) {
+    if (samples.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+static void measure(size_t count, uint64_t duration, uint64_t seed, ScaleReport& report) {
+    struct Event {
+        uint64_t time;
+        uint32_t generation;
+        uint32_t unit;
+        // A command instead of a loop() call
+        bool command;
+        bool operator>(const Event& other) const { return time > other.time; }
+    };
+
+    HostCpu cpu;
+    SimRandom rng(seed);
+    std::vector<std::unique_ptr<BenchUnit>> units;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::vector<uint64_t> latencies;
+    memset(&report, 0, sizeof(report));
+    report.units = count;
+
+    for (size_t i = 0; i < count; i++) {
+        units.push_back(std::unique_ptr<BenchUnit>(new BenchUnit(cpu, seed + i + 1)));
+        report.coreBytes += units.back()->getCoreBytes();
+    }
+    report.coreBytes /= count;
+
+    // Like Gateway::schedule(): 0 means a frame in progress or a TX queue
+    // waiting for a quiet line, check again in a millisecond
+    auto schedule = [&](uint32_t index) {
+        BenchUnit& unit = *units[index];
+        uint32_t millis = unit.getCore().millisUntilDue();
+        uint64_t due = cpu.clock + (millis == 0 ? (unit.available() > 0 ? 0 : 1000) : millis * 1000ULL);
+        uint64_t arrival = unit.nextArrival();
+        if (arrival < due) due = arrival;
+        unit.due = due;
+        unit.generation++;
+        Event event = {due, unit.generation, index, false};
+        events.push(event);
+    };
+    auto nextCommand = [&](uint32_t index) {
+        Event event = {cpu.clock + rng.uniform(0, static_cast<uint32_t>(2 * COMMAND_EVERY)), 0, index, true};
+        events.push(event);
+    };
+
+    clock_t cpuStart = clock();
+    for (uint32_t i = 0; i < count; i++) {
+        units[i]->getCore().setup();
+        schedule(i);
+        nextCommand(i);
+    }
+
+    while (!events.empty() && events.top().time <= duration) {
+        Event event = events.top();
+        events.pop();
+        BenchUnit& unit = *units[event.unit];
+        if (!event.command && event.generation != unit.generation) continue;
+
+        // Waits for whatever ran before it
+        if (event.time > cpu.clock) cpu.clock = event.time;
+
+        if (event.command) {
+            if (unit.getStatus() == 8 && !unit.commandPending()) {
+                unit.command(16 + static_cast<int>(rng.uniform(0, 14)));
+                schedule(event.unit);
+            }
+            nextCommand(event.unit);
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        unit.getCore().loop();
+        report.loops++;
+        uint64_t micros = 0;
+        if (unit.takeAck(micros)) latencies.push_back(micros);
+        cpu.charge(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        schedule(event.unit);
+    }
+    report.cpuSeconds = static_cast<double>(clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    for (size_t i = 0; i < count; i++) {
+        if (units[i]->getStatus() == 8) report.connected++;
+        report.frames += units[i]->getFrames();
+    }
+    report.p50 = percentile(latencies, 0.5);
+    report.p99 = percentile(latencies, 0.99);
+    report.max = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end());
+}
+
+// 1, 2, 5, 10, 20, 50, ...
+static size_t nextCount(size_t units) {
+    size_t decade = 1;
+    while (decade * 10 <= units) decade *= 10;
+    return units == decade ? 2 * decade : units == 2 * decade ? 5 * decade : 10 * decade;
+}
+
+int main(int argc, char** argv) {
+    size_t maxUnits = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 10000;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+    const uint64_t duration = HOUR;
+
+    printf("\n╔════════════════════════════════════════════════════════════╗\n");
+    printf("║         Sharp AC Scaling Benchmark                         ║\n");
+    printf("╚════════════════════════════════════════════════════════════╝\n");
+    printf("\nOne simulated hour per row, one command per unit every 5 min, seed %llu\n\n",
+           (unsigned long long)seed);
+
+    printf("  %7s %9s %10s %11s %9s %9s %9s %9s %9s %12s\n", "units", "connected", "frames/s", "CPU ms/unit",
+           "ns/loop", "B/unit", "ACK p50", "p99", "max", "units/core");
+    bool allConnected = true;
+    double baseCpu = 0;
+    size_t knee = 0;
+    for (size_t units = 1; units <= maxUnits; units = nextCount(units)) {
+        ScaleReport report;
+        measure(units, duration, seed, report);
+
+        double loopNanos = report.loops ? report.cpuSeconds * 1e9 / report.loops : 0;
+        double cpuPerUnit = report.cpuSeconds / units;
+        // Units one CPU could keep up with in real time
+        double capacity = cpuPerUnit > 0 ? (duration / 1e6) / cpuPerUnit : 0;
+        printf("  %7zu %9u %10.1f %11.2f %9.0f %9.0f %7.1fms %7.1fms %7.1fms %12.0f\n", units, report.connected,
+               report.frames / (duration / 1e6), cpuPerUnit * 1000, loopNanos, report.coreBytes,
+               report.p50 / 1000.0, report.p99 / 1000.0, report.max / 1000.0, capacity);
+
+        allConnected &= report.connected == units;
+        // Below a hundred units clock() is too coarse to compare. Per loop()
+        // call is no measure here: a busy host reads more bytes per call.
+        if (units == 100) baseCpu = cpuPerUnit;
+        if (knee == 0 && baseCpu > 0 && cpuPerUnit > 1.5 * baseCpu) knee = units;
+    }
+
+    if (knee) {
+        printf("\n  CPU time per unit up by more than half from 100 units at %zu units\n", knee);
+    } else {
+        printf("\n  CPU time per unit within half of 100 units' up to %zu units\n", maxUnits);
+    }
+
+    if (!allConnected) {
+        printf("\n✗ Not every unit stayed connected\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+
+#include "comp_hardware.h"
+#include "comp_climate.h"
+#include "comp_ion_switch.h"
+#include "comp_vane_horizontal.h"
+#include "comp_vane_vertical.h"
+#include "comp_connection_status.h"
+#include "comp_reconnect_button.h"
+#include "comp_trace_dump_button.h"
+
+using namespace esphome;
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Component Rig
+// ============================================================================
+//
+// The ESPHome wrapper with every optional entity attached, wired the way
+// the code generated from climate.py does it, on the stub UART and clock
+// in esphome_stub/.
+
+class ComponentRig {
+public:
+    uart::UARTComponent uart;
+    SharpAc ac;
+    IonSwitch ion;
+    VaneSelectHorizontal vaneH;
+    VaneSelectVertical vaneV;
+    ConnectionStatusSensor status;
+    ReconnectButton reconnect;
+    TraceDumpButton traceDump;
+
+    explicit ComponentRig(bool entities = true) {
+        ac.set_uart_parent(&uart);
+        ac.set_name("Sharp AC");
+        if (entities) {
+            ion.set_parent(&ac);
+            vaneH.set_parent(&ac);
+            vaneV.set_parent(&ac);
+            status.set_parent(&ac);
+            reconnect.set_parent(&ac);
+            traceDump.set_parent(&ac);
+            ac.setIonSwitch(&ion);
+            ac.setVaneHorizontalSelect(&vaneH);
+            ac.setVaneVerticalSelect(&vaneV);
+            ac.setConnectionStatusSensor(&status);
+            ac.setReconnectButton(&reconnect);
+            ac.setTraceDumpButton(&traceDump);
+        }
+        ac.setup();
+    }
+
+    // One pass of the ESPHome main loop, `ms` after the previous one
+    void step(uint32_t ms = 16) {
+        stub_advance_micros(ms * 1000);
+        ac.loop();
+    }
+
+    // Puts a frame on the RX line, with its checksum if it has one
+    void receive(const uint8_t* data, size_t len) {
+        SharpFrame frame(data, len);
+        if (len > 1) frame.setChecksum();
+        uart.inject(frame.getData(), frame.getSize());
+    }
+
+    // Answers the handshake the way the AC does on CN13
+    bool connect() {
+        static const uint8_t handshake[8] = {0x02, 0xff, 0xff, 0x01, 0x01, 0x00, 0x00, 0x00};
+        static const uint8_t subscribe[8] = {0x03, 0xff, 0xa0, 0x01, 0x00, 0x00, 0x00, 0x00};
+        static const uint8_t mode[14] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80};
+        static const uint8_t status[18] = {0xdc, 0x0f, 0xfd, 0x00, 0x00, 0x00, 0x00, 22};
+        static const uint8_t ack[1] = {0x06};
+        const uint8_t* replies[] = {handshake, handshake, ack, subscribe, subscribe, mode, status, ack};
+        const size_t sizes[] = {8, 8, 1, 8, 8, 14, 18, 1};
+
+        step();
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            receive(replies[i], sizes[i]);
+            for (int n = 0; n < 4; n++) step();
+        }
+        uart.tx.clear();
+        return this->status.state == "Connected";
+    }
+
+    // Frames the component wrote since the last call, split on the
+    // command frame length
+    std::vector<std::vector<uint8_t>> takeCommands() {
+        std::vector<std::vector<uint8_t>> commands;
+        for (size_t i = 0; i + 14 <= uart.tx.size();) {
+            if (uart.tx[i] == 0xdd && uart.tx[i + 2] == 0xfb) {
+                commands.push_back(std::vector<uint8_t>(uart.tx.begin() + i, uart.tx.begin() + i + 14));
+                i += 14;
+            } else {
+                i++;
+            }
+        }
+        uart.tx.clear();
+        return commands;
+    }
+};
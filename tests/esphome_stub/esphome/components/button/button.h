@@ -0,0 +1,26 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+// ============================================================================
+// ESPHome Stub: Button
+// ============================================================================
+
+namespace esphome
+{
+  namespace button
+  {
+    class Button : public EntityBase
+    {
+    public:
+      void press()
+      {
+        this->publish_count_++;
+        this->press_action();
+      }
+
+    protected:
+      virtual void press_action() = 0;
+    };
+  }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <set>
+
+#include "esphome/core/component.h"
+
+// ============================================================================
+// ESPHome Stub: Climate
+// ============================================================================
+//
+// Enum values and call API as in ESPHome. publish_state() only counts, a
+// test reads the published fields straight off the entity.
+
+namespace esphome
+{
+  namespace climate
+  {
+    enum ClimateMode : uint8_t
+    {
+      CLIMATE_MODE_OFF = 0,
+      CLIMATE_MODE_HEAT_COOL = 1,
+      CLIMATE_MODE_COOL = 2,
+      CLIMATE_MODE_HEAT = 3,
+      CLIMATE_MODE_FAN_ONLY = 4,
+      CLIMATE_MODE_DRY = 5,
+      CLIMATE_MODE_AUTO = 6,
+    };
+
+    enum ClimateFanMode : uint8_t
+    {
+      CLIMATE_FAN_ON = 0,
+      CLIMATE_FAN_OFF = 1,
+      CLIMATE_FAN_AUTO = 2,
+      CLIMATE_FAN_LOW = 3,
+      CLIMATE_FAN_MEDIUM = 4,
+      CLIMATE_FAN_HIGH = 5,
+      CLIMATE_FAN_MIDDLE = 6,
+      CLIMATE_FAN_FOCUS = 7,
+      CLIMATE_FAN_DIFFUSE = 8,
+      CLIMATE_FAN_QUIET = 9,
+    };
+
+    enum ClimatePreset : uint8_t
+    {
+      CLIMATE_PRESET_NONE = 0,
+      CLIMATE_PRESET_HOME = 1,
+      CLIMATE_PRESET_AWAY = 2,
+      CLIMATE_PRESET_BOOST = 3,
+      CLIMATE_PRESET_COMFORT = 4,
+      CLIMATE_PRESET_ECO = 5,
+      CLIMATE_PRESET_SLEEP = 6,
+      CLIMATE_PRESET_ACTIVITY = 7,
+    };
+
+    enum ClimateSwingMode : uint8_t
+    {
+      CLIMATE_SWING_OFF = 0,
+      CLIMATE_SWING_BOTH = 1,
+      CLIMATE_SWING_VERTICAL = 2,
+      CLIMATE_SWING_HORIZONTAL = 3,
+    };
+
+    class ClimateTraits
+    {
+    public:
+      void set_supports_current_temperature(bool supports) { supports_current_temperature_ = supports; }
+      void set_visual_min_temperature(float temperature) { visual_min_temperature_ = temperature; }
+      void set_visual_max_temperature(float temperature) { visual_max_temperature_ = temperature; }
+      void set_visual_temperature_step(float step) { visual_temperature_step_ = step; }
+
+      void add_supported_mode(ClimateMode mode) { modes_.insert(mode); }
+      void add_supported_fan_mode(ClimateFanMode mode) { fan_modes_.insert(mode); }
+      void add_supported_preset(ClimatePreset preset) { presets_.insert(preset); }
+      void add_supported_swing_mode(ClimateSwingMode mode) { swing_modes_.insert(mode); }
+
+      bool get_supports_current_temperature() const { return supports_current_temperature_; }
+      float get_visual_min_temperature() const { return visual_min_temperature_; }
+      float get_visual_max_temperature() const { return visual_max_temperature_; }
+      bool supports_mode(ClimateMode mode) const { return modes_.count(mode) > 0; }
+      bool supports_fan_mode(ClimateFanMode mode) const { return fan_modes_.count(mode) > 0; }
+      bool supports_preset(ClimatePreset preset) const { return presets_.count(preset) > 0; }
+      bool supports_swing_mode(ClimateSwingMode mode) const { return swing_modes_.count(mode) > 0; }
+
+    protected:
+      bool supports_current_temperature_{false};
+      float visual_min_temperature_{10};
+      float visual_max_temperature_{30};
+      float visual_temperature_step_{0.1f};
+      std::set<ClimateMode> modes_;
+      std::set<ClimateFanMode> fan_modes_;
+      std::set<ClimatePreset> presets_;
+      std::set<ClimateSwingMode> swing_modes_;
+    };
+
+    class Climate;
+
+    class ClimateCall
+    {
+    public:
+      explicit ClimateCall(Climate *parent) : parent_(parent) {}
+
+      ClimateCall &set_mode(ClimateMode mode)
+      {
+        mode_ = mode;
+        return *this;
+      }
+      ClimateCall &set_target_temperature(float temperature)
+      {
+        target_temperature_ = temperature;
+        return *this;
+      }
+      ClimateCall &set_fan_mode(ClimateFanMode fan_mode)
+      {
+        fan_mode_ = fan_mode;
+        return *this;
+      }
+      ClimateCall &set_preset(ClimatePreset preset)
+      {
+        preset_ = preset;
+        return *this;
+      }
+      ClimateCall &set_swing_mode(ClimateSwingMode swing_mode)
+      {
+        swing_mode_ = swing_mode;
+        return *this;
+      }
+
+      const optional<ClimateMode> &get_mode() const { return mode_; }
+      const optional<float> &get_target_temperature() const { return target_temperature_; }
+      const optional<ClimateFanMode> &get_fan_mode() const { return fan_mode_; }
+      const optional<ClimatePreset> &get_preset() const { return preset_; }
+      const optional<ClimateSwingMode> &get_swing_mode() const { return swing_mode_; }
+
+      inline void perform();
+
+    protected:
+      Climate *parent_;
+      optional<ClimateMode> mode_;
+      optional<float> target_temperature_;
+      optional<ClimateFanMode> fan_mode_;
+      optional<ClimatePreset> preset_;
+      optional<ClimateSwingMode> swing_mode_;
+    };
+
+    class Climate : public EntityBase
+    {
+    public:
+      ClimateMode mode{CLIMATE_MODE_OFF};
+      optional<ClimateFanMode> fan_mode;
+      optional<ClimatePreset> preset;
+      ClimateSwingMode swing_mode{CLIMATE_SWING_OFF};
+      float current_temperature{0};
+      float target_temperature{0};
+
+      virtual ~Climate() = default;
+
+      ClimateCall make_call() { return ClimateCall(this); }
+
+      void publish_state() { this->publish_count_++; }
+
+      virtual ClimateTraits traits() = 0;
+      virtual void control(const ClimateCall &call) = 0;
+
+      friend class ClimateCall;
+    };
+
+    inline void ClimateCall::perform() { parent_->control(*this); }
+  }
+}
+
+#define LOG_CLIMATE(prefix, type, obj) ESP_LOGCONFIG(TAG, "%s%s '%s'", prefix, type, (obj)->get_name().c_str())
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+#include "esphome/core/component.h"
+
+// ============================================================================
+// ESPHome Stub: Select
+// ============================================================================
+
+namespace esphome
+{
+  namespace select
+  {
+    class Select : public EntityBase
+    {
+    public:
+      std::string state;
+
+      void publish_state(const std::string &state)
+      {
+        this->state = state;
+        this->publish_count_++;
+      }
+
+      // What Home Assistant does when an option is picked
+      void make_call(const std::string &value) { this->control(value); }
+
+    protected:
+      virtual void control(const std::string &value) = 0;
+    };
+  }
+}
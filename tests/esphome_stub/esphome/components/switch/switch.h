@@ -0,0 +1,32 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+// ============================================================================
+// ESPHome Stub: Switch
+// ============================================================================
+
+namespace esphome
+{
+  namespace switch_
+  {
+    class Switch : public EntityBase
+    {
+    public:
+      bool state{false};
+
+      void publish_state(bool state)
+      {
+        this->state = state;
+        this->publish_count_++;
+      }
+
+      // What Home Assistant does when the switch is flipped
+      void turn_on() { this->write_state(true); }
+      void turn_off() { this->write_state(false); }
+
+    protected:
+      virtual void write_state(bool state) = 0;
+    };
+  }
+}
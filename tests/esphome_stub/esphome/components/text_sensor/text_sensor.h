@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include "esphome/core/component.h"
+
+// ============================================================================
+// ESPHome Stub: Text Sensor
+// ============================================================================
+
+namespace esphome
+{
+  namespace text_sensor
+  {
+    class TextSensor : public EntityBase
+    {
+    public:
+      std::string state;
+
+      void publish_state(const std::string &state)
+      {
+        this->state = state;
+        this->publish_count_++;
+      }
+    };
+  }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "esphome/core/component.h"
+
+// ============================================================================
+// ESPHome Stub: UART
+// ============================================================================
+//
+// The bus is two byte queues: inject() puts bytes on the RX line, written
+// bytes collect in tx until the test takes them.
+
+namespace esphome
+{
+  namespace uart
+  {
+    enum UARTParityOptions
+    {
+      UART_CONFIG_PARITY_NONE,
+      UART_CONFIG_PARITY_EVEN,
+      UART_CONFIG_PARITY_ODD,
+    };
+
+    class UARTComponent
+    {
+    public:
+      std::vector<uint8_t> rx;
+      size_t rxPos{0};
+      std::vector<uint8_t> tx;
+
+      void inject(const uint8_t *data, size_t len) { rx.insert(rx.end(), data, data + len); }
+
+      bool read_array(uint8_t *data, size_t len)
+      {
+        if (rx.size() - rxPos < len)
+          return false;
+        for (size_t i = 0; i < len; i++)
+          data[i] = rx[rxPos++];
+        if (rxPos == rx.size())
+        {
+          rx.clear();
+          rxPos = 0;
+        }
+        return true;
+      }
+
+      int available() const { return static_cast<int>(rx.size() - rxPos); }
+      void write_array(const uint8_t *data, size_t len) { tx.insert(tx.end(), data, data + len); }
+
+      uint32_t get_baud_rate() const { return baud_rate_; }
+      uint8_t get_data_bits() const { return data_bits_; }
+      uint8_t get_stop_bits() const { return stop_bits_; }
+      UARTParityOptions get_parity() const { return parity_; }
+
+      void set_baud_rate(uint32_t baud_rate) { baud_rate_ = baud_rate; }
+      void set_data_bits(uint8_t data_bits) { data_bits_ = data_bits; }
+      void set_stop_bits(uint8_t stop_bits) { stop_bits_ = stop_bits; }
+      void set_parity(UARTParityOptions parity) { parity_ = parity; }
+
+    protected:
+      // CN13: 9600 baud 8E1
+      uint32_t baud_rate_{9600};
+      uint8_t data_bits_{8};
+      uint8_t stop_bits_{1};
+      UARTParityOptions parity_{UART_CONFIG_PARITY_EVEN};
+    };
+
+    class UARTDevice
+    {
+    public:
+      UARTDevice() = default;
+      UARTDevice(UARTComponent *parent) : parent_(parent) {}
+      virtual ~UARTDevice() = default;
+
+      void set_uart_parent(UARTComponent *parent) { parent_ = parent; }
+
+      bool read_array(uint8_t *data, size_t len) { return parent_->read_array(data, len); }
+      int available() { return parent_->available(); }
+      void write_array(const uint8_t *data, size_t len) { parent_->write_array(data, len); }
+
+      uint8_t peek()
+      {
+        return parent_->available() > 0 ? parent_->rx[parent_->rxPos] : 0;
+      }
+
+      uint8_t read()
+      {
+        uint8_t byte = 0;
+        return parent_->read_array(&byte, 1) ? byte : 0;
+      }
+
+    protected:
+      UARTComponent *parent_{nullptr};
+    };
+  }
+}
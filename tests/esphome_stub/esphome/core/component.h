@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+// ============================================================================
+// ESPHome Stub: Component
+// ============================================================================
+
+namespace esphome
+{
+  class Component
+  {
+  public:
+    virtual ~Component() = default;
+    virtual void setup() {}
+    virtual void loop() {}
+    virtual void dump_config() {}
+    virtual float get_setup_priority() const { return 0.0f; }
+
+    // ESPHome stops calling loop() on a failed component, the test checks
+    void mark_failed() { failed_ = true; }
+    bool is_failed() const { return failed_; }
+
+  protected:
+    bool failed_{false};
+  };
+
+  // Base of every entity: name plus the number of publishes a test can check
+  class EntityBase
+  {
+  public:
+    void set_name(const char *name) { name_ = name; }
+    // ESPHome returns a StringRef, c_str() works on both
+    const std::string &get_name() const { return name_; }
+    unsigned long get_publish_count() const { return publish_count_; }
+
+  protected:
+    std::string name_;
+    unsigned long publish_count_{0};
+  };
+}
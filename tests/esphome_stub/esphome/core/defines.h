@@ -0,0 +1,8 @@
+#pragma once
+
+// ============================================================================
+// ESPHome Stub: Defines
+// ============================================================================
+//
+// ESPHome generates this file from the configuration. The stub defines
+// nothing, the host platform build passes -DUSE_HOST instead.
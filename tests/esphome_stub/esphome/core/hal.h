@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// ============================================================================
+// ESPHome Stub: Clock
+// ============================================================================
+//
+// millis() and micros() read a clock the test advances by hand
+
+namespace esphome
+{
+  inline uint32_t &stub_micros()
+  {
+    static uint32_t now = 0;
+    return now;
+  }
+
+  inline void stub_advance_micros(uint32_t us) { stub_micros() += us; }
+
+  inline uint32_t micros() { return stub_micros(); }
+  inline uint32_t millis() { return stub_micros() / 1000; }
+}
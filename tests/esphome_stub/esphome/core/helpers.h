@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "esphome/core/hal.h"
+
+// ============================================================================
+// ESPHome Stub: Helpers
+// ============================================================================
+
+namespace esphome
+{
+  template <typename T>
+  class Parented
+  {
+  public:
+    Parented() {}
+    Parented(T *parent) : parent_(parent) {}
+
+    T *get_parent() const { return parent_; }
+    void set_parent(T *parent) { parent_ = parent; }
+
+  protected:
+    T *parent_{nullptr};
+  };
+
+  // Same layout as ESPHome's: "DC.0B.FC (3)"
+  inline std::string format_hex_pretty(const uint8_t *data, size_t length)
+  {
+    static const char digits[] = "0123456789ABCDEF";
+    if (length == 0)
+      return "";
+    std::string result;
+    result.reserve(length * 3 + 8);
+    for (size_t i = 0; i < length; i++)
+    {
+      if (i > 0)
+        result += '.';
+      result += digits[data[i] >> 4];
+      result += digits[data[i] & 0x0F];
+    }
+    if (length > 4)
+    {
+      char suffix[16];
+      snprintf(suffix, sizeof(suffix), " (%u)", static_cast<unsigned>(length));
+      result += suffix;
+    }
+    return result;
+  }
+
+  // The subset of esphome::optional the component uses
+  template <typename T>
+  class optional
+  {
+  public:
+    optional() : has_(false), value_() {}
+    optional(const T &value) : has_(true), value_(value) {}
+
+    optional &operator=(const T &value)
+    {
+      has_ = true;
+      value_ = value;
+      return *this;
+    }
+
+    bool has_value() const { return has_; }
+    const T &value() const { return value_; }
+    const T &operator*() const { return value_; }
+    void reset() { has_ = false; }
+
+  private:
+    bool has_;
+    T value_;
+  };
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+
+// ============================================================================
+// ESPHome Stub: Logging
+// ============================================================================
+//
+// Messages are formatted like the device does at DEBUG level, so the cost
+// shows up in benchmarks, and only printed when stub_log_verbose() is set.
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+
+// Set from the logger's level in a real build
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_DEBUG
+#endif
+
+namespace esphome
+{
+  inline bool &stub_log_verbose()
+  {
+    static bool verbose = false;
+    return verbose;
+  }
+
+  inline unsigned long &stub_log_count()
+  {
+    static unsigned long count = 0;
+    return count;
+  }
+
+  inline void esp_log_vprintf_(int level, const char *tag, int line, const char *format, va_list args)
+  {
+    (void)line;
+    char message[256];
+    vsnprintf(message, sizeof(message), format, args);
+    stub_log_count()++;
+    if (stub_log_verbose())
+      printf("[%d][%s] %s\n", level, tag, message);
+  }
+
+  inline void esp_log_printf_(int level, const char *tag, int line, const char *format, ...)
+  {
+    va_list args;
+    va_start(args, format);
+    esp_log_vprintf_(level, tag, line, format, args);
+    va_end(args);
+  }
+}
+
+#define ESP_LOGE(tag, ...) esphome::esp_log_printf_(ESPHOME_LOG_LEVEL_ERROR, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) esphome::esp_log_printf_(ESPHOME_LOG_LEVEL_WARN, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) esphome::esp_log_printf_(ESPHOME_LOG_LEVEL_INFO, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) esphome::esp_log_printf_(ESPHOME_LOG_LEVEL_CONFIG, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) esphome::esp_log_printf_(ESPHOME_LOG_LEVEL_DEBUG, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) esphome::esp_log_printf_(ESPHOME_LOG_LEVEL_VERBOSE, tag, __LINE__, __VA_ARGS__)
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "core_logic.h"
+#include "simulator.h"
+
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Fault Injection
+// ============================================================================
+//
+// Decorator for any SharpAcHardwareInterface that injects faults at
+// scheduled times. Each fault hits the traffic that passes after its time:
+//
+//   byte_loss      the next `amount` received bytes are lost
+//   corruption     one bit flipped in each of the next `amount` bytes
+//   truncation     `amount` more bytes pass, then everything until the line
+//                  goes idle is lost: the frame in flight is cut short
+//   stall          available() and reads return nothing for `amount`
+//                  microseconds, the bytes arrive late
+//   write_failure  the next `amount` writes never reach the line
+//
+// Bit positions come from a seeded generator, so a schedule replays the
+// same way every time.
+
+enum class FaultClass
+{
+    byte_loss,
+    corruption,
+    truncation,
+    stall,
+    write_failure
+};
+
+const int FaultClassCount = 5;
+
+inline const char* faultClassName(FaultClass type) {
+    static const char* const names[FaultClassCount] = {"byte loss", "corruption", "truncation", "stall",
+                                                       "write failure"};
+    return names[static_cast<int>(type)];
+}
+
+struct Fault {
+    FaultClass type;
+    uint64_t atMicros;
+    uint32_t amount;
+};
+
+struct FaultStats {
+    uint32_t injected[FaultClassCount];
+    uint32_t bytesLost;
+    uint32_t bytesCorrupted;
+    uint32_t writesFailed;
+    uint32_t stalledReads;
+};
+
+class FaultInjectingHardware : public SharpAcHardwareInterface {
+public:
+    FaultInjectingHardware(SharpAcHardwareInterface* inner, uint64_t seed) : inner(inner), rng(seed) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    // Faults may be added in any order
+    void schedule(const Fault& fault) {
+        pending.push_back(fault);
+        std::stable_sort(pending.begin(), pending.end(),
+                         [](const Fault& a, const Fault& b) { return a.atMicros < b.atMicros; });
+    }
+
+    // A random schedule: count faults of the given class, spaced
+    // [minGap, maxGap] apart starting at start
+    void scheduleRandom(FaultClass type, uint32_t count, uint64_t start, uint64_t minGap, uint64_t maxGap,
+                        uint32_t amount) {
+        uint64_t at = start;
+        for (uint32_t i = 0; i < count; i++) {
+            at += minGap + rng.uniform(0, static_cast<uint32_t>(maxGap - minGap));
+            Fault fault = {type, at, amount};
+            schedule(fault);
+        }
+    }
+
+    // Time of the device clock, extended past the 32 bit wrap
+    uint64_t now() {
+        uint32_t micros = static_cast<uint32_t>(inner->get_micros());
+        micros64 += static_cast<uint32_t>(micros - lastMicros);
+        lastMicros = micros;
+        return micros64;
+    }
+
+    // No fault is pending or still affecting the line
+    bool quiet() const {
+        return pending.empty() && lose == 0 && corrupt == 0 && !truncating && truncatePass == 0 &&
+               stallUntil == 0 && failWrites == 0;
+    }
+
+    const FaultStats& getStats() const { return stats; }
+
+    size_t read_array(uint8_t* data, size_t len) override {
+        activate();
+        if (stalled()) {
+            stats.stalledReads++;
+            return 0;
+        }
+
+        size_t count = inner->read_array(data, len);
+        size_t kept = 0;
+        for (size_t i = 0; i < count; i++) {
+            uint8_t byte = data[i];
+            if (lose > 0) {
+                lose--;
+                stats.bytesLost++;
+                continue;
+            }
+            if (truncatePass > 0) {
+                truncatePass--;
+            } else if (truncating) {
+                stats.bytesLost++;
+                continue;
+            }
+            if (corrupt > 0) {
+                corrupt--;
+                byte ^= static_cast<uint8_t>(1 << rng.uniform(0, 7));
+                stats.bytesCorrupted++;
+            }
+            data[kept++] = byte;
+        }
+        return kept;
+    }
+
+    size_t available() override {
+        activate();
+        if (stalled()) return 0;
+        size_t count = inner->available();
+        // The line went idle, the truncated frame is over
+        if (count == 0 && truncatePass == 0) truncating = false;
+        return count;
+    }
+
+    void write_array(const uint8_t* data, size_t len) override {
+        activate();
+        if (failWrites > 0) {
+            failWrites--;
+            stats.writesFailed++;
+            return;
+        }
+        inner->write_array(data, len);
+    }
+
+    uint8_t peek() override { return inner->peek(); }
+
+    uint8_t read() override {
+        uint8_t value = 0;
+        return read_array(&value, 1) ? value : 0;
+    }
+
+    unsigned long get_millis() override { return inner->get_millis(); }
+    unsigned long get_micros() override { return inner->get_micros(); }
+
+    void log_debug(const char* tag, const char* format, ...) override {
+        char message[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(message, sizeof(message), format, args);
+        va_end(args);
+        inner->log_debug(tag, "%s", message);
+    }
+
+    bool log_debug_enabled() override { return inner->log_debug_enabled(); }
+
+    std::string format_hex_pretty(const uint8_t* data, size_t len) override {
+        return inner->format_hex_pretty(data, len);
+    }
+
+private:
+    SharpAcHardwareInterface* inner;
+    SimRandom rng;
+    FaultStats stats;
+    std::vector<Fault> pending;
+
+    uint32_t lastMicros = 0;
+    uint64_t micros64 = 0;
+
+    uint32_t lose = 0;
+    uint32_t corrupt = 0;
+    uint32_t truncatePass = 0;
+    bool truncating = false;
+    uint64_t stallUntil = 0;
+    uint32_t failWrites = 0;
+
+    // Starts every fault whose time has come
+    void activate() {
+        uint64_t time = now();
+        size_t due = 0;
+        while (due < pending.size() && pending[due].atMicros <= time) {
+            const Fault& fault = pending[due++];
+            stats.injected[static_cast<int>(fault.type)]++;
+            switch (fault.type) {
+                case FaultClass::byte_loss: lose += fault.amount; break;
+                case FaultClass::corruption: corrupt += fault.amount; break;
+                case FaultClass::truncation:
+                    truncatePass = fault.amount;
+                    truncating = true;
+                    break;
+                case FaultClass::stall: stallUntil = time + fault.amount; break;
+                case FaultClass::write_failure: failWrites += fault.amount; break;
+            }
+        }
+        pending.erase(pending.begin(), pending.begin() + due);
+    }
+
+    bool stalled() {
+        if (stallUntil == 0) return false;
+        if (now() < stallUntil) return true;
+        stallUntil = 0;
+        return false;
+    }
+};
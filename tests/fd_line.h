@@ -0,0 +1,191 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+#include "simulator.h"
+
+// ============================================================================
+// File Descriptor Line
+// ============================================================================
+//
+// Puts a SimPeer (usually the EmulatedAc) on a real file descriptor: the
+// master side of a pty pair or a socket. Bytes the core writes are split
+// back into frames and handed to the peer, its answers are written out
+// once their delay has passed. Time is the wall clock, so this is for
+// driving the real serial backends, not for reproducible runs.
+
+class FdLine : public SimLine {
+public:
+    FdLine(int fd, SimPeer* peer, uint64_t seed = 1) : fd(fd), peer(peer), rng(seed) {}
+
+    SimRandom& random() override { return rng; }
+
+    void send(const uint8_t* data, size_t len, uint64_t delayMicros = 0) override {
+        uint64_t start = nowMicros() + delayMicros;
+        if (start < lineFree) start = lineFree;
+        Pending pending;
+        pending.due = start;
+        pending.bytes.assign(data, data + len);
+        out.push_back(pending);
+        lineFree = start;
+    }
+
+    // Waits up to timeoutMs for bytes from the core, hands every complete
+    // frame to the peer and writes the answers that are due. False once
+    // the other side has closed.
+    bool service(int timeoutMs) {
+        if (!out.empty()) {
+            uint64_t now = nowMicros();
+            int untilDue = out.front().due > now ? static_cast<int>((out.front().due - now + 999) / 1000) : 0;
+            if (untilDue < timeoutMs) timeoutMs = untilDue;
+        }
+
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeoutMs);
+        if (ready > 0 && (pfd.revents & POLLIN)) {
+            uint8_t chunk[256];
+            ssize_t got = read(fd, chunk, sizeof(chunk));
+            if (got == 0 || (got < 0 && errno != EINTR && errno != EAGAIN)) return false;
+            if (got > 0) {
+                in.insert(in.end(), chunk, chunk + got);
+                bytesIn += static_cast<size_t>(got);
+                dispatch();
+            }
+        } else if (ready > 0 && (pfd.revents & (POLLHUP | POLLERR))) {
+            return false;
+        }
+
+        flush();
+        return true;
+    }
+
+    size_t getBytesIn() const { return bytesIn; }
+    size_t getBytesOut() const { return bytesOut; }
+
+private:
+    struct Pending {
+        uint64_t due;
+        std::vector<uint8_t> bytes;
+    };
+
+    int fd;
+    SimPeer* peer;
+    SimRandom rng;
+    std::vector<uint8_t> in;
+    std::deque<Pending> out;
+    uint64_t lineFree = 0;
+    size_t bytesIn = 0;
+    size_t bytesOut = 0;
+
+    static uint64_t nowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Length of the core frame starting at data, see core_messages.h. 0 if
+    // no frame starts with this byte, more than len if it is incomplete.
+    static size_t frameLength(const uint8_t* data, size_t len) {
+        switch (data[0]) {
+        case 0x06:
+            return 1;
+        case 0x02:
+            // init_msg has 7 bytes, init_msg2 8, both plus the checksum
+            return len < 4 ? 4 : data[3] == 0x01 ? 9 : 8;
+        case 0x03:
+            return 8;
+        case 0xdd:
+            return len < 2 ? 2 : data[1] + 3u;
+        default:
+            return 0;
+        }
+    }
+
+    void dispatch() {
+        size_t pos = 0;
+        while (pos < in.size()) {
+            size_t length = frameLength(&in[pos], in.size() - pos);
+            if (length == 0) {
+                pos++;
+                continue;
+            }
+            if (pos + length > in.size()) break;
+            peer->receive(*this, &in[pos], length);
+            pos += length;
+        }
+        in.erase(in.begin(), in.begin() + pos);
+    }
+
+    void flush() {
+        uint64_t now = nowMicros();
+        while (!out.empty() && out.front().due <= now) {
+            const std::vector<uint8_t>& bytes = out.front().bytes;
+            size_t sent = 0;
+            while (sent < bytes.size()) {
+                ssize_t n = write(fd, bytes.data() + sent, bytes.size() - sent);
+                if (n > 0) {
+                    sent += static_cast<size_t>(n);
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    break;
+                }
+            }
+            bytesOut += sent;
+            out.pop_front();
+        }
+    }
+};
+
+// Opens a pty pair: returns the master fd and puts the slave path in
+// slavePath, which SharpSerialPort opens like a serial adapter. -1 on error.
+inline int openPty(std::string& slavePath) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0) return -1;
+    const char* name = nullptr;
+    if (grantpt(master) != 0 || unlockpt(master) != 0 || (name = ptsname(master)) == nullptr) {
+        close(master);
+        return -1;
+    }
+    slavePath = name;
+    return master;
+}
+
+// Opens a listening TCP socket standing in for a network serial bridge, on
+// the loopback interface unless told otherwise. Port 0 picks a free one,
+// port has the actual port afterwards. Accepted connections go to an
+// FdLine like a pty master. -1 on error.
+inline int openListener(uint16_t& port, bool loopback = true) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(loopback ? INADDR_LOOPBACK : INADDR_ANY);
+    address.sin_port = htons(port);
+    socklen_t len = sizeof(address);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), len) != 0 || listen(fd, 64) != 0 ||
+        getsockname(fd, reinterpret_cast<struct sockaddr*>(&address), &len) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    port = ntohs(address.sin_port);
+    return fd;
+}
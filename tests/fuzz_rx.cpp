@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "core_logic.h"
+#include "core_frame.h"
+#include "core_messages.h"
+#include "core_types.h"
+#include "simulator.h"
+
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// RX Fuzz Target
+// ============================================================================
+//
+// Feeds arbitrary bytes into SharpAcCore::loop() through a byte-feeding
+// hardware mock. Built with AddressSanitizer and UBSan, see Makefile.test.
+//
+// Input layout:
+//   byte 0  bit 0     connect first, a valid handshake precedes the input
+//           bits 1-3  bytes per loop() call: 1..7, or 64 for 7
+//           bits 4-7  idle character times between chunks
+//   rest    RX bytes
+//
+// Checked for every input:
+//   - every loop() call on buffered input consumes bytes or hands out a
+//     frame, so a peer cannot make the core spin
+//   - the state only ever holds known mode, fan and swing values
+//   - nothing longer than a frame buffer is written
+//
+// With -DSHARP_LIBFUZZER the file only provides LLVMFuzzerTestOneInput for
+// libFuzzer. Otherwise main() runs a seeded mutation loop that keeps inputs
+// reaching new parser and handshake behaviour, and reports the inputs that
+// took the most time per byte.
+
+static const uint32_t CHAR_MICROS = 11 * 1000000UL / 9600;
+static const size_t MAX_INPUT = 512;
+
+// The input being run, printed when it fails
+static const uint8_t* currentInput;
+static size_t currentSize;
+
+static void fail(const char* what) {
+    fprintf(stderr, "fuzz_rx: %s\ninput:", what);
+    for (size_t i = 0; i < currentSize; i++) fprintf(stderr, " %02x", currentInput[i]);
+    fprintf(stderr, "\n");
+    abort();
+}
+
+class FuzzHardware : public SharpAcHardwareInterface {
+public:
+    std::vector<uint8_t> rx;
+    size_t readPos = 0;
+    uint32_t micros = 1000000;
+    uint32_t txFrames = 0;
+
+    void feed(const uint8_t* data, size_t len) {
+        rx.insert(rx.end(), data, data + len);
+    }
+
+    void advance(uint32_t us) { micros += us; }
+
+    size_t read_array(uint8_t* data, size_t len) override {
+        size_t count = std::min(len, rx.size() - readPos);
+        memcpy(data, rx.data() + readPos, count);
+        readPos += count;
+        return count;
+    }
+
+    size_t available() override { return rx.size() - readPos; }
+
+    void write_array(const uint8_t* data, size_t len) override {
+        (void)data;
+        if (len == 0 || len > SHARP_MAX_FRAME_SIZE) fail("frame of impossible length written");
+        txFrames++;
+    }
+
+    uint8_t peek() override { return readPos < rx.size() ? rx[readPos] : 0; }
+
+    uint8_t read() override { return readPos < rx.size() ? rx[readPos++] : 0; }
+
+    unsigned long get_millis() override { return micros / 1000; }
+    unsigned long get_micros() override { return micros; }
+
+    // Formatting is part of the RX path, the message is built and dropped
+    void log_debug(const char* tag, const char* format, ...) override {
+        (void)tag;
+        char message[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(message, sizeof(message), format, args);
+        va_end(args);
+    }
+
+    std::string format_hex_pretty(const uint8_t* data, size_t len) override {
+        std::string result;
+        for (size_t i = 0; i < len; i++) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), i ? ".%02X" : "%02X", data[i]);
+            result += buf;
+        }
+        return result;
+    }
+};
+
+class FuzzCallback : public SharpAcStateCallback {
+public:
+    int status = 0;
+    uint32_t updates = 0;
+
+    void on_state_update() override { updates++; }
+    void on_ion_state_update(bool) override {}
+    void on_vane_horizontal_update(SwingHorizontal val) override {
+        if (!isKnown(val)) fail("unknown horizontal vane position published");
+    }
+    void on_vane_vertical_update(SwingVertical val) override {
+        if (!isKnown(val)) fail("unknown vertical vane position published");
+    }
+    void on_connection_status_update(int status) override { this->status = status; }
+};
+
+// What the AC answers during the handshake. Only the 0xdc frames need their
+// checksum, the others get one as well like in the emulator.
+static std::vector<std::vector<uint8_t>> handshakeReplies() {
+    const uint8_t handshake[8] = {0x02, 0xff, 0xff, 0x01, 0x01, 0x00, 0x00, 0x00};
+    const uint8_t subscribe[8] = {0x03, 0xff, 0xa0, 0x01, 0x00, 0x00, 0x00, 0x00};
+    const uint8_t mode[14] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80};
+    const uint8_t status[18] = {0xdc, 0x0f, 0xfd, 0x00, 0x00, 0x00, 0x00, 22};
+    const uint8_t* frames[] = {handshake, handshake, ACK, subscribe, subscribe, mode, status, ACK};
+    const size_t sizes[] = {8, 8, 1, 8, 8, 14, 18, 1};
+
+    std::vector<std::vector<uint8_t>> replies;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        SharpFrame frame(frames[i], sizes[i]);
+        if (sizes[i] > 1) frame.setChecksum();
+        replies.push_back(std::vector<uint8_t>(frame.getData(), frame.getData() + frame.getSize()));
+    }
+    return replies;
+}
+
+struct FuzzResult {
+    size_t bytes;
+    double nanos;
+    uint32_t feature;
+};
+
+static uint32_t mix(uint32_t hash, uint32_t value) {
+    return (hash ^ value) * 16777619u;
+}
+
+static uint64_t progress(const FuzzHardware& hw, const SharpAcCore& core) {
+    const SharpRxStats& stats = core.getRxStats();
+    uint64_t total = hw.readPos + stats.droppedBytes;
+    for (int i = 0; i < SharpFrameTypeCount; i++) total += stats.frames[i] + stats.checksumErrors[i];
+    return total;
+}
+
+// One input, start to finish, on a fresh core
+static FuzzResult runInput(const uint8_t* data, size_t size) {
+    static const std::vector<std::vector<uint8_t>> replies = handshakeReplies();
+
+    FuzzResult result = {0, 0.0, 2166136261u};
+    if (size == 0) return result;
+    currentInput = data;
+    currentSize = size;
+
+    FuzzHardware hw;
+    FuzzCallback callback;
+    SharpAcCore core(&hw, &callback);
+    core.setTraceSize(256);
+    core.setup();
+
+    uint8_t flags = data[0];
+    size_t chunk = ((flags >> 1) & 0x07) + 1;
+    if (chunk == 8) chunk = SHARP_MAX_FRAME_SIZE;
+    uint32_t gap = (flags >> 4) * CHAR_MICROS;
+    data++;
+    size--;
+
+    if (flags & 0x01) {
+        core.loop();
+        for (size_t i = 0; i < replies.size(); i++) {
+            hw.advance(5000);
+            hw.feed(replies[i].data(), replies[i].size());
+            for (int n = 0; n < 4; n++) {
+                hw.advance(2000);
+                core.loop();
+            }
+        }
+        if (callback.status != 8) fail("handshake did not complete");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t pos = 0; pos < size; pos += chunk) {
+        size_t len = std::min(chunk, size - pos);
+        hw.feed(data + pos, len);
+        hw.advance(static_cast<uint32_t>(len) * CHAR_MICROS + gap);
+        core.loop();
+    }
+
+    // Every loop() has to take bytes off the line or hand out a frame the
+    // parser already holds
+    while (hw.available() > 0) {
+        uint64_t before = progress(hw, core);
+        hw.advance(CHAR_MICROS);
+        core.loop();
+        if (progress(hw, core) == before) fail("loop() made no progress on buffered bytes");
+    }
+    // Let a frame cut short by the end of input time out
+    hw.advance(16 * CHAR_MICROS);
+    core.loop();
+    auto end = std::chrono::steady_clock::now();
+
+    const SharpState& state = core.getState();
+    if (!isKnown(state.mode) || !isKnown(state.fan) || !isKnown(state.swingH) || !isKnown(state.swingV))
+        fail("unknown value reached the state");
+    if (state.temperature < 16 || state.temperature > 31) fail("target temperature out of range");
+
+    // Behaviour signature: which frame types were seen, which failed,
+    // how far the handshake got
+    const SharpRxStats& stats = core.getRxStats();
+    uint32_t feature = result.feature;
+    for (int i = 0; i < SharpFrameTypeCount; i++) {
+        feature = mix(feature, stats.frames[i] > 0);
+        feature = mix(feature, stats.checksumErrors[i] > 0);
+        feature = mix(feature, stats.truncated[i] > 0);
+    }
+    feature = mix(feature, static_cast<uint32_t>(callback.status));
+    feature = mix(feature, stats.resyncs > 0 ? 1 + (stats.resyncs > 8) : 0);
+    feature = mix(feature, callback.updates > 0);
+    feature = mix(feature, std::min<uint32_t>(hw.txFrames, 4));
+
+    result.bytes = size;
+    result.nanos = std::chrono::duration<double, std::nano>(end - start).count();
+    result.feature = feature;
+    return result;
+}
+
+#ifdef SHARP_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size <= 1 + MAX_INPUT) runInput(data, size);
+    return 0;
+}
+
+#else
+
+typedef std::vector<uint8_t> Input;
+
+struct SlowInput {
+    double nsPerByte;
+    Input input;
+};
+
+static Input seedInput(uint8_t flags, const std::vector<uint8_t>& bytes) {
+    Input input(1, flags);
+    input.insert(input.end(), bytes.begin(), bytes.end());
+    return input;
+}
+
+// Valid traffic plus the patterns that make the parser work hardest
+static std::vector<Input> seedCorpus() {
+    std::vector<Input> corpus;
+    std::vector<uint8_t> all;
+    std::vector<std::vector<uint8_t>> replies = handshakeReplies();
+    for (size_t i = 0; i < replies.size(); i++) {
+        corpus.push_back(seedInput(0x0e, replies[i]));
+        all.insert(all.end(), replies[i].begin(), replies[i].end());
+    }
+    corpus.push_back(seedInput(0x0e, all));
+    corpus.push_back(seedInput(0x02, all));
+    corpus.push_back(seedInput(0x0f, replies[5]));
+    corpus.push_back(seedInput(0x0f, replies[6]));
+
+    // Header runs: every byte starts a frame that fails its checksum
+    corpus.push_back(seedInput(0x0f, std::vector<uint8_t>(256, 0xdc)));
+    corpus.push_back(seedInput(0x01, std::vector<uint8_t>(256, 0x03)));
+    // Length byte pointing far past the frame buffer
+    std::vector<uint8_t> longHandshake = {0x02, 0xff, 0xff, 0x01, 0x01, 0x00, 0xff, 0x00};
+    corpus.push_back(seedInput(0x0e, longHandshake));
+    corpus.push_back(seedInput(0x0f, std::vector<uint8_t>(64, 0x00)));
+    return corpus;
+}
+
+static void mutate(Input& input, const std::vector<Input>& corpus, SimRandom& rng) {
+    static const uint8_t interesting[] = {0x00, 0x02, 0x03, 0x06, 0x0b, 0x0f, 0xdc, 0xdd, 0xfc, 0xfd, 0xfe, 0xff};
+    uint32_t count = rng.uniform(1, 4);
+    for (uint32_t m = 0; m < count; m++) {
+        size_t size = input.size();
+        uint32_t pos = size > 1 ? rng.uniform(1, static_cast<uint32_t>(size - 1)) : 1;
+        switch (rng.uniform(0, 6)) {
+            case 0:
+                if (pos < size) input[pos] ^= static_cast<uint8_t>(1 << rng.uniform(0, 7));
+                break;
+            case 1:
+                if (pos < size) input[pos] = static_cast<uint8_t>(rng.uniform(0, 255));
+                break;
+            case 2:
+                if (pos < size) input[pos] = interesting[rng.uniform(0, sizeof(interesting) - 1)];
+                break;
+            case 3:
+                input.insert(input.begin() + std::min<size_t>(pos, size),
+                             interesting[rng.uniform(0, sizeof(interesting) - 1)]);
+                break;
+            case 4:
+                if (pos < size) input.erase(input.begin() + pos);
+                break;
+            case 5: {
+                // Splice in a slice of another input
+                const Input& other = corpus[rng.uniform(0, static_cast<uint32_t>(corpus.size() - 1))];
+                if (other.size() < 2) break;
+                uint32_t from = rng.uniform(1, static_cast<uint32_t>(other.size() - 1));
+                uint32_t len = rng.uniform(1, static_cast<uint32_t>(other.size() - from));
+                input.insert(input.begin() + std::min<size_t>(pos, size), other.begin() + from,
+                             other.begin() + from + len);
+                break;
+            }
+            case 6:
+                input[0] = static_cast<uint8_t>(rng.uniform(0, 255));
+                break;
+        }
+    }
+    if (input.empty()) input.push_back(0);
+    if (input.size() > 1 + MAX_INPUT) input.resize(1 + MAX_INPUT);
+}
+
+static bool readFile(const char* path, Input& input) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    uint8_t buffer[4096];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0) input.insert(input.end(), buffer, buffer + len);
+    fclose(file);
+    return true;
+}
+
+static void printHex(const Input& input) {
+    for (size_t i = 0; i < input.size() && i < 48; i++) printf("%s%02x", i ? " " : "", input[i]);
+    if (input.size() > 48) printf(" ... (%zu bytes)", input.size());
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    uint64_t iterations = 200000;
+    uint64_t seed = 1;
+    double maxNsPerByte = 0;
+    std::vector<const char*> files;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-ns-per-byte") == 0 && i + 1 < argc) {
+            maxNsPerByte = atof(argv[++i]);
+        } else if (argv[i][0] >= '0' && argv[i][0] <= '9' && positional < 2) {
+            if (positional++ == 0) iterations = strtoull(argv[i], nullptr, 10);
+            else seed = strtoull(argv[i], nullptr, 10);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    // Reproduce: run the given inputs once each
+    if (!files.empty()) {
+        for (size_t i = 0; i < files.size(); i++) {
+            Input input;
+            if (!readFile(files[i], input)) {
+                fprintf(stderr, "Cannot read %s\n", files[i]);
+                return 1;
+            }
+            FuzzResult result = runInput(input.data(), input.size());
+            printf("%s: %zu bytes, %.1f ns/byte\n", files[i], result.bytes,
+                   result.bytes ? result.nanos / result.bytes : 0.0);
+        }
+        return 0;
+    }
+
+    printf("\n╔════════════════════════════════════════════════════════════╗\n");
+    printf("║          Sharp AC RX Fuzzer                                ║\n");
+    printf("╚════════════════════════════════════════════════════════════╝\n");
+    printf("  %llu inputs, seed %llu\n", (unsigned long long)iterations, (unsigned long long)seed);
+
+    SimRandom rng(seed);
+    std::vector<Input> corpus = seedCorpus();
+    std::set<uint32_t> features;
+    for (size_t i = 0; i < corpus.size(); i++) features.insert(runInput(corpus[i].data(), corpus[i].size()).feature);
+
+    const size_t slowestKept = 5;
+    std::vector<SlowInput> slowest;
+    uint64_t totalBytes = 0;
+    double totalNanos = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t n = 0; n < iterations; n++) {
+        Input input = corpus[rng.uniform(0, static_cast<uint32_t>(corpus.size() - 1))];
+        mutate(input, corpus, rng);
+        FuzzResult result = runInput(input.data(), input.size());
+        totalBytes += result.bytes;
+        totalNanos += result.nanos;
+
+        if (features.insert(result.feature).second && corpus.size() < 4096) corpus.push_back(input);
+
+        // Short inputs are all fixed cost, per byte figures need some length
+        if (result.bytes >= 32) {
+            double nsPerByte = result.nanos / result.bytes;
+            // A candidate is timed again, the fastest run filters out
+            // preemption and page faults
+            for (int retry = 0; retry < 3 && (slowest.size() < slowestKept || nsPerByte > slowest.back().nsPerByte);
+                 retry++) {
+                FuzzResult again = runInput(input.data(), input.size());
+                nsPerByte = std::min(nsPerByte, again.nanos / again.bytes);
+            }
+            if (slowest.size() < slowestKept || nsPerByte > slowest.back().nsPerByte) {
+                SlowInput slow = {nsPerByte, input};
+                slowest.push_back(slow);
+                std::sort(slowest.begin(), slowest.end(),
+                          [](const SlowInput& a, const SlowInput& b) { return a.nsPerByte > b.nsPerByte; });
+                if (slowest.size() > slowestKept) slowest.pop_back();
+            }
+        }
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("\n  %.0f inputs/s, %zu behaviours, corpus %zu\n", iterations / wall, features.size(), corpus.size());
+    printf("  %.1f ns/byte average\n", totalBytes ? totalNanos / totalBytes : 0.0);
+    printf("\n  Slowest inputs (ns/byte):\n");
+    for (size_t i = 0; i < slowest.size(); i++) {
+        printf("  %10.1f  ", slowest[i].nsPerByte);
+        printHex(slowest[i].input);
+    }
+
+    if (maxNsPerByte > 0 && !slowest.empty() && slowest[0].nsPerByte > maxNsPerByte) {
+        printf("\n✗ Worst case %.1f ns/byte exceeds %.1f\n", slowest[0].nsPerByte, maxNsPerByte);
+        return 1;
+    }
+    printf("\n✓ No crash, sanitizer report or invariant violation\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <termios.h>
+
+#include "emulated_ac.h"
+#include "fd_line.h"
+
+// ============================================================================
+// Emulated AC On A Pty
+// ============================================================================
+//
+// Runs the EmulatedAc on the master side of a pty pair and prints the
+// slave path, which goes into `serial_port:` of a host platform build (or
+// any other program that opens a serial device). Runs until interrupted.
+//
+//   ./pty_ac [--delay-us N] [--drop P] [--flip P] [--link PATH]
+//   ./pty_ac [--delay-us N] [--drop P] [--flip P] --listen PORT
+//
+// With --listen it stands in for a network serial bridge in raw mode
+// instead, e.g. for `sharp_gateway tcp://localhost:PORT`: one connection
+// at a time, the AC keeps its state across connections.
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) { running = 0; }
+
+static const char* USAGE = "usage: %s [--delay-us N] [--drop P] [--flip P] [--link PATH | --listen PORT]\n";
+
+static void reportConnected(EmulatedAc& ac, bool& connected) {
+    if (ac.isConnected() != connected) {
+        connected = ac.isConnected();
+        fprintf(stderr, connected ? "connected\n" : "handshake restarted\n");
+    }
+}
+
+static void printStats(EmulatedAc& ac) {
+    const EmulatedAcStats& stats = ac.getStats();
+    fprintf(stderr, "%u handshakes, %u requests, %u commands, %u corrupted frames\n", stats.handshakes,
+            stats.requests, stats.commands, stats.corrupted);
+}
+
+static int serveTcp(EmulatedAc& ac, uint16_t port) {
+    int listener = openListener(port, false);
+    if (listener < 0) {
+        perror("listen");
+        return 1;
+    }
+    printf("tcp://localhost:%u\n", port);
+    fflush(stdout);
+
+    bool connected = false;
+    while (running) {
+        struct pollfd pfd = {listener, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) continue;
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        fprintf(stderr, "client connected\n");
+        FdLine line(client, &ac);
+        while (running && line.service(100)) reportConnected(ac, connected);
+        fprintf(stderr, "client gone\n");
+        close(client);
+    }
+    close(listener);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    EmulatedAc ac;
+    const char* link = nullptr;
+    int listenPort = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--delay-us") == 0 && i + 1 < argc) {
+            ac.faults.delayMicros = static_cast<uint32_t>(atol(argv[++i]));
+        } else if (strcmp(argv[i], "--drop") == 0 && i + 1 < argc) {
+            ac.faults.byteDrop = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--flip") == 0 && i + 1 < argc) {
+            ac.faults.bitFlip = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--link") == 0 && i + 1 < argc) {
+            link = argv[++i];
+        } else if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+            listenPort = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, USAGE, argv[0]);
+            return 2;
+        }
+    }
+    if (listenPort > 65535 || (listenPort >= 0 && link != nullptr)) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    // A client that goes away mid-answer is not a reason to stop
+    signal(SIGPIPE, SIG_IGN);
+
+    if (listenPort >= 0) {
+        int result = serveTcp(ac, static_cast<uint16_t>(listenPort));
+        printStats(ac);
+        return result;
+    }
+
+    std::string slave;
+    int master = openPty(slave);
+    if (master < 0) {
+        perror("pty");
+        return 1;
+    }
+    // Until the other side opens the slave with its own settings
+    struct termios tio;
+    if (tcgetattr(master, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(master, TCSANOW, &tio);
+    }
+
+    if (link != nullptr) {
+        unlink(link);
+        if (symlink(slave.c_str(), link) != 0) {
+            perror(link);
+            return 1;
+        }
+    }
+
+    printf("%s\n", link != nullptr ? link : slave.c_str());
+    fflush(stdout);
+
+    FdLine line(master, &ac);
+    bool connected = false;
+    while (running) {
+        // The master reads EIO while nobody has the slave open
+        if (!line.service(100)) usleep(100000);
+        reportConnected(ac, connected);
+    }
+
+    printStats(ac);
+    if (link != nullptr) unlink(link);
+    close(master);
+    return 0;
+}
@@ -72,33 +72,121 @@ step "Running frame parsing tests..."
 echo ""
 if ./test_frame_parsing; then
     success "Frame parsing tests passed"
-    ((PASSED_TESTS++))
+    PASSED_TESTS=$((PASSED_TESTS + 1))
 else
     error "Frame parsing tests failed"
 fi
-((TOTAL_TESTS++))
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
 
 # Run Core Logic Tests
 step "Running core logic tests..."
 echo ""
 if ./test_core_logic; then
     success "Core logic tests passed"
-    ((PASSED_TESTS++))
+    PASSED_TESTS=$((PASSED_TESTS + 1))
 else
     error "Core logic tests failed"
 fi
-((TOTAL_TESTS++))
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
 
 # Run Integration Tests
 step "Running integration tests..."
 echo ""
 if ./test_integration; then
     success "Integration tests passed"
-    ((PASSED_TESTS++))
+    PASSED_TESTS=$((PASSED_TESTS + 1))
 else
     error "Integration tests failed"
 fi
-((TOTAL_TESTS++))
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+
+# Run Allocation Tests
+step "Running allocation tests..."
+echo ""
+if ./test_allocations; then
+    success "Allocation tests passed"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    error "Allocation tests failed"
+fi
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+
+# Run Simulation Tests
+step "Running simulation tests..."
+echo ""
+if ./test_simulation; then
+    success "Simulation tests passed"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    error "Simulation tests failed"
+fi
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+
+# Run Round Trip Tests
+step "Running round trip tests..."
+echo ""
+if ./test_round_trip; then
+    success "Round trip tests passed"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    error "Round trip tests failed"
+fi
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+
+# Run Component Tests
+step "Running component tests..."
+echo ""
+if ./test_component; then
+    success "Component tests passed"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    error "Component tests failed"
+fi
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+
+# Run Host Serial Tests
+step "Running host serial tests..."
+echo ""
+if ./test_host_serial; then
+    success "Host serial tests passed"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    error "Host serial tests failed"
+fi
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+
+# Run Gateway Tests
+step "Running gateway tests..."
+echo ""
+if ./test_gateway; then
+    success "Gateway tests passed"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    error "Gateway tests failed"
+fi
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+
+# Run TCP Bridge Tests
+step "Running TCP bridge tests..."
+echo ""
+if ./test_tcp_link; then
+    success "TCP bridge tests passed"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    error "TCP bridge tests failed"
+fi
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+
+# Run Coroutine Session Tests
+step "Running coroutine session tests..."
+echo ""
+if ./test_coro_session; then
+    success "Coroutine session tests passed"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    error "Coroutine session tests failed"
+fi
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
 
 # Summary
 echo -e "\n${BLUE}"
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "core_logic.h"
+
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Discrete-Event Simulation
+// ============================================================================
+//
+// The Simulator owns the clock and both directions of the UART. It is the
+// hardware interface and state callback of the SharpAcCore under test and
+// hands every frame the core writes to a SimPeer standing in for the AC
+// (see emulated_ac.h).
+// Bytes travel at the configured baud rate, loop() runs at the ESPHome loop
+// interval and idle time is skipped using SharpAcCore::millisUntilDue(), so
+// days of protocol time run in milliseconds. All randomness comes from one
+// seeded generator: the same seed gives the same run.
+
+// xorshift64*, identical sequence on every platform
+class SimRandom {
+public:
+    explicit SimRandom(uint64_t seed) : state(seed ? seed : 0x9e3779b97f4a7c15ULL) {}
+
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<uint32_t>((state * 0x2545f4914f6cdd1dULL) >> 32);
+    }
+
+    // Uniform in [lo, hi]
+    uint32_t uniform(uint32_t lo, uint32_t hi) {
+        if (hi <= lo) return lo;
+        return lo + next() % (hi - lo + 1);
+    }
+
+    // True with probability p
+    bool chance(double p) {
+        return p > 0.0 && next() < p * 4294967296.0;
+    }
+
+private:
+    uint64_t state;
+};
+
+struct SimLatency {
+    uint64_t count;
+    uint64_t totalMicros;
+    uint64_t minMicros;
+    uint64_t maxMicros;
+
+    void add(uint64_t micros) {
+        if (count == 0 || micros < minMicros) minMicros = micros;
+        if (micros > maxMicros) maxMicros = micros;
+        totalMicros += micros;
+        count++;
+    }
+
+    uint64_t averageMicros() const { return count ? totalMicros / count : 0; }
+};
+
+struct SimStats {
+    uint64_t loops;
+    uint64_t txFrames;
+    uint64_t txBytes;
+    uint64_t rxFrames;
+    uint64_t rxBytes;
+    // Frames the peer put on the line
+    uint64_t peerFrames;
+    uint64_t polls;
+    // Time between consecutive status polls
+    SimLatency pollInterval;
+    uint64_t connects;
+    uint64_t reconnects;
+    // Request fully sent until loop() has read the first frame back
+    SimLatency responseLatency;
+    // Status 0 until status 8
+    SimLatency connectTime;
+};
+
+// The AC end of a line. The Simulator is one, fd_line.h puts a peer on a
+// real file descriptor instead.
+class SimLine {
+public:
+    virtual ~SimLine() {}
+    virtual SimRandom& random() = 0;
+    // Bytes from the AC, starting delayMicros from now
+    virtual void send(const uint8_t* data, size_t len, uint64_t delayMicros = 0) = 0;
+};
+
+class SimPeer {
+public:
+    virtual ~SimPeer() {}
+    // A frame written by the core has fully arrived at the peer
+    virtual void receive(SimLine& line, const uint8_t* data, size_t len) = 0;
+};
+
+class Simulator : public SharpAcHardwareInterface, public SharpAcStateCallback, public SimLine {
+public:
+    explicit Simulator(uint64_t seed, uint32_t baud = 9600, uint8_t bitsPerChar = 11)
+        : rng(seed), charMicros(bitsPerChar * 1000000UL / baud) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    void attach(SharpAcCore* core, SimPeer* peer) {
+        this->core = core;
+        this->peer = peer;
+    }
+
+    // ESPHome runs loop() about every 16ms
+    void setLoopInterval(uint32_t micros) { loopInterval = micros; }
+
+    // Start the device clocks somewhere else than 0, e.g. just before
+    // millis() wraps at 2^32
+    void setClockOffset(uint64_t millis) { clockOffset = millis * 1000; }
+
+    uint64_t now() const { return clock; }
+    uint32_t getCharMicros() const { return charMicros; }
+    SimRandom& random() override { return rng; }
+    const SimStats& getStats() const { return stats; }
+    int getStatus() const { return status; }
+    // When the last status poll was written
+    uint64_t getLastPoll() const { return lastPoll; }
+
+    // Bytes from the AC, starting delayMicros from now once its TX line is free
+    void send(const uint8_t* data, size_t len, uint64_t delayMicros = 0) override {
+        uint64_t start = clock + delayMicros;
+        if (start < acLineFree) start = acLineFree;
+        for (size_t i = 0; i < len; i++) {
+            RxByte byte = {start + (i + 1) * charMicros, data[i]};
+            rx.push_back(byte);
+        }
+        acLineFree = start + len * charMicros;
+        if (len > 0) stats.peerFrames++;
+    }
+
+    void run(uint64_t micros) {
+        uint64_t end = clock + micros;
+        while (clock < end) {
+            deliver();
+            core->loop();
+            stats.loops++;
+            observe();
+            clock = nextWake(end);
+        }
+    }
+
+    // Runs until the core reports status 8, false if it did not within micros
+    bool runUntilConnected(uint64_t micros) {
+        uint64_t end = clock + micros;
+        while (status != 8 && clock < end) {
+            run(loopInterval);
+        }
+        return status == 8;
+    }
+
+    // SharpAcHardwareInterface
+    size_t read_array(uint8_t* data, size_t len) override {
+        size_t count = 0;
+        while (count < len && !rx.empty() && rx.front().time <= clock) {
+            data[count++] = rx.front().value;
+            rx.pop_front();
+        }
+        stats.rxBytes += count;
+        return count;
+    }
+
+    size_t available() override {
+        size_t count = 0;
+        for (size_t i = 0; i < rx.size() && rx[i].time <= clock; i++) count++;
+        return count;
+    }
+
+    void write_array(const uint8_t* data, size_t len) override {
+        uint64_t start = clock > coreLineFree ? clock : coreLineFree;
+        coreLineFree = start + len * charMicros;
+
+        Delivery delivery;
+        delivery.time = coreLineFree;
+        delivery.frame.assign(data, data + len);
+        deliveries.push_back(delivery);
+
+        stats.txFrames++;
+        stats.txBytes += len;
+        if (len >= 3 && data[0] == 0xdd && data[2] == 0xfd && status == 8) {
+            if (stats.polls > 0) stats.pollInterval.add(clock - lastPoll);
+            stats.polls++;
+            lastPoll = clock;
+        }
+        if (!(len == 1 && data[0] == 0x06)) {
+            requestSent = coreLineFree;
+            awaitingFirstFrame = true;
+        }
+    }
+
+    uint8_t peek() override {
+        return available() ? rx.front().value : 0;
+    }
+
+    uint8_t read() override {
+        uint8_t value = 0;
+        read_array(&value, 1);
+        return value;
+    }
+
+    // Both wrap at 32 bits like on the ESP
+    unsigned long get_millis() override {
+        return static_cast<uint32_t>((clock + clockOffset) / 1000);
+    }
+
+    unsigned long get_micros() override {
+        return static_cast<uint32_t>(clock + clockOffset);
+    }
+
+    void log_debug(const char* tag, const char* format, ...) override {
+        #ifdef VERBOSE_TESTS
+        va_list args;
+        va_start(args, format);
+        printf("%10.3f [%s] ", clock / 1000.0, tag);
+        vprintf(format, args);
+        printf("\n");
+        va_end(args);
+        #else
+        (void)tag;
+        (void)format;
+        #endif
+    }
+
+    std::string format_hex_pretty(const uint8_t* data, size_t len) override {
+        SharpFrame frame(data, len);
+        char hex[SHARP_HEX_BUFFER_SIZE];
+        frame.formatHex(hex, sizeof(hex));
+        return hex;
+    }
+
+    // SharpAcStateCallback
+    void on_state_update() override {}
+    void on_ion_state_update(bool state) override { (void)state; }
+    void on_vane_horizontal_update(SwingHorizontal val) override { (void)val; }
+    void on_vane_vertical_update(SwingVertical val) override { (void)val; }
+
+    void on_connection_status_update(int status) override {
+        // Every reset after a timeout reports status 0
+        if (status == 0) {
+            stats.reconnects++;
+            connectStart = clock;
+        }
+        if (status == 8) {
+            stats.connects++;
+            stats.connectTime.add(clock - connectStart);
+        }
+        this->status = status;
+    }
+
+private:
+    struct RxByte {
+        uint64_t time;
+        uint8_t value;
+    };
+
+    struct Delivery {
+        uint64_t time;
+        std::vector<uint8_t> frame;
+    };
+
+    SimRandom rng;
+    SimStats stats;
+    SharpAcCore* core = nullptr;
+    SimPeer* peer = nullptr;
+
+    uint64_t clock = 0;
+    uint64_t clockOffset = 0;
+    uint32_t charMicros;
+    uint32_t loopInterval = 16000;
+
+    std::deque<RxByte> rx;
+    std::deque<Delivery> deliveries;
+    uint64_t acLineFree = 0;
+    uint64_t coreLineFree = 0;
+
+    int status = 0;
+    uint64_t connectStart = 0;
+    uint64_t requestSent = 0;
+    uint64_t lastPoll = 0;
+    bool awaitingFirstFrame = false;
+    uint64_t rxFramesSeen = 0;
+
+    void deliver() {
+        while (!deliveries.empty() && deliveries.front().time <= clock) {
+            Delivery delivery = deliveries.front();
+            deliveries.pop_front();
+            if (peer) {
+                peer->receive(*this, delivery.frame.data(), delivery.frame.size());
+            }
+        }
+    }
+
+    void observe() {
+        const SharpRxStats& rxStats = core->getRxStats();
+        uint64_t frames = 0;
+        for (int i = 0; i < SharpFrameTypeCount; i++) frames += rxStats.frames[i];
+
+        if (frames != rxFramesSeen && awaitingFirstFrame && clock >= requestSent) {
+            stats.responseLatency.add(clock - requestSent);
+            awaitingFirstFrame = false;
+        }
+        stats.rxFrames += frames - rxFramesSeen;
+        rxFramesSeen = frames;
+    }
+
+    // Next loop() call: one loop interval away while there is work, otherwise
+    // skip ahead to whatever happens first. On the device loop() keeps
+    // running while millis()/micros() wrap, so a skip never jumps a wrap.
+    uint64_t nextWake(uint64_t end) {
+        uint64_t next = clock + loopInterval;
+        uint32_t due = core->millisUntilDue();
+
+        if (due > 0) {
+            uint64_t wake = clock + static_cast<uint64_t>(due) * 1000;
+            uint64_t device = clock + clockOffset;
+            uint64_t microsWrap = ((device >> 32) + 1) << 32;
+            if (microsWrap - clockOffset < wake) wake = microsWrap - clockOffset;
+            uint64_t millisWrap = (device / 1000 / (1ULL << 32) + 1) * (1ULL << 32) * 1000;
+            if (millisWrap - clockOffset < wake) wake = millisWrap - clockOffset;
+            if (!rx.empty() && rx.front().time < wake) wake = rx.front().time;
+            if (!deliveries.empty() && deliveries.front().time < wake) wake = deliveries.front().time;
+            if (wake > next) next = wake;
+        }
+        return next < end ? next : end;
+    }
+};
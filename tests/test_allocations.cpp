@@ -0,0 +1,247 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+#include "core_logic.h"
+#include "core_frame.h"
+#include "core_types.h"
+#include "test_hardware.h"
+#include "alloc_hook.h"
+
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Scripted AC
+// ============================================================================
+
+// Answers every frame the core writes the way the AC does on CN13, so the
+// core can be driven through the handshake and normal traffic without a
+// test script allocating on its behalf
+class ScriptedAcHardware : public TestHardwareInterface {
+public:
+    ScriptedAcHardware() {
+        capture_frames = false;
+        build(handshake_reply, sizeof(handshake_reply));
+        build(subscribe_reply, sizeof(subscribe_reply));
+        build(status_frame, sizeof(status_frame));
+    }
+
+    void write_array(const uint8_t *data, size_t len) override {
+        TestHardwareInterface::write_array(data, len);
+        if (len < 3) {
+            return;
+        }
+
+        if (data[0] == 0x02) {
+            reply(handshake_reply, sizeof(handshake_reply));
+        } else if (data[0] == 0x03 && data[1] == 0xff) {
+            reply(&ack, 1);
+            reply(subscribe_reply, sizeof(subscribe_reply));
+        } else if (data[0] == 0x03 && data[1] == 0xfe) {
+            reply(subscribe_reply, sizeof(subscribe_reply));
+        } else if (data[0] == 0x03) {
+            reply(&ack, 1);
+        } else if (data[0] == 0xdd && data[2] == 0xfc) {
+            reply(mode_frame, sizeof(mode_frame));
+        } else if (data[0] == 0xdd && data[2] == 0xfd) {
+            reply(status_frame, sizeof(status_frame));
+        } else if (data[0] == 0xdd && data[2] == 0xfb) {
+            reply(&ack, 1);
+            reply(mode_frame, sizeof(mode_frame));
+        }
+    }
+
+    void reply(const uint8_t *data, size_t len) {
+        inject_rx_data(data, len);
+    }
+
+    static const uint8_t ack = 0x06;
+    uint8_t handshake_reply[8] = {0x02, 0xff, 0xff, 0x01, 0x01, 0x00, 0x00, 0x00};
+    uint8_t subscribe_reply[8] = {0x03, 0xff, 0xa0, 0x01, 0x00, 0x00, 0x00, 0x00};
+    uint8_t mode_frame[14] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0xb2};
+    uint8_t status_frame[18] = {0xdc, 0x0f, 0xfd, 0x00, 0x00, 0x00, 0x00, 0x17};
+
+private:
+    static void build(uint8_t *data, size_t len) {
+        SharpFrame frame(data, len);
+        frame.setChecksum();
+        data[len - 1] = frame.getData()[len - 1];
+    }
+};
+
+const uint8_t ScriptedAcHardware::ack;
+
+class AllocationTestCore : public SharpAcCore {
+public:
+    AllocationTestCore(SharpAcHardwareInterface* hardware, SharpAcStateCallback* callback)
+        : SharpAcCore(hardware, callback) {}
+
+    int getStatus() const { return status; }
+};
+
+// Runs loop() until the AC and the core have nothing left to say
+static void run_until_idle(ScriptedAcHardware& hw, SharpAcCore& core) {
+    for (int i = 0; i < 64; i++) {
+        hw.advance_time(5);
+        core.loop();
+    }
+    // Keep the mock buffers bounded, clear() keeps their capacity
+    if (hw.available() == 0) {
+        hw.reset();
+    }
+}
+
+static void handshake(ScriptedAcHardware& hw, AllocationTestCore& core) {
+    core.resetConnection();
+    run_until_idle(hw, core);
+}
+
+// ============================================================================
+// Allocation Report
+// ============================================================================
+
+struct ScenarioReport {
+    const char* name;
+    unsigned long iterations;
+    unsigned long allocations;
+    unsigned long bytes;
+};
+
+static void print_report(const ScenarioReport* reports, size_t count) {
+    std::cout << "\n  Scenario                      Iterations   Allocations        Bytes" << std::endl;
+    for (size_t i = 0; i < count; i++) {
+        printf("  %-28s %11lu %13lu %12lu\n", reports[i].name, reports[i].iterations,
+               reports[i].allocations, reports[i].bytes);
+    }
+}
+
+// ============================================================================
+// Allocation Tests
+// ============================================================================
+
+/**
+ * Test: Zero Allocations In Steady State
+ * Drives the core through the handshake, then through thousands of poll,
+ * unsolicited mode and command cycles and requires that none of them
+ * touches the heap
+ */
+bool test_steady_state_allocations() {
+    std::cout << "\n=== Test: Zero Allocations In Steady State ===" << std::endl;
+
+    const unsigned long iterations = 5000;
+
+    ScriptedAcHardware hw;
+    TestStateCallback cb;
+    AllocationTestCore core(&hw, &cb);
+    core.setup();
+    // The trace buffer is allocated once here, recording must not allocate
+    core.setTraceSize(1024);
+
+    // Warm up: grows the mock buffers to their working size
+    handshake(hw, core);
+    for (int i = 0; i < 3; i++) {
+        hw.advance_time(60000);
+        run_until_idle(hw, core);
+        core.controlTemperature(20 + i);
+        run_until_idle(hw, core);
+    }
+
+    bool passed = true;
+    ScenarioReport reports[4] = {
+        {"handshake", 0, 0, 0},
+        {"status poll", 0, 0, 0},
+        {"unsolicited mode frame", 0, 0, 0},
+        {"command + ACK + echo", 0, 0, 0},
+    };
+
+    for (unsigned long i = 0; i < 10; i++) {
+        AllocScope scope;
+        handshake(hw, core);
+        reports[0].iterations++;
+        reports[0].allocations += scope.allocations();
+        reports[0].bytes += scope.bytes();
+    }
+    passed &= (core.getStatus() == 8);
+
+    uint32_t modeFrames = core.getRxStats().frames[static_cast<int>(SharpFrameType::mode_response)];
+    uint32_t statusFrames = core.getRxStats().frames[static_cast<int>(SharpFrameType::status_response)];
+    uint32_t txFrames = core.getTxStats().frames;
+
+    for (unsigned long i = 0; i < iterations; i++) {
+        {
+            AllocScope scope;
+            hw.advance_time(60000);
+            run_until_idle(hw, core);
+            reports[1].iterations++;
+            reports[1].allocations += scope.allocations();
+            reports[1].bytes += scope.bytes();
+        }
+        {
+            AllocScope scope;
+            hw.reply(hw.mode_frame, sizeof(hw.mode_frame));
+            run_until_idle(hw, core);
+            reports[2].iterations++;
+            reports[2].allocations += scope.allocations();
+            reports[2].bytes += scope.bytes();
+        }
+        {
+            AllocScope scope;
+            core.controlTemperature(18 + static_cast<int>(i % 10));
+            run_until_idle(hw, core);
+            reports[3].iterations++;
+            reports[3].allocations += scope.allocations();
+            reports[3].bytes += scope.bytes();
+        }
+    }
+
+    print_report(reports, 4);
+
+    // The traffic really happened
+    const SharpRxStats& stats = core.getRxStats();
+    passed &= (core.getStatus() == 8);
+    passed &= (stats.frames[static_cast<int>(SharpFrameType::status_response)] - statusFrames == iterations);
+    passed &= (stats.frames[static_cast<int>(SharpFrameType::mode_response)] - modeFrames == 2 * iterations);
+    passed &= (core.getTxStats().frames - txFrames == 5 * iterations);
+
+    for (size_t i = 0; i < 4; i++) {
+        passed &= (reports[i].allocations == 0);
+    }
+
+    return passed;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║          Sharp AC Heap Allocation Tests                      ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    int passed = 0;
+    int total = 0;
+
+    #define RUN_TEST(test) \
+        total++; \
+        if (test()) { \
+            passed++; \
+            std::cout << "✓ Test passed\n"; \
+        } else { \
+            std::cout << "✗ Test FAILED\n"; \
+        }
+
+    RUN_TEST(test_steady_state_allocations);
+
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    printf("║  Tests Passed: %2d / %2d                                        ║\n", passed, total);
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\n✓✓✓ All allocation tests passed! ✓✓✓\n" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n✗✗✗ Some allocation tests failed! ✗✗✗\n" << std::endl;
+        return 1;
+    }
+}
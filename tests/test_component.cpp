@@ -0,0 +1,395 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+#include "component_rig.h"
+#include "comp_node.h"
+#include "comp_group.h"
+
+// ============================================================================
+// Test Utilities
+// ============================================================================
+
+void print_test_header(const char* test_name) {
+    std::cout << "\n=== Test: " << test_name << " ===" << std::endl;
+}
+
+void print_test_result(const char* test_name, bool passed) {
+    if (passed) {
+        std::cout << "✓ " << test_name << " passed" << std::endl;
+    } else {
+        std::cout << "✗ " << test_name << " FAILED" << std::endl;
+    }
+}
+
+// ============================================================================
+// Component Tests
+// ============================================================================
+
+/**
+ * Test 1: Traits
+ * Verifies the modes, fan modes, presets and temperature range the
+ * climate entity announces
+ */
+bool test_traits() {
+    print_test_header("Traits");
+
+    ComponentRig rig;
+    climate::ClimateTraits traits = rig.ac.traits();
+
+    bool passed = true;
+    passed &= traits.get_supports_current_temperature();
+    passed &= (traits.get_visual_min_temperature() == 16);
+    passed &= (traits.get_visual_max_temperature() == 30);
+    passed &= traits.supports_mode(climate::CLIMATE_MODE_OFF);
+    passed &= traits.supports_mode(climate::CLIMATE_MODE_FAN_ONLY);
+    passed &= !traits.supports_mode(climate::CLIMATE_MODE_AUTO);
+    passed &= traits.supports_fan_mode(climate::CLIMATE_FAN_AUTO);
+    passed &= !traits.supports_fan_mode(climate::CLIMATE_FAN_QUIET);
+    passed &= traits.supports_preset(climate::CLIMATE_PRESET_BOOST);
+    passed &= traits.supports_swing_mode(climate::CLIMATE_SWING_BOTH);
+
+    print_test_result("Traits", passed);
+    return passed;
+}
+
+/**
+ * Test 2: Connection Status
+ * Verifies that the status sensor follows the handshake and the
+ * reconnect button
+ */
+bool test_connection_status() {
+    print_test_header("Connection Status");
+
+    ComponentRig rig;
+    bool passed = (rig.status.state == "Disconnected");
+    passed &= rig.connect();
+
+    rig.reconnect.press();
+    passed &= (rig.status.state == "Connecting (0/8)");
+
+    print_test_result("Connection Status", passed);
+    return passed;
+}
+
+/**
+ * Test 3: Publish Update
+ * Verifies the mapping of a received mode frame onto the climate entity,
+ * the ion switch and both vane selects
+ */
+bool test_publish_update() {
+    print_test_header("Publish Update");
+
+    ComponentRig rig;
+    bool passed = rig.connect();
+    unsigned long publishes = rig.ac.get_publish_count();
+
+    // Heat 22 °C, fan high, eco, ion, vanes left / down
+    uint8_t mode[14] = {0xdc, 0x0b, 0xfc, 0x73, 0x16, 0x51, 0x3d, 0x40, 0x84};
+    rig.receive(mode, sizeof(mode));
+    rig.step();
+
+    passed &= (rig.ac.get_publish_count() > publishes);
+    passed &= (rig.ac.mode == climate::CLIMATE_MODE_HEAT);
+    passed &= (rig.ac.target_temperature == 22);
+    passed &= (rig.ac.current_temperature == 22);
+    // The AC has four fan speeds, Home Assistant gets three
+    passed &= (rig.ac.fan_mode.value() == climate::CLIMATE_FAN_MEDIUM);
+    passed &= (rig.ac.preset.value() == climate::CLIMATE_PRESET_ECO);
+    passed &= (rig.ac.swing_mode == climate::CLIMATE_SWING_OFF);
+    passed &= rig.ion.state;
+    passed &= (rig.vaneH.state == "left");
+    passed &= (rig.vaneV.state == "down");
+
+    // Powered off shows as off, whatever the mode
+    mode[8] = 0x00;
+    rig.receive(mode, sizeof(mode));
+    rig.step();
+    passed &= (rig.ac.mode == climate::CLIMATE_MODE_OFF);
+    passed &= !rig.ion.state;
+
+    print_test_result("Publish Update", passed);
+    return passed;
+}
+
+/**
+ * Test 4: Climate Control
+ * Verifies that a Home Assistant call becomes one command frame and is
+ * published optimistically
+ */
+bool test_control() {
+    print_test_header("Climate Control");
+
+    ComponentRig rig;
+    bool passed = rig.connect();
+
+    rig.ac.make_call()
+        .set_mode(climate::CLIMATE_MODE_COOL)
+        .set_target_temperature(24)
+        .set_fan_mode(climate::CLIMATE_FAN_HIGH)
+        .set_swing_mode(climate::CLIMATE_SWING_VERTICAL)
+        .perform();
+    passed &= (rig.ac.mode == climate::CLIMATE_MODE_COOL);
+    passed &= (rig.ac.target_temperature == 24);
+
+    for (int i = 0; i < 4; i++) rig.step();
+    std::vector<std::vector<uint8_t>> commands = rig.takeCommands();
+    // The whole call goes out as one frame
+    passed &= (commands.size() == 1);
+    if (!commands.empty()) {
+        SharpModeFrame frame(commands.back().data());
+        passed &= frame.validateChecksum();
+        passed &= frame.getState();
+        passed &= (frame.getPowerMode() == PowerMode::cool);
+        // Sent as temp - 15, see test_round_trip for the decoder's offset
+        passed &= (frame.getData()[4] == (0xC0 | (24 - 15)));
+        passed &= (frame.getFanMode() == FanMode::highest);
+        passed &= (frame.getSwingHorizontal() == SwingHorizontal::middle);
+        passed &= (frame.getSwingVertical() == SwingVertical::swing);
+    }
+
+    print_test_result("Climate Control", passed);
+    return passed;
+}
+
+/**
+ * Test 5: Entity Controls
+ * Verifies that the ion switch and the vane selects send commands
+ */
+bool test_entity_controls() {
+    print_test_header("Entity Controls");
+
+    ComponentRig rig;
+    bool passed = rig.connect();
+
+    rig.ion.turn_on();
+    rig.vaneH.make_call("right");
+    rig.vaneV.make_call("up_center");
+    for (int i = 0; i < 4; i++) rig.step();
+
+    std::vector<std::vector<uint8_t>> commands = rig.takeCommands();
+    passed &= !commands.empty();
+    if (!commands.empty()) {
+        SharpModeFrame frame(commands.back().data());
+        passed &= frame.getIon();
+        passed &= (frame.getSwingHorizontal() == SwingHorizontal::right);
+        passed &= (frame.getSwingVertical() == SwingVertical::high);
+    }
+
+    print_test_result("Entity Controls", passed);
+    return passed;
+}
+
+/**
+ * Test 6: Without Optional Entities
+ * Verifies that updates, dump_config and the trace dump work when no
+ * optional entity is configured
+ */
+bool test_without_entities() {
+    print_test_header("Without Optional Entities");
+
+    ComponentRig rig(false);
+    uint8_t mode[14] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80};
+    uint8_t status[18] = {0xdc, 0x0f, 0xfd, 0x00, 0x00, 0x00, 0x00, 21};
+    rig.receive(status, sizeof(status));
+    rig.step();
+    rig.receive(mode, sizeof(mode));
+    rig.step();
+    rig.ac.dump_config();
+    rig.ac.dumpTrace();
+
+    bool passed = (rig.ac.current_temperature == 21);
+    passed &= (rig.ac.mode == climate::CLIMATE_MODE_COOL);
+
+    print_test_result("Without Optional Entities", passed);
+    return passed;
+}
+
+/**
+ * Test 7: Node
+ * Verifies that two units of a `sharp_ac:` block start their handshakes
+ * the spacing apart and that the node report is logged
+ */
+bool test_node() {
+    print_test_header("Node");
+
+    ComponentRig first(false);
+    ComponentRig second(false);
+    second.ac.set_name("Second AC");
+    SharpAcNode node;
+    node.setSpacing(500);
+    node.setReportInterval(60000);
+    node.addUnit(&first.ac);
+    node.addUnit(&second.ac);
+
+    // Both loops on the same clock, as on one node
+    first.step();
+    second.ac.loop();
+    bool passed = !first.uart.tx.empty();
+    passed &= second.uart.tx.empty();
+    for (int i = 0; i < 32; i++) {
+        first.step();
+        second.ac.loop();
+    }
+    passed &= !second.uart.tx.empty();
+
+    passed &= (node.getScheduler().getUnits() == 2);
+    passed &= (node.getScheduler().getStats(0).handshakes == 1);
+    passed &= (node.getScheduler().getStats(1).handshakes == 1);
+
+    unsigned long logs = stub_log_count();
+    node.dump_config();
+    passed &= (stub_log_count() == logs + 5);
+    node.loop();
+    passed &= (stub_log_count() == logs + 5);
+    stub_advance_micros(60000000);
+    node.loop();
+    passed &= (stub_log_count() == logs + 8);
+
+    print_test_result("Node", passed);
+    return passed;
+}
+
+/**
+ * Test 8: Group
+ * Verifies that a group call is applied to each connected unit's own state,
+ * that units in the same state get the same frame and that the group only
+ * completes on the ACK for each unit's own command or after the timeout
+ */
+bool test_group() {
+    print_test_header("Group");
+
+    static const uint8_t ack[1] = {0x06};
+    ComponentRig first(false);
+    ComponentRig second(false);
+    ComponentRig third(false);
+    ComponentRig offline(false);
+    SharpAcNode node;
+    SharpAcGroup group;
+    group.set_name("All ACs");
+    group.set_parent(&node);
+    node.addUnit(&first.ac);
+    node.addUnit(&second.ac);
+    node.addUnit(&third.ac);
+    node.addUnit(&offline.ac);
+
+    first.connect();
+    second.connect();
+    third.connect();
+    bool passed = (first.ac.getCore()->getStatus() == 8 && second.ac.getCore()->getStatus() == 8 &&
+                   third.ac.getCore()->getStatus() == 8);
+
+    // The second unit has its own vanes, its command is still unacknowledged
+    // when the group call comes in
+    second.ac.getCore()->controlSwing(SwingHorizontal::left, SwingVertical::lowest);
+    group.make_call()
+        .set_mode(climate::CLIMATE_MODE_HEAT)
+        .set_target_temperature(22)
+        .perform();
+    for (int i = 0; i < 4; i++) {
+        first.step();
+        third.step();
+    }
+    std::vector<std::vector<uint8_t>> a = first.takeCommands();
+    std::vector<std::vector<uint8_t>> c = third.takeCommands();
+    passed &= (a.size() == 1 && a == c);
+    passed &= offline.uart.tx.empty();
+    if (a.size() == 1) {
+        SharpModeFrame frame(a[0].data());
+        passed &= frame.validateChecksum();
+        passed &= (frame.getPowerMode() == PowerMode::heat);
+        passed &= (frame.getData()[4] == (0xC0 | (22 - 15)));
+        passed &= (frame.getSwingHorizontal() == SwingHorizontal::middle);
+    }
+    passed &= (first.ac.target_temperature == 22 && second.ac.mode == climate::CLIMATE_MODE_HEAT);
+    passed &= (second.ac.getCore()->getState().swingH == SwingHorizontal::left);
+    passed &= (second.ac.getCore()->getState().swingV == SwingVertical::lowest);
+    passed &= (group.mode == climate::CLIMATE_MODE_HEAT);
+    passed &= group.isPending();
+    passed &= (group.getSent() == 3 && group.getFailed() == 1);
+
+    first.receive(ack, 1);
+    first.step();
+    third.receive(ack, 1);
+    third.step();
+    group.loop();
+    passed &= (group.getAcked() == 2);
+
+    // The ACK for the vane command doesn't count for the group's
+    second.receive(ack, 1);
+    for (int i = 0; i < 4; i++) second.step();
+    group.loop();
+    passed &= group.isPending();
+    std::vector<std::vector<uint8_t>> b = second.takeCommands();
+    passed &= (b.size() == 2);
+    if (b.size() == 2) {
+        SharpModeFrame frame(b[1].data());
+        passed &= (frame.getPowerMode() == PowerMode::heat);
+        passed &= (frame.getData()[4] == (0xC0 | (22 - 15)));
+        passed &= (frame.getSwingHorizontal() == SwingHorizontal::left);
+        passed &= (frame.getSwingVertical() == SwingVertical::lowest);
+    }
+    second.receive(ack, 1);
+    second.step();
+    group.loop();
+    passed &= !group.isPending();
+    passed &= (group.getAcked() == 3 && group.getFailed() == 1);
+
+    // The second unit never answers the next one, the third acknowledges a
+    // later command of its own
+    group.make_call().set_mode(climate::CLIMATE_MODE_OFF).perform();
+    first.receive(ack, 1);
+    first.step();
+    third.step();
+    third.ac.getCore()->controlTemperature(20);
+    for (int i = 0; i < 4; i++) third.step();
+    third.receive(ack, 1);
+    third.step();
+    group.loop();
+    passed &= group.isPending();
+    passed &= (group.getAcked() == 1 && group.getFailed() == 2);
+    stub_advance_micros(SHARP_GROUP_TIMEOUT * 1000);
+    group.loop();
+    passed &= !group.isPending();
+    passed &= (group.getAcked() == 1 && group.getFailed() == 3);
+    passed &= (second.ac.mode == climate::CLIMATE_MODE_OFF);
+
+    print_test_result("Group", passed);
+    return passed;
+}
+
+int main() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║     Sharp AC ESPHome Component Tests (Host Stub)          ║" << std::endl;
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    int passed = 0;
+    int total = 0;
+
+    #define RUN_TEST(test_func) \
+        total++; \
+        if (test_func()) passed++;
+
+    RUN_TEST(test_traits);
+    RUN_TEST(test_connection_status);
+    RUN_TEST(test_publish_update);
+    RUN_TEST(test_control);
+    RUN_TEST(test_entity_controls);
+    RUN_TEST(test_without_entities);
+    RUN_TEST(test_node);
+    RUN_TEST(test_group);
+
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║                      Test Summary                          ║" << std::endl;
+    std::cout << "╠════════════════════════════════════════════════════════════╣" << std::endl;
+    printf("║  Tests Passed: %2d / %2d                                      ║\n", passed, total);
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\n✓✓✓ All tests passed! ✓✓✓\n" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n✗✗✗ Some tests failed! ✗✗✗\n" << std::endl;
+        return 1;
+    }
+}
@@ -10,6 +10,7 @@
 #include "core_messages.h"
 #include "core_types.h"
 #include "core_state.h"
+#include "core_registry.h"
 
 using namespace esphome::sharp_ac;
 
@@ -23,6 +24,9 @@ public:
     std::vector<std::vector<uint8_t>> sent_frames;
     unsigned long mock_millis = 0;
     size_t read_position = 0;
+    bool debug_enabled = true;
+    // "TX: <hex>" and "RX: <hex>" lines logged
+    int frame_logs = 0;
 
     size_t read_array(uint8_t *data, size_t len) override {
         size_t bytes_read = 0;
@@ -60,6 +64,7 @@ public:
     }
 
     void log_debug(const char* tag, const char* format, ...) override {
+        if (strcmp(format, "TX: %s") == 0 || strcmp(format, "RX: %s") == 0) frame_logs++;
         #ifdef VERBOSE_TESTS
         va_list args;
         va_start(args, format);
@@ -84,6 +89,10 @@ public:
         return result;
     }
 
+    bool log_debug_enabled() override {
+        return debug_enabled;
+    }
+
     // Helper methods for tests
     void add_incoming_frame(const uint8_t* data, size_t len) {
         uart_buffer.insert(uart_buffer.end(), data, data + len);
@@ -129,6 +138,10 @@ public:
         vane_v_update_count++;
     }
 
+    void on_connection_status_update(int status) override {
+        (void)status;
+    }
+
     void reset_counters() {
         state_update_count = 0;
         ion_update_count = 0;
@@ -137,6 +150,19 @@ public:
     }
 };
 
+// ============================================================================
+// Core with access to the connection state
+// ============================================================================
+
+class ConnectedSharpAcCore : public SharpAcCore {
+public:
+    ConnectedSharpAcCore(SharpAcHardwareInterface* hardware, SharpAcStateCallback* callback)
+        : SharpAcCore(hardware, callback) {
+        this->status = 8;
+        this->currentTemperature = 22.0f;
+    }
+};
+
 // ============================================================================
 // Test Helper Functions
 // ============================================================================
@@ -351,7 +377,49 @@ bool test_parse_swing_modes() {
 }
 
 /**
- * Test 9: processUpdate Integration
+ * Test 9: Unknown Nibbles Keep State
+ * Verifies that mode, fan and swing nibbles naming no known value do not
+ * overwrite the decoded state
+ */
+bool test_unknown_nibbles_keep_state() {
+    print_test_header("Unknown Nibbles Keep State");
+    
+    MockHardwareInterface hw;
+    MockStateCallback callback;
+    ConnectedSharpAcCore core(&hw, &callback);
+    
+    core.setup();
+    
+    // Cool, fan mid, vanes middle/mid, then the same frame with fan 0x9,
+    // mode 0xE and both swing nibbles 0x0
+    uint8_t valid[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x32, 0x1b, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00};
+    uint8_t garbled[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x9e, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00};
+    SharpFrame validFrame(valid, sizeof(valid));
+    SharpFrame garbledFrame(garbled, sizeof(garbled));
+    validFrame.setChecksum();
+    garbledFrame.setChecksum();
+    
+    hw.add_incoming_frame(validFrame.getData(), validFrame.getSize());
+    core.loop();
+    hw.mock_millis += 100;
+    hw.add_incoming_frame(garbledFrame.getData(), garbledFrame.getSize());
+    core.loop();
+    
+    const SharpState& state = core.getState();
+    bool passed = true;
+    passed &= (hw.available() == 0);
+    passed &= (state.mode == PowerMode::cool);
+    passed &= (state.fan == FanMode::mid);
+    passed &= (state.swingH == SwingHorizontal::middle);
+    passed &= (state.swingV == SwingVertical::mid);
+    passed &= (state.state == true);
+    
+    print_test_result("Unknown Nibbles Keep State", passed);
+    return passed;
+}
+
+/**
+ * Test 10: processUpdate Integration
  * Verifies that processUpdate correctly updates the state
  */
 bool test_process_update() {
@@ -397,7 +465,7 @@ bool test_process_update() {
 }
 
 /**
- * Test 10: Control Mode
+ * Test 11: Control Mode
  * Verifies that controlMode works correctly
  */
 bool test_control_mode() {
@@ -427,7 +495,7 @@ bool test_control_mode() {
 }
 
 /**
- * Test 11: Control Temperature
+ * Test 12: Control Temperature
  * Verifies that controlTemperature works correctly
  */
 bool test_control_temperature() {
@@ -454,7 +522,7 @@ bool test_control_temperature() {
 }
 
 /**
- * Test 12: Control Fan
+ * Test 13: Control Fan
  * Verifies that controlFan works correctly
  */
 bool test_control_fan() {
@@ -479,7 +547,7 @@ bool test_control_fan() {
 }
 
 /**
- * Test 13: Control Preset
+ * Test 14: Control Preset
  * Verifies that controlPreset works correctly
  */
 bool test_control_preset() {
@@ -504,7 +572,7 @@ bool test_control_preset() {
 }
 
 /**
- * Test 14: Ion Control
+ * Test 15: Ion Control
  * Verifies that setIon works correctly
  */
 bool test_ion_control() {
@@ -527,7 +595,7 @@ bool test_ion_control() {
 }
 
 /**
- * Test 15: Vane Control
+ * Test 16: Vane Control
  * Verifies that vane control works correctly
  */
 bool test_vane_control() {
@@ -552,6 +620,437 @@ bool test_vane_control() {
     return passed;
 }
 
+/**
+ * Test 17: Pre-encoded Command
+ * Verifies that applyCommand() sends a group's frame as given, takes over
+ * its state and that the AC's ACK is recorded for that command's sequence
+ * number
+ */
+bool test_apply_command() {
+    print_test_header("Pre-encoded Command");
+
+    MockHardwareInterface hw;
+    MockStateCallback callback;
+    ConnectedSharpAcCore core(&hw, &callback);
+    core.setup();
+
+    SharpState target;
+    target.state = true;
+    target.mode = PowerMode::heat;
+    target.temperature = 21;
+    SharpCommandFrame frame = target.toFrame();
+    frame.setChecksum();
+
+    hw.mock_millis = 1000;
+    uint32_t command = core.applyCommand(target, frame);
+
+    bool passed = true;
+    passed &= (hw.sent_frames.size() == 1);
+    if (passed) {
+        passed &= (hw.sent_frames[0] == std::vector<uint8_t>(frame.getData(), frame.getData() + frame.getSize()));
+    }
+    passed &= (core.getState().mode == PowerMode::heat);
+    passed &= (core.getState().temperature == 21);
+    passed &= (command != 0 && core.getAckedCommand() == 0);
+
+    // Only the first ACK after the command counts
+    uint8_t ack[] = {0x06};
+    hw.mock_millis += 100;
+    hw.add_incoming_frame(ack, sizeof(ack));
+    core.loop();
+    hw.mock_millis += 100;
+    hw.add_incoming_frame(ack, sizeof(ack));
+    core.loop();
+    passed &= (core.getTxStats().acked == 1);
+    passed &= (core.getAckedCommand() == command);
+
+    // The next command gets the next number
+    target.temperature = 22;
+    SharpCommandFrame next = target.toFrame();
+    next.setChecksum();
+    hw.mock_millis += 100;
+    passed &= (core.applyCommand(target, next) == command + 1);
+    passed &= (core.getAckedCommand() == command);
+
+    print_test_result("Pre-encoded Command", passed);
+    return passed;
+}
+
+/**
+ * Test 18: Frame Classification
+ * Verifies that the message registry classifies frames by their header bytes
+ */
+static SharpFrameType classify(const uint8_t* data, size_t len) {
+    uint8_t slot = SharpMessageRegistry::find(data, len);
+    if (slot == SHARP_NO_HANDLER) {
+        return SharpFrameType::unknown;
+    }
+    return SharpMessageRegistry::get(slot).type;
+}
+
+bool test_frame_classification() {
+    print_test_header("Frame Classification");
+    
+    uint8_t ack[] = {0x06};
+    uint8_t handshake[] = {0x02, 0xff, 0xff, 0x01, 0x01, 0x00, 0x06, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    uint8_t subscribe[] = {0x03, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    uint8_t mode[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0xb2};
+    uint8_t status[18] = {0xdc, 0x0f};
+    uint8_t unknown[] = {0xdc, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    uint8_t unregistered[] = {0xaa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    
+    bool passed = true;
+    passed &= (SharpRxFrame().getType() == SharpFrameType::none);
+    passed &= (classify(ack, sizeof(ack)) == SharpFrameType::ack);
+    passed &= (classify(handshake, sizeof(handshake)) == SharpFrameType::handshake);
+    passed &= (classify(mode, sizeof(mode)) == SharpFrameType::mode_response);
+    passed &= (classify(status, sizeof(status)) == SharpFrameType::status_response);
+    passed &= (classify(unknown, sizeof(unknown)) == SharpFrameType::unknown);
+    passed &= (SharpMessageRegistry::find(unregistered, sizeof(unregistered)) == SHARP_NO_HANDLER);
+    
+    // Length rules
+    passed &= (SharpMessageRegistry::frameLength(SharpMessageRegistry::find(handshake, 8), handshake) == 14);
+    passed &= (SharpMessageRegistry::frameLength(SharpMessageRegistry::find(subscribe, 8), subscribe) == 17);
+    passed &= (SharpMessageRegistry::frameLength(SharpMessageRegistry::find(mode, 8), mode) == 14);
+    passed &= (SharpMessageRegistry::frameLength(SharpMessageRegistry::find(status, 8), status) == 18);
+    passed &= (SharpMessageRegistry::headerBytes(0x06) == 1);
+    passed &= (SharpMessageRegistry::headerBytes(0xdc) == SHARP_HEADER_SIZE);
+    
+    print_test_result("Frame Classification", passed);
+    return passed;
+}
+
+/**
+ * Test 19: Handshake Frame Of Mode Size
+ * Verifies that a 14 byte 0x02 frame is not decoded as a mode frame
+ */
+bool test_handshake_not_decoded_as_mode() {
+    print_test_header("Handshake Frame Of Mode Size");
+    
+    MockHardwareInterface hw;
+    MockStateCallback callback;
+    ConnectedSharpAcCore core(&hw, &callback);
+    
+    core.setup();
+    
+    // 8 byte header + 6 payload bytes announced in byte 6
+    uint8_t handshake[] = {0x02, 0xff, 0xff, 0x01, 0x01, 0x00, 0x06, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    hw.add_incoming_frame(handshake, sizeof(handshake));
+    core.loop();
+    
+    const SharpState& state = core.getState();
+    bool passed = true;
+    passed &= (hw.available() == 0);
+    passed &= (state.state == false);
+    passed &= (state.mode == PowerMode::fan);
+    passed &= (state.fan == FanMode::low);
+    passed &= (callback.state_update_count == 0);
+    
+    print_test_result("Handshake Frame Of Mode Size", passed);
+    return passed;
+}
+
+/**
+ * Test 20: Checksum Validation And Resync
+ * Verifies that corrupted frames are dropped and counted, that the parser
+ * picks up the next valid frame behind line garbage and that handshake
+ * replies are taken as they come
+ */
+bool test_checksum_validation_and_resync() {
+    print_test_header("Checksum Validation And Resync");
+    
+    MockHardwareInterface hw;
+    MockStateCallback callback;
+    ConnectedSharpAcCore core(&hw, &callback);
+    
+    core.setup();
+    
+    // Cool mode response with one flipped bit in the mode byte
+    uint8_t corrupted[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x23, 0x18, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0xb2};
+    uint8_t garbage[] = {0x55, 0xaa, 0x17};
+    uint8_t valid[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0xb2};
+    
+    hw.add_incoming_frame(corrupted, sizeof(corrupted));
+    for (int i = 0; i < 5 && hw.available() > 0; i++) {
+        core.loop();
+    }
+    
+    bool passed = true;
+    const SharpRxStats& stats = core.getRxStats();
+    passed &= (stats.checksumErrors[static_cast<int>(SharpFrameType::mode_response)] == 1);
+    passed &= (stats.frames[static_cast<int>(SharpFrameType::mode_response)] == 0);
+    passed &= (callback.state_update_count == 0);
+    passed &= (core.getState().mode == PowerMode::fan);
+    
+    hw.add_incoming_frame(garbage, sizeof(garbage));
+    hw.add_incoming_frame(valid, sizeof(valid));
+    for (int i = 0; i < 5 && hw.available() > 0; i++) {
+        core.loop();
+    }
+    
+    passed &= (stats.frames[static_cast<int>(SharpFrameType::mode_response)] == 1);
+    passed &= (stats.droppedBytes >= sizeof(corrupted) + sizeof(garbage));
+    passed &= (core.getState().mode == PowerMode::cool);
+    passed &= (callback.state_update_count > 0);
+    
+    // Handshake replies carry no checksum the protocol defines, the last
+    // byte is taken as it is
+    uint8_t handshake[] = {0x02, 0xff, 0xff, 0x01, 0x01, 0x00, 0x00, 0x5a};
+    hw.add_incoming_frame(handshake, sizeof(handshake));
+    for (int i = 0; i < 5 && hw.available() > 0; i++) {
+        core.loop();
+    }
+    passed &= (stats.frames[static_cast<int>(SharpFrameType::handshake)] == 1);
+    passed &= (stats.checksumErrors[static_cast<int>(SharpFrameType::handshake)] == 0);
+    
+    print_test_result("Checksum Validation And Resync", passed);
+    return passed;
+}
+
+/**
+ * Test 21: Inter-Byte Gap Frame Delimiting
+ * Verifies that an idle line ends a frame in progress after the frame gap
+ * and that observed gaps are recorded in the histogram
+ */
+bool test_inter_byte_gap() {
+    print_test_header("Inter-Byte Gap Frame Delimiting");
+    
+    MockHardwareInterface hw;
+    MockStateCallback callback;
+    ConnectedSharpAcCore core(&hw, &callback);
+    
+    core.setup();
+    // 9600 baud 8E1: 1145us per character, 4 character gap
+    core.setLineTiming(9600, 11);
+    core.setFrameGap(4);
+    
+    uint8_t valid[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0xb2};
+    
+    // First half of a frame, then the line goes quiet
+    hw.mock_millis = 1000;
+    hw.add_incoming_frame(valid, 9);
+    core.loop();
+    
+    bool passed = true;
+    const SharpRxStats& stats = core.getRxStats();
+    int mode = static_cast<int>(SharpFrameType::mode_response);
+    
+    // 3ms is less than the frame gap, the frame stays open
+    hw.mock_millis += 3;
+    core.loop();
+    passed &= (stats.truncated[mode] == 0);
+    
+    hw.mock_millis += 3;
+    core.loop();
+    passed &= (stats.truncated[mode] == 1);
+    passed &= (stats.droppedBytes == 9);
+    
+    // A complete frame after the gap is decoded normally
+    hw.mock_millis += 100;
+    hw.add_incoming_frame(valid, sizeof(valid));
+    core.loop();
+    passed &= (stats.frames[mode] == 1);
+    passed &= (core.getState().mode == PowerMode::cool);
+    
+    // Two reads: 8 back-to-back bytes, one 100ms gap (64+ characters)
+    passed &= (stats.gapHistogram[0] == 8 + 13);
+    passed &= (stats.gapHistogram[SharpGapBuckets - 1] == 1);
+    
+    print_test_result("Inter-Byte Gap Frame Delimiting", passed);
+    return passed;
+}
+
+/**
+ * Test 22: Half-Duplex TX Scheduling
+ * Verifies that writes wait until the AC has finished sending and the line
+ * was quiet, and that queued command frames are coalesced
+ */
+bool test_half_duplex_tx() {
+    print_test_header("Half-Duplex TX Scheduling");
+    
+    MockHardwareInterface hw;
+    MockStateCallback callback;
+    ConnectedSharpAcCore core(&hw, &callback);
+    
+    core.setup();
+    core.setLineTiming(9600, 11);
+    core.setTxQuiet(2);
+    
+    uint8_t valid[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0xb2};
+    
+    // The AC is half way through a frame
+    hw.mock_millis = 1000;
+    hw.add_incoming_frame(valid, 9);
+    core.loop();
+    hw.clear_sent_frames();
+    
+    core.controlTemperature(24);
+    core.controlFan(FanMode::high);
+    
+    bool passed = true;
+    passed &= (hw.sent_frames.size() == 0);
+    passed &= (core.getTxStats().deferred == 2);
+    passed &= (core.getTxStats().coalesced == 1);
+    
+    // Rest of the frame arrives, the ACK and the command still wait for quiet
+    hw.mock_millis += 1;
+    hw.add_incoming_frame(valid + 9, sizeof(valid) - 9);
+    core.loop();
+    passed &= (hw.sent_frames.size() == 0);
+    
+    // Quiet long enough: one frame per loop, the command with the latest state
+    hw.mock_millis += 3;
+    core.loop();
+    hw.mock_millis += 100;
+    core.loop();
+    passed &= (hw.sent_frames.size() == 2);
+    if (passed) {
+        passed &= (hw.sent_frames[0].size() == 14);
+        passed &= (hw.sent_frames[0][0] == 0xdd);
+        passed &= ((hw.sent_frames[0][6] >> 4) == static_cast<int>(FanMode::high));
+        passed &= (hw.sent_frames[1].size() == 1);
+        passed &= (hw.sent_frames[1][0] == 0x06);
+    }
+    
+    print_test_result("Half-Duplex TX Scheduling", passed);
+    return passed;
+}
+
+/**
+ * Test 23: Retry After A Damaged Answer
+ * Verifies that a request whose answer arrives damaged or not at all is
+ * sent again, and that the connection is only reset once the retries are
+ * used up
+ */
+bool test_retry_damaged_answer() {
+    print_test_header("Retry After A Damaged Answer");
+    
+    MockHardwareInterface hw;
+    MockStateCallback callback;
+    ConnectedSharpAcCore core(&hw, &callback);
+    
+    core.setup();
+    core.setLineTiming(9600, 11);
+    
+    // Status answer with one flipped bit
+    uint8_t damaged[] = {0xdc, 0x0f, 0xfd, 0x00, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00,
+                         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xdd};
+    
+    // The first poll
+    hw.mock_millis = 60000;
+    core.loop();
+    bool passed = (hw.sent_frames.size() == 1);
+    
+    // Asked again once the rest of the answer is off the line
+    hw.mock_millis += 50;
+    hw.add_incoming_frame(damaged, sizeof(damaged));
+    for (int i = 0; i < 5; i++) {
+        hw.mock_millis += 16;
+        core.loop();
+    }
+    passed &= (hw.sent_frames.size() == 2);
+    if (passed) {
+        passed &= (hw.sent_frames[1] == hw.sent_frames[0]);
+    }
+    passed &= (core.getTxStats().retried == 1);
+    passed &= (core.getStatus() == 8);
+    
+    // No answer at all: sent once more after the response timeout, then
+    // the connection is reset
+    hw.mock_millis += 10000;
+    core.loop();
+    passed &= (hw.sent_frames.size() == 3);
+    passed &= (core.getTxStats().retried == 2);
+    passed &= (core.getStatus() == 8);
+    hw.mock_millis += 10000;
+    core.loop();
+    passed &= (core.getTxStats().retried == 2);
+    passed &= (core.getStatus() == 0);
+    
+    print_test_result("Retry After A Damaged Answer", passed);
+    return passed;
+}
+
+/**
+ * Test 24: Frame Trace Ring Buffer
+ * Verifies that RX and TX frames are recorded with their timestamps, that
+ * the oldest entries make room for new ones and that entries format as
+ * capture log lines
+ */
+bool test_frame_trace() {
+    print_test_header("Frame Trace Ring Buffer");
+    
+    MockHardwareInterface hw;
+    MockStateCallback callback;
+    ConnectedSharpAcCore core(&hw, &callback);
+    
+    core.setup();
+    bool passed = true;
+    
+    // Off by default, nothing is recorded
+    uint8_t valid[] = {0xdc, 0x0b, 0xfc, 0x73, 0x1a, 0x22, 0x18, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0xb2};
+    hw.mock_millis = 1000;
+    hw.add_incoming_frame(valid, sizeof(valid));
+    core.loop();
+    passed &= (core.getTrace().count() == 0);
+    
+    // Room for exactly four mode frames (5 + 14 bytes each)
+    core.setTraceSize(4 * (SHARP_TRACE_ENTRY_OVERHEAD + sizeof(valid)));
+    hw.mock_millis = 2000;
+    hw.add_incoming_frame(valid, sizeof(valid));
+    core.loop();
+    hw.mock_millis += 100;
+    core.loop();
+    
+    // The mode frame and our ACK
+    const SharpFrameTrace& trace = core.getTrace();
+    passed &= (trace.count() == 2);
+    SharpTraceEntry entry;
+    SharpFrameTrace::Cursor cursor = trace.first();
+    passed &= trace.next(cursor, entry);
+    passed &= (!entry.tx && entry.millis == 2000 && entry.size == sizeof(valid));
+    passed &= (memcmp(entry.data, valid, sizeof(valid)) == 0);
+    passed &= trace.next(cursor, entry);
+    passed &= (entry.tx && entry.size == 1 && entry.data[0] == 0x06);
+    passed &= !trace.next(cursor, entry);
+    
+    char line[SHARP_TRACE_LINE_SIZE];
+    cursor = trace.first();
+    trace.next(cursor, entry);
+    entry.format(line, sizeof(line));
+    passed &= (strcmp(line, "@2000 RX: DC.0B.FC.73.1A.22.18.00.80.00.00.00.00.B2 (14)") == 0);
+    trace.next(cursor, entry);
+    entry.format(line, sizeof(line));
+    passed &= (strcmp(line, "@2100 TX: ACK") == 0);
+    
+    passed &= (hw.frame_logs == 2);
+
+    // Five more mode frames: only the last four fit, oldest first. With
+    // DEBUG off they are recorded without being formatted for the log.
+    hw.debug_enabled = false;
+    for (int i = 0; i < 5; i++) {
+        hw.mock_millis += 1000;
+        valid[4] = static_cast<uint8_t>(0x10 | i);
+        valid[13] = 0;
+        SharpFrame frame(valid, sizeof(valid));
+        frame.setChecksum();
+        hw.add_incoming_frame(frame.getData(), frame.getSize());
+        core.loop();
+    }
+    passed &= (trace.count() == 4);
+    passed &= (trace.getRecorded() == 7);
+    passed &= (trace.getOverwritten() == 3);
+    passed &= (hw.frame_logs == 2);
+    cursor = trace.first();
+    for (int i = 0; i < 4 && passed; i++) {
+        passed &= trace.next(cursor, entry);
+        passed &= (!entry.tx && entry.data[4] == (0x10 | (i + 1)));
+    }
+    
+    print_test_result("Frame Trace Ring Buffer", passed);
+    return passed;
+}
+
 // ============================================================================
 // Main Test Runner
 // ============================================================================
@@ -577,6 +1076,7 @@ int main() {
     RUN_TEST(test_parse_fan_modes);
     RUN_TEST(test_parse_temperature_range);
     RUN_TEST(test_parse_swing_modes);
+    RUN_TEST(test_unknown_nibbles_keep_state);
     
     // Integration Tests
     RUN_TEST(test_process_update);
@@ -588,6 +1088,18 @@ int main() {
     RUN_TEST(test_control_preset);
     RUN_TEST(test_ion_control);
     RUN_TEST(test_vane_control);
+    RUN_TEST(test_apply_command);
+    
+    // Frame Dispatch Tests
+    RUN_TEST(test_frame_classification);
+    RUN_TEST(test_handshake_not_decoded_as_mode);
+    RUN_TEST(test_checksum_validation_and_resync);
+    RUN_TEST(test_inter_byte_gap);
+    RUN_TEST(test_half_duplex_tx);
+    RUN_TEST(test_retry_damaged_answer);
+    
+    // Diagnostics Tests
+    RUN_TEST(test_frame_trace);
     
     std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
     std::cout << "║                      Test Summary                          ║" << std::endl;
@@ -0,0 +1,458 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "coro_session.h"
+#include "host_serial.h"
+#include "emulated_ac.h"
+#include "fd_line.h"
+
+// ============================================================================
+// Test Utilities
+// ============================================================================
+//
+// The coroutine sessions from tools/ against the EmulatedAc. MemoryLine
+// connects a session and its AC in memory on a simulated clock shared by
+// all units, so thousands of them run in well under a second; the last
+// test puts a few on ptys and the loop's own epoll.
+
+void print_test_header(const char* test_name) {
+    std::cout << "\n=== Test: " << test_name << " ===" << std::endl;
+}
+
+void print_test_result(const char* test_name, bool passed) {
+    if (passed) {
+        std::cout << "✓ " << test_name << " passed" << std::endl;
+    } else {
+        std::cout << "✗ " << test_name << " FAILED" << std::endl;
+    }
+}
+
+static uint64_t wallMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static double cpuSeconds() {
+    return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+// The simulated clock and the times at which answers are complete on
+// their lines, earliest first
+struct VirtualBus {
+    struct Arrival {
+        uint64_t time;
+        size_t line;
+        bool operator>(const Arrival& other) const { return time > other.time; }
+    };
+
+    uint64_t clock = 0;
+    std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival>> arrivals;
+};
+
+// The session writes whole frames, the AC gets each one as it is written.
+// The AC's answers arrive byte by byte at 9600 baud 8E1 after its delay.
+class MemoryLine : public SharpAcHardwareInterface, public SimLine {
+public:
+    MemoryLine(VirtualBus& bus, size_t index, SimPeer* peer, uint64_t seed)
+        : bus(bus), index(index), peer(peer), rng(seed) {}
+
+    SimRandom& random() override { return rng; }
+
+    void send(const uint8_t* data, size_t len, uint64_t delayMicros = 0) override {
+        uint64_t start = bus.clock + delayMicros;
+        if (start < lineFree) start = lineFree;
+        for (size_t i = 0; i < len; i++) {
+            RxByte byte = {start + (i + 1) * CHAR_MICROS, data[i]};
+            rx.push_back(byte);
+        }
+        lineFree = start + len * CHAR_MICROS;
+        VirtualBus::Arrival arrival = {lineFree, index};
+        bus.arrivals.push(arrival);
+    }
+
+    size_t read_array(uint8_t* data, size_t len) override {
+        size_t count = 0;
+        while (count < len && !rx.empty() && rx.front().time <= bus.clock) {
+            data[count++] = rx.front().value;
+            rx.pop_front();
+        }
+        return count;
+    }
+
+    size_t available() override {
+        size_t count = 0;
+        for (size_t i = 0; i < rx.size() && rx[i].time <= bus.clock; i++) count++;
+        return count;
+    }
+
+    void write_array(const uint8_t* data, size_t len) override {
+        framesOut++;
+        peer->receive(*this, data, len);
+    }
+
+    uint8_t peek() override { return available() ? rx.front().value : 0; }
+
+    uint8_t read() override {
+        uint8_t value = 0;
+        read_array(&value, 1);
+        return value;
+    }
+
+    unsigned long get_millis() override { return static_cast<uint32_t>(bus.clock / 1000); }
+    unsigned long get_micros() override { return static_cast<uint32_t>(bus.clock); }
+    void log_debug(const char* tag, const char* format, ...) override {
+        (void)tag;
+        (void)format;
+    }
+    std::string format_hex_pretty(const uint8_t* data, size_t len) override {
+        SharpFrame frame(data, len);
+        char hex[SHARP_HEX_BUFFER_SIZE];
+        frame.formatHex(hex, sizeof(hex));
+        return hex;
+    }
+
+    uint64_t framesOut = 0;
+
+private:
+    static const uint64_t CHAR_MICROS = 11 * 1000000ULL / 9600;
+
+    struct RxByte {
+        uint64_t time;
+        uint8_t value;
+    };
+
+    VirtualBus& bus;
+    size_t index;
+    SimPeer* peer;
+    SimRandom rng;
+    std::deque<RxByte> rx;
+    uint64_t lineFree = 0;
+};
+
+class StatusRecorder : public SharpAcStateCallback {
+public:
+    std::vector<int> statuses;
+    uint32_t stateUpdates = 0;
+    void on_state_update() override { stateUpdates++; }
+    void on_ion_state_update(bool state) override { (void)state; }
+    void on_vane_horizontal_update(SwingHorizontal val) override { (void)val; }
+    void on_vane_vertical_update(SwingVertical val) override { (void)val; }
+    void on_connection_status_update(int status) override { statuses.push_back(status); }
+};
+
+// N sessions on one loop, each with its own EmulatedAc, all on the
+// simulated clock. Sessions go before the loop in destruction order.
+struct CoroRig {
+    VirtualBus bus;
+    SharpCoroLoop loop;
+    std::vector<std::unique_ptr<EmulatedAc>> acs;
+    std::vector<std::unique_ptr<MemoryLine>> lines;
+    std::vector<std::unique_ptr<StatusRecorder>> recorders;
+    std::vector<std::unique_ptr<SharpSession>> sessions;
+
+    explicit CoroRig(size_t units) {
+        for (size_t i = 0; i < units; i++) {
+            acs.push_back(std::unique_ptr<EmulatedAc>(new EmulatedAc()));
+            lines.push_back(std::unique_ptr<MemoryLine>(new MemoryLine(bus, i, acs.back().get(), i + 1)));
+            recorders.push_back(std::unique_ptr<StatusRecorder>(new StatusRecorder()));
+            sessions.push_back(
+                std::unique_ptr<SharpSession>(new SharpSession(loop, lines.back().get(), recorders.back().get())));
+        }
+        for (size_t i = 0; i < units; i++) loop.add(*sessions[i]);
+    }
+
+    // Jumps from event to event: an answer complete on a line, or a
+    // session's deadline
+    void run(uint64_t micros) {
+        uint64_t end = bus.clock + micros;
+        for (;;) {
+            uint64_t next = loop.nextDue();
+            if (!bus.arrivals.empty() && bus.arrivals.top().time < next) next = bus.arrivals.top().time;
+            if (next > end) break;
+            if (next > bus.clock) bus.clock = next;
+            while (!bus.arrivals.empty() && bus.arrivals.top().time <= bus.clock) {
+                size_t line = bus.arrivals.top().line;
+                bus.arrivals.pop();
+                loop.readable(*sessions[line], bus.clock);
+            }
+            loop.runDue(bus.clock);
+        }
+        bus.clock = end;
+    }
+
+    size_t connected() const {
+        size_t count = 0;
+        for (size_t i = 0; i < sessions.size(); i++) {
+            if (sessions[i]->getStatus() == 8) count++;
+        }
+        return count;
+    }
+};
+
+// ============================================================================
+// Session Tests
+// ============================================================================
+
+/**
+ * Test 1: Straight Line Handshake
+ * Verifies that the coroutine walks through the same eight connection
+ * steps as SharpAcCore and ends up with the AC's state
+ */
+bool test_handshake() {
+    print_test_header("Straight Line Handshake");
+
+    CoroRig rig(1);
+    rig.run(1000000);
+    SharpSession& session = *rig.sessions[0];
+    EmulatedAc& ac = *rig.acs[0];
+
+    bool passed = session.getStatus() == 8 && ac.isConnected();
+    std::vector<int> expected = {1, 2, 3, 4, 5, 6, 7, 8};
+    passed &= (rig.recorders[0]->statuses == expected);
+    passed &= (session.getState().temperature == ac.state.temperature);
+    passed &= (session.getState().mode == ac.state.mode);
+    passed &= (session.getState().fan == ac.state.fan);
+    passed &= (session.getState().state == ac.state.state);
+    passed &= (session.getCurrentTemperature() == static_cast<float>(ac.roomTemperature));
+    passed &= (session.getStats().connects == 1 && session.getStats().timeouts == 0);
+    // The handshake frames go unacknowledged, like with the core
+    passed &= (ac.getStats().acks == 0);
+    printf("  %llu frames sent, %llu resumes\n", static_cast<unsigned long long>(rig.lines[0]->framesOut),
+           static_cast<unsigned long long>(rig.loop.getResumes()));
+
+    print_test_result("Straight Line Handshake", passed);
+    return passed;
+}
+
+/**
+ * Test 2: Commands And Polls
+ * Verifies that controls made before the session runs again go out as one
+ * command frame, that the status is polled every minute and that a change
+ * made with the remote is picked up and acknowledged
+ */
+bool test_commands_and_polls() {
+    print_test_header("Commands And Polls");
+
+    CoroRig rig(1);
+    rig.run(1000000);
+    SharpSession& session = *rig.sessions[0];
+    EmulatedAc& ac = *rig.acs[0];
+    bool passed = session.getStatus() == 8;
+
+    session.controlTemperature(19);
+    session.controlFan(FanMode::high);
+    rig.run(100000);
+    passed &= (ac.getStats().commands == 1);
+    passed &= (ac.state.temperature == 19 && ac.state.fan == FanMode::high);
+    passed &= (session.getStats().commands == 1);
+    // 5 ms answer delay plus the ACK on the line
+    passed &= (session.getStats().commandMicros >= 5000 && session.getStats().commandMicros < 10000);
+    printf("  Command ACKed after %.2f ms\n", session.getStats().commandMicros / 1000.0);
+
+    rig.run(150000000);
+    passed &= (session.getStats().polls == 2);
+    passed &= (session.getStats().timeouts == 0);
+
+    SharpState remote = ac.state;
+    remote.temperature = 28;
+    remote.mode = PowerMode::heat;
+    uint32_t acks = ac.getStats().acks;
+    ac.remoteControl(*rig.lines[0], remote);
+    rig.run(100000);
+    passed &= (session.getState().temperature == 28 && session.getState().mode == PowerMode::heat);
+    passed &= (session.getStats().unsolicited >= 1);
+    passed &= (ac.getStats().acks == acks + 1);
+
+    print_test_result("Commands And Polls", passed);
+    return passed;
+}
+
+/**
+ * Test 3: Timeout Reconnects
+ * Verifies that a poll without answer ends the session's connected phase
+ * after the response timeout and that it connects again once the AC is
+ * back
+ */
+bool test_timeout_reconnects() {
+    print_test_header("Timeout Reconnects");
+
+    CoroRig rig(1);
+    rig.run(1000000);
+    SharpSession& session = *rig.sessions[0];
+    EmulatedAc& ac = *rig.acs[0];
+    bool passed = session.getStatus() == 8;
+
+    ac.online = false;
+    // Next poll a minute after connecting, then 10 s without an answer
+    rig.run(65000000);
+    passed &= (session.getStatus() == 8);
+    rig.run(10000000);
+    passed &= (session.getStatus() < 8);
+    passed &= (session.getStats().timeouts >= 1);
+
+    ac.online = true;
+    rig.run(15000000);
+    passed &= (session.getStatus() == 8);
+    passed &= (session.getStats().connects == 2);
+    passed &= (session.getStats().reconnects == 1);
+    passed &= (ac.getStats().handshakes == 2);
+
+    print_test_result("Timeout Reconnects", passed);
+    return passed;
+}
+
+/**
+ * Test 4: Thousands Of Sessions
+ * Verifies that 4000 sessions connect and poll on one thread, and reports
+ * the time and memory each one costs
+ */
+bool test_thousands_of_sessions() {
+    print_test_header("Thousands Of Sessions");
+
+    const size_t units = 4000;
+    uint64_t framesBefore = SharpCoroFrames::live;
+    uint64_t wallStart = wallMicros();
+    double cpuStart = cpuSeconds();
+
+    CoroRig rig(units);
+    rig.run(1000000);
+    bool passed = rig.connected() == units;
+
+    // Ten simulated minutes
+    rig.run(600000000);
+    double cpu = cpuSeconds() - cpuStart;
+    uint64_t wall = wallMicros() - wallStart;
+
+    uint32_t minPolls = UINT32_MAX;
+    for (size_t i = 0; i < units; i++) {
+        const SharpSessionStats& stats = rig.sessions[i]->getStats();
+        if (stats.polls < minPolls) minPolls = stats.polls;
+        passed &= (stats.timeouts == 0 && stats.connects == 1);
+    }
+    passed &= (rig.connected() == units);
+    passed &= (minPolls == 10);
+
+    uint64_t frames = SharpCoroFrames::live - framesBefore;
+    double frameBytes = static_cast<double>(SharpCoroFrames::liveBytes) / units;
+    printf("  %zu sessions, 10 simulated minutes in %.0f ms wall, %.1f us CPU per unit and minute\n", units,
+           wall / 1000.0, cpu * 1e6 / units / 10);
+    printf("  %llu resumes, %llu suspended frames, %.0f frame bytes + %zu session bytes per unit\n",
+           static_cast<unsigned long long>(rig.loop.getResumes()), static_cast<unsigned long long>(frames),
+           frameBytes, sizeof(SharpSession));
+    // Idle in serve(): the run() and serve() frames
+    passed &= (frames == 2 * units);
+    passed &= (frameBytes < 1024);
+
+    print_test_result("Thousands Of Sessions", passed);
+    return passed;
+}
+
+/**
+ * Test 5: Sessions On Ptys
+ * Verifies the epoll driven loop with sessions on real serial ports
+ */
+bool test_sessions_on_ptys() {
+    print_test_header("Sessions On Ptys");
+
+    const int units = 4;
+    SharpCoroLoop loop;
+    std::vector<int> masters;
+    std::vector<std::unique_ptr<EmulatedAc>> acs;
+    std::vector<std::unique_ptr<FdLine>> lines;
+    std::vector<std::unique_ptr<SharpSerialPort>> ports;
+    std::vector<std::unique_ptr<SharpSession>> sessions;
+    bool passed = true;
+
+    for (int i = 0; i < units; i++) {
+        std::string slave;
+        int master = openPty(slave);
+        std::unique_ptr<SharpSerialPort> port(new SharpSerialPort());
+        if (master < 0 || !port->open(slave.c_str())) {
+            passed = false;
+            if (master >= 0) close(master);
+            break;
+        }
+        masters.push_back(master);
+        acs.push_back(std::unique_ptr<EmulatedAc>(new EmulatedAc()));
+        lines.push_back(std::unique_ptr<FdLine>(new FdLine(master, acs.back().get(), i + 1)));
+        ports.push_back(std::move(port));
+        sessions.push_back(std::unique_ptr<SharpSession>(new SharpSession(loop, ports.back().get())));
+        passed &= loop.watch(*sessions.back(), ports.back()->getFd());
+        loop.add(*sessions.back());
+    }
+
+    auto run = [&](std::function<bool()> done) {
+        uint64_t end = wallMicros() + 5000000;
+        while (!done() && wallMicros() < end) {
+            loop.runOnce(1);
+            for (size_t i = 0; i < lines.size(); i++) lines[i]->service(0);
+        }
+        return done();
+    };
+
+    uint64_t start = wallMicros();
+    passed &= run([&]() {
+        for (size_t i = 0; i < sessions.size(); i++) {
+            if (sessions[i]->getStatus() != 8) return false;
+        }
+        return !sessions.empty();
+    });
+    printf("  %zu sessions connected after %llu ms\n", sessions.size(),
+           static_cast<unsigned long long>((wallMicros() - start) / 1000));
+
+    if (passed) {
+        sessions[2]->controlMode(PowerMode::heat, true);
+        sessions[2]->controlTemperature(21);
+        passed &= run([&]() { return acs[2]->state.mode == PowerMode::heat && acs[2]->state.temperature == 21; });
+        passed &= (acs[2]->getStats().commands == 1);
+        passed &= (acs[1]->getStats().commands == 0);
+    }
+
+    sessions.clear();
+    for (size_t i = 0; i < masters.size(); i++) close(masters[i]);
+
+    print_test_result("Sessions On Ptys", passed);
+    return passed;
+}
+
+int main() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║     Sharp AC Coroutine Session Tests                       ║" << std::endl;
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    int passed = 0;
+    int total = 0;
+
+    #define RUN_TEST(test_func) \
+        total++; \
+        if (test_func()) passed++;
+
+    RUN_TEST(test_handshake);
+    RUN_TEST(test_commands_and_polls);
+    RUN_TEST(test_timeout_reconnects);
+    RUN_TEST(test_thousands_of_sessions);
+    RUN_TEST(test_sessions_on_ptys);
+
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║                      Test Summary                          ║" << std::endl;
+    std::cout << "╠════════════════════════════════════════════════════════════╣" << std::endl;
+    printf("║  Tests Passed: %2d / %2d                                      ║\n", passed, total);
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\n✓✓✓ All tests passed! ✓✓✓\n" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n✗✗✗ Some tests failed! ✗✗✗\n" << std::endl;
+        return 1;
+    }
+}
@@ -180,6 +180,7 @@ void test_command_generation() {
     printf("  Byte[6] (Mode): 0x%02x (should have cool+mid)\n", cmd.getData()[6]);
     printf("  Byte[8] (Swing): 0x%02x\n", cmd.getData()[8]);
     
+    assert(cmd.getData()[4] == 0xCA);
     assert(cmd.validateChecksum() == true);
     printf("✓ Checksum: VALID\n");
     printf("✓ PASSED\n");
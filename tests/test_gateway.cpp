@@ -0,0 +1,220 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gateway.h"
+#include "emulated_ac.h"
+#include "fd_line.h"
+
+// ============================================================================
+// Test Utilities
+// ============================================================================
+//
+// The gateway from tools/ with every unit on a pty pair, the EmulatedAc of
+// each unit on the master side. Gateway and peers take turns on one thread.
+
+void print_test_header(const char* test_name) {
+    std::cout << "\n=== Test: " << test_name << " ===" << std::endl;
+}
+
+void print_test_result(const char* test_name, bool passed) {
+    if (passed) {
+        std::cout << "✓ " << test_name << " passed" << std::endl;
+    } else {
+        std::cout << "✗ " << test_name << " FAILED" << std::endl;
+    }
+}
+
+static uint64_t wallMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+struct GatewayRig {
+    Gateway gateway;
+    std::vector<int> masters;
+    std::vector<std::unique_ptr<EmulatedAc>> acs;
+    std::vector<std::unique_ptr<FdLine>> lines;
+
+    explicit GatewayRig(int units) {
+        for (int i = 0; i < units; i++) {
+            std::string slave;
+            int master = openPty(slave);
+            if (master < 0) continue;
+            masters.push_back(master);
+            acs.push_back(std::unique_ptr<EmulatedAc>(new EmulatedAc()));
+            lines.push_back(std::unique_ptr<FdLine>(new FdLine(master, acs.back().get(), i + 1)));
+            gateway.addSerialUnit("ac" + std::to_string(i), slave.c_str());
+        }
+    }
+
+    ~GatewayRig() {
+        for (size_t i = 0; i < masters.size(); i++) {
+            if (masters[i] >= 0) close(masters[i]);
+        }
+    }
+
+    // Returns the loop() calls the gateway made
+    uint64_t run(uint64_t micros) {
+        uint64_t loops = 0;
+        uint64_t end = wallMicros() + micros;
+        while (wallMicros() < end) {
+            loops += gateway.runOnce(1);
+            for (size_t i = 0; i < lines.size(); i++) {
+                if (masters[i] >= 0) lines[i]->service(0);
+            }
+        }
+        return loops;
+    }
+
+    bool runUntilConnected(uint64_t micros) {
+        uint64_t end = wallMicros() + micros;
+        while (gateway.connectedCount() < gateway.size() && wallMicros() < end) run(10000);
+        return gateway.connectedCount() == gateway.size();
+    }
+};
+
+// ============================================================================
+// Gateway Tests
+// ============================================================================
+
+/**
+ * Test 1: Dozens Of Units
+ * Verifies that 32 units on one epoll loop all complete the handshake and
+ * get response latency metrics
+ */
+bool test_dozens_of_units() {
+    print_test_header("Dozens Of Units");
+
+    const int units = 32;
+    GatewayRig rig(units);
+    bool passed = rig.gateway.ok() && rig.gateway.size() == units;
+
+    uint64_t start = wallMicros();
+    passed &= rig.runUntilConnected(10000000);
+    printf("  %zu / %d connected after %llu ms\n", rig.gateway.connectedCount(), units,
+           static_cast<unsigned long long>((wallMicros() - start) / 1000));
+
+    for (size_t i = 0; i < rig.gateway.size(); i++) {
+        GatewayUnit* unit = rig.gateway.unit(i);
+        passed &= rig.acs[i]->isConnected();
+        passed &= (unit->connects == 1);
+        passed &= (unit->metered.response.getCount() > 0);
+        // EmulatedAc answers after 5 ms
+        passed &= (unit->metered.response.percentile(0.5) >= 5000);
+    }
+    rig.gateway.printStats(stdout);
+
+    print_test_result("Dozens Of Units", passed);
+    return passed;
+}
+
+/**
+ * Test 2: Idle Units Don't Spin
+ * Verifies that connected units only run when the scheduler has work for
+ * them: nothing is due between the status polls a minute apart
+ */
+bool test_idle_units() {
+    print_test_header("Idle Units Don't Spin");
+
+    GatewayRig rig(16);
+    bool passed = rig.runUntilConnected(10000000);
+    // Let the handshake and first poll settle
+    rig.run(200000);
+    uint64_t loops = rig.run(500000);
+    printf("  %llu loop() calls in 500 ms for 16 idle units\n", static_cast<unsigned long long>(loops));
+    passed &= (loops < 16);
+
+    print_test_result("Idle Units Don't Spin", passed);
+    return passed;
+}
+
+/**
+ * Test 3: Commands Per Unit
+ * Verifies that a command for one unit only reaches that unit's AC
+ */
+bool test_commands_per_unit() {
+    print_test_header("Commands Per Unit");
+
+    GatewayRig rig(8);
+    bool passed = rig.runUntilConnected(10000000);
+
+    GatewayUnit* unit = rig.gateway.find("ac5");
+    passed &= unit != nullptr;
+    if (unit != nullptr) {
+        unit->core.controlTemperature(19);
+        rig.gateway.wake(unit);
+    }
+    uint64_t end = wallMicros() + 2000000;
+    while (rig.acs[5]->state.temperature != 19 && wallMicros() < end) rig.run(10000);
+
+    for (size_t i = 0; i < rig.acs.size(); i++) {
+        const EmulatedAcStats& stats = rig.acs[i]->getStats();
+        passed &= (stats.commands == (i == 5 ? 1u : 0u));
+        passed &= (rig.acs[i]->state.temperature == (i == 5 ? 19 : 24));
+    }
+
+    print_test_result("Commands Per Unit", passed);
+    return passed;
+}
+
+/**
+ * Test 4: Link Hangup
+ * Verifies that a unit whose device goes away is marked down and does not
+ * keep the loop busy, while the others carry on
+ */
+bool test_link_hangup() {
+    print_test_header("Link Hangup");
+
+    GatewayRig rig(4);
+    bool passed = rig.runUntilConnected(10000000);
+
+    close(rig.masters[2]);
+    rig.masters[2] = -1;
+    rig.run(100000);
+    uint64_t loops = rig.run(300000);
+
+    passed &= rig.gateway.unit(2)->linkDown;
+    passed &= !rig.gateway.unit(1)->linkDown;
+    passed &= (loops < 8);
+
+    print_test_result("Link Hangup", passed);
+    return passed;
+}
+
+int main() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║     Sharp AC Gateway Tests (epoll, pty)                   ║" << std::endl;
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    int passed = 0;
+    int total = 0;
+
+    #define RUN_TEST(test_func) \
+        total++; \
+        if (test_func()) passed++;
+
+    RUN_TEST(test_dozens_of_units);
+    RUN_TEST(test_idle_units);
+    RUN_TEST(test_commands_per_unit);
+    RUN_TEST(test_link_hangup);
+
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║                      Test Summary                          ║" << std::endl;
+    std::cout << "╠════════════════════════════════════════════════════════════╣" << std::endl;
+    printf("║  Tests Passed: %2d / %2d                                      ║\n", passed, total);
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\n✓✓✓ All tests passed! ✓✓✓\n" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n✗✗✗ Some tests failed! ✗✗✗\n" << std::endl;
+        return 1;
+    }
+}
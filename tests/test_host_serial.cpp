@@ -0,0 +1,292 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "comp_hardware.h"
+#include "comp_connection_status.h"
+#include "host_serial.h"
+#include "emulated_ac.h"
+#include "fd_line.h"
+
+using namespace esphome;
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Test Utilities
+// ============================================================================
+//
+// Built with -DUSE_HOST: the component opens its serial device itself, like
+// on the ESPHome host platform. The AC is the EmulatedAc on the master side
+// of a pty pair and everything runs on the wall clock.
+
+void print_test_header(const char* test_name) {
+    std::cout << "\n=== Test: " << test_name << " ===" << std::endl;
+}
+
+void print_test_result(const char* test_name, bool passed) {
+    if (passed) {
+        std::cout << "✓ " << test_name << " passed" << std::endl;
+    } else {
+        std::cout << "✗ " << test_name << " FAILED" << std::endl;
+    }
+}
+
+static uint64_t wallMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Generous, the handshake itself takes well under a second on a pty
+static const uint64_t connectTimeout = 10000000;
+
+class StatusCallback : public SharpAcStateCallback {
+public:
+    int status = 0;
+    void on_state_update() override {}
+    void on_ion_state_update(bool state) override { (void)state; }
+    void on_vane_horizontal_update(SwingHorizontal val) override { (void)val; }
+    void on_vane_vertical_update(SwingVertical val) override { (void)val; }
+    void on_connection_status_update(int status) override { this->status = status; }
+};
+
+// ============================================================================
+// Serial Port Tests
+// ============================================================================
+
+/**
+ * Test 1: Bytes Through The Pty
+ * Verifies available(), peek(), read_array() and write_array() on the
+ * slave side of a pty pair
+ */
+bool test_pty_bytes() {
+    print_test_header("Bytes Through The Pty");
+
+    std::string slave;
+    int master = openPty(slave);
+    SharpSerialPort port;
+    bool passed = master >= 0 && port.open(slave.c_str());
+    if (!passed) {
+        std::cout << "  " << port.lastError() << std::endl;
+        if (master >= 0) close(master);
+        print_test_result("Bytes Through The Pty", false);
+        return false;
+    }
+
+    const uint8_t in[3] = {0xdc, 0x0b, 0xfc};
+    passed &= write(master, in, sizeof(in)) == 3;
+    uint64_t deadline = wallMicros() + 1000000;
+    while (port.available() < 3 && wallMicros() < deadline) usleep(1000);
+
+    passed &= (port.available() == 3);
+    passed &= (port.peek() == 0xdc);
+    passed &= (port.available() == 3);
+    uint8_t got[4] = {};
+    passed &= (port.read_array(got, sizeof(got)) == 3);
+    passed &= (memcmp(got, in, 3) == 0);
+    passed &= (port.available() == 0);
+    passed &= (port.read_array(got, 1) == 0);
+
+    // Raw mode: no CR/LF translation, no echo
+    const uint8_t out[3] = {0x0d, 0x0a, 0x06};
+    port.write_array(out, sizeof(out));
+    uint8_t echoed[8] = {};
+    ssize_t n = read(master, echoed, sizeof(echoed));
+    passed &= (n == 3 && memcmp(echoed, out, 3) == 0);
+    passed &= (port.available() == 0);
+
+    unsigned long before = port.get_micros();
+    usleep(2000);
+    passed &= (port.get_micros() - before >= 2000);
+
+    port.close();
+    close(master);
+
+    print_test_result("Bytes Through The Pty", passed);
+    return passed;
+}
+
+/**
+ * Test 2: Open Errors
+ * Verifies that a missing device and an unsupported baud rate are
+ * reported instead of leaving a half configured port
+ */
+bool test_open_errors() {
+    print_test_header("Open Errors");
+
+    SharpSerialPort port;
+    bool passed = !port.open("/nonexistent/ttyUSB0");
+    passed &= !port.isOpen();
+    passed &= (strstr(port.lastError(), "/nonexistent/ttyUSB0") != nullptr);
+
+    std::string slave;
+    int master = openPty(slave);
+    passed &= master >= 0;
+    passed &= !port.open(slave.c_str(), 12345);
+    passed &= !port.isOpen();
+    passed &= (strstr(port.lastError(), "baud") != nullptr);
+    passed &= port.open(slave.c_str(), 9600);
+    // A pty already in raw mode rejects the parity bit, it opens anyway
+    port.close();
+    passed &= port.open(slave.c_str(), 9600);
+    close(master);
+
+    print_test_result("Open Errors", passed);
+    return passed;
+}
+
+/**
+ * Test 3: Core Over The Pty
+ * Verifies the handshake and a command between SharpAcCore on the serial
+ * backend and the emulated AC
+ */
+bool test_core_over_pty() {
+    print_test_header("Core Over The Pty");
+
+    std::string slave;
+    int master = openPty(slave);
+    SharpSerialPort port;
+    bool passed = master >= 0 && port.open(slave.c_str());
+
+    StatusCallback callback;
+    SharpAcCore core(&port, &callback);
+    core.setLineTiming(9600, 11);
+    core.setup();
+
+    EmulatedAc ac;
+    FdLine line(master, &ac);
+    uint64_t start = wallMicros();
+    while (passed && callback.status != 8 && wallMicros() - start < connectTimeout) {
+        core.loop();
+        line.service(1);
+    }
+    passed &= (callback.status == 8);
+    passed &= ac.isConnected();
+    std::cout << "  Connected after " << (wallMicros() - start) / 1000 << " ms" << std::endl;
+
+    core.controlTemperature(27);
+    start = wallMicros();
+    while (passed && ac.state.temperature != 27 && wallMicros() - start < 2000000) {
+        core.loop();
+        line.service(1);
+    }
+    passed &= (ac.state.temperature == 27);
+    passed &= (ac.getStats().corrupted == 0);
+
+    port.close();
+    close(master);
+
+    print_test_result("Core Over The Pty", passed);
+    return passed;
+}
+
+// ============================================================================
+// Host Platform Component Tests
+// ============================================================================
+
+/**
+ * Test 4: Component On The Host
+ * Verifies that the full SharpAc component opens its serial port, connects
+ * and sends a Home Assistant call
+ */
+bool test_component_on_host() {
+    print_test_header("Component On The Host");
+
+    std::string slave;
+    int master = openPty(slave);
+    bool passed = master >= 0;
+
+    SharpAc sharp;
+    ConnectionStatusSensor status;
+    sharp.set_name("Sharp AC");
+    sharp.setConnectionStatusSensor(&status);
+    sharp.setSerialPort(slave);
+    sharp.setBaudRate(9600);
+    sharp.setup();
+    passed &= !sharp.is_failed();
+    sharp.dump_config();
+
+    EmulatedAc ac;
+    FdLine line(master, &ac);
+    uint64_t start = wallMicros();
+    uint64_t last = start;
+    auto step = [&]() {
+        line.service(1);
+        uint64_t now = wallMicros();
+        stub_advance_micros(static_cast<uint32_t>(now - last));
+        last = now;
+        sharp.loop();
+    };
+
+    while (passed && status.state != "Connected" && wallMicros() - start < connectTimeout) step();
+    passed &= (status.state == "Connected");
+
+    sharp.make_call().set_mode(climate::CLIMATE_MODE_HEAT).set_target_temperature(21).perform();
+    start = wallMicros();
+    while (passed && !(ac.state.mode == PowerMode::heat && ac.state.temperature == 21) &&
+           wallMicros() - start < 2000000)
+        step();
+    passed &= (ac.state.mode == PowerMode::heat);
+    passed &= (ac.state.temperature == 21);
+    passed &= (sharp.mode == climate::CLIMATE_MODE_HEAT);
+
+    close(master);
+
+    print_test_result("Component On The Host", passed);
+    return passed;
+}
+
+/**
+ * Test 5: Missing Serial Port
+ * Verifies that the component marks itself failed when its device can't
+ * be opened
+ */
+bool test_component_missing_port() {
+    print_test_header("Missing Serial Port");
+
+    SharpAc sharp;
+    sharp.setSerialPort("/nonexistent/ttyUSB0");
+    unsigned long logs = stub_log_count();
+    sharp.setup();
+
+    bool passed = sharp.is_failed();
+    passed &= (stub_log_count() > logs);
+
+    print_test_result("Missing Serial Port", passed);
+    return passed;
+}
+
+int main() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║     Sharp AC Host Serial Backend Tests (pty)              ║" << std::endl;
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    int passed = 0;
+    int total = 0;
+
+    #define RUN_TEST(test_func) \
+        total++; \
+        if (test_func()) passed++;
+
+    RUN_TEST(test_pty_bytes);
+    RUN_TEST(test_open_errors);
+    RUN_TEST(test_core_over_pty);
+    RUN_TEST(test_component_on_host);
+    RUN_TEST(test_component_missing_port);
+
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║                      Test Summary                          ║" << std::endl;
+    std::cout << "╠════════════════════════════════════════════════════════════╣" << std::endl;
+    printf("║  Tests Passed: %2d / %2d                                      ║\n", passed, total);
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\n✓✓✓ All tests passed! ✓✓✓\n" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n✗✗✗ Some tests failed! ✗✗✗\n" << std::endl;
+        return 1;
+    }
+}
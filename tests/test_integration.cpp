@@ -9,136 +9,10 @@
 #include "core_messages.h"
 #include "core_types.h"
 #include "core_state.h"
+#include "test_hardware.h"
 
 using namespace esphome::sharp_ac;
 
-// ============================================================================
-// Mock Hardware Interface
-// ============================================================================
-
-class TestHardwareInterface : public SharpAcHardwareInterface {
-private:
-    std::vector<uint8_t> uart_rx_buffer;
-    std::vector<uint8_t> uart_tx_buffer;
-    size_t read_pos = 0;
-    unsigned long current_millis = 0;
-
-public:
-    std::vector<std::vector<uint8_t>> captured_frames;
-
-    size_t read_array(uint8_t *data, size_t len) override {
-        size_t bytes_read = 0;
-        while (bytes_read < len && read_pos < uart_rx_buffer.size()) {
-            data[bytes_read++] = uart_rx_buffer[read_pos++];
-        }
-        return bytes_read;
-    }
-
-    size_t available() override {
-        return uart_rx_buffer.size() - read_pos;
-    }
-
-    void write_array(const uint8_t *data, size_t len) override {
-        std::vector<uint8_t> frame(data, data + len);
-        captured_frames.push_back(frame);
-        uart_tx_buffer.insert(uart_tx_buffer.end(), data, data + len);
-    }
-
-    uint8_t peek() override {
-        if (read_pos < uart_rx_buffer.size()) {
-            return uart_rx_buffer[read_pos];
-        }
-        return 0;
-    }
-
-    uint8_t read() override {
-        if (read_pos < uart_rx_buffer.size()) {
-            return uart_rx_buffer[read_pos++];
-        }
-        return 0;
-    }
-
-    unsigned long get_millis() override {
-        return current_millis;
-    }
-
-    void log_debug(const char* tag, const char* format, ...) override {
-        #ifdef VERBOSE_TESTS
-        va_list args;
-        va_start(args, format);
-        printf("[%s] ", tag);
-        vprintf(format, args);
-        printf("\n");
-        va_end(args);
-        #else
-        (void)tag;
-        (void)format;
-        #endif
-    }
-
-    std::string format_hex_pretty(const uint8_t *data, size_t len) override {
-        std::string result;
-        for (size_t i = 0; i < len; i++) {
-            char buf[10];
-            snprintf(buf, sizeof(buf), "0x%02X", data[i]);
-            if (i > 0) result += " ";
-            result += buf;
-        }
-        return result;
-    }
-
-    // Test helpers
-    void inject_rx_data(const uint8_t* data, size_t len) {
-        uart_rx_buffer.insert(uart_rx_buffer.end(), data, data + len);
-    }
-
-    void advance_time(unsigned long ms) {
-        current_millis += ms;
-    }
-
-    void reset() {
-        uart_rx_buffer.clear();
-        uart_tx_buffer.clear();
-        captured_frames.clear();
-        read_pos = 0;
-    }
-
-    const std::vector<uint8_t>& get_tx_buffer() const {
-        return uart_tx_buffer;
-    }
-};
-
-class TestStateCallback : public SharpAcStateCallback {
-public:
-    int update_count = 0;
-    bool last_ion_state = false;
-    SwingHorizontal last_swing_h = SwingHorizontal::left;
-    SwingVertical last_swing_v = SwingVertical::lowest;
-
-    void on_state_update() override {
-        update_count++;
-    }
-
-    void on_ion_state_update(bool state) override {
-        (void)state;
-        last_ion_state = state;
-    }
-
-    void on_vane_horizontal_update(SwingHorizontal val) override {
-        (void)val;
-        last_swing_h = val;
-    }
-
-    void on_vane_vertical_update(SwingVertical val) override {
-        (void)val;
-        last_swing_v = val;
-    }
-
-    void reset() {
-        update_count = 0;
-    }
-};
-
 // ============================================================================
 // Test Utilities
 // ============================================================================
@@ -0,0 +1,170 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "core_frame.h"
+#include "core_state.h"
+#include "core_types.h"
+
+// ============================================================================
+// Command Frame Round Trip
+// ============================================================================
+//
+// Every valid SharpState is encoded with SharpCommandFrame::setData() and
+// decoded again through the 0xFB branch of SharpModeFrame. The decoded
+// state has to match what the encoder is documented to send:
+//
+//   - fan mode with auto fan is sent as low fan
+//   - full power is sent with auto fan
+//   - the target temperature is only sent in cool and heat mode
+//
+// The temperature is an expected failure: the encoder sends temp - 15 and
+// getTemperature() reads the nibble + 16, so a command decodes one degree
+// warmer. Which side is wrong needs captured frames, see Known issues in
+// the README. Once one side is fixed the test fails until the field is
+// taken out of expectedFailures.
+
+static const bool powerValues[] = {false, true};
+static const PowerMode modeValues[] = {PowerMode::heat, PowerMode::cool, PowerMode::dry, PowerMode::fan};
+static const FanMode fanValues[] = {FanMode::low, FanMode::mid, FanMode::high, FanMode::highest, FanMode::auto_fan};
+static const Preset presetValues[] = {Preset::NONE, Preset::ECO, Preset::FULLPOWER};
+static const bool ionValues[] = {false, true};
+static const SwingHorizontal swingHValues[] = {SwingHorizontal::swing, SwingHorizontal::middle,
+                                               SwingHorizontal::right, SwingHorizontal::left};
+static const SwingVertical swingVValues[] = {SwingVertical::swing, SwingVertical::auto_position,
+                                             SwingVertical::highest, SwingVertical::high, SwingVertical::mid,
+                                             SwingVertical::low, SwingVertical::lowest};
+static const int minTemperature = 16;
+static const int maxTemperature = 30;
+
+#define COUNT(values) (sizeof(values) / sizeof(values[0]))
+
+static const size_t stateCount = COUNT(powerValues) * COUNT(modeValues) * COUNT(fanValues) * COUNT(presetValues) *
+                                 COUNT(ionValues) * COUNT(swingHValues) * COUNT(swingVValues) *
+                                 (maxTemperature - minTemperature + 1);
+
+// State number n, counted in mixed radix over all fields
+static SharpState stateAt(size_t n) {
+    SharpState state;
+    state.temperature = minTemperature + static_cast<int>(n % (maxTemperature - minTemperature + 1));
+    n /= maxTemperature - minTemperature + 1;
+    state.swingV = swingVValues[n % COUNT(swingVValues)];
+    n /= COUNT(swingVValues);
+    state.swingH = swingHValues[n % COUNT(swingHValues)];
+    n /= COUNT(swingHValues);
+    state.ion = ionValues[n % COUNT(ionValues)];
+    n /= COUNT(ionValues);
+    state.preset = presetValues[n % COUNT(presetValues)];
+    n /= COUNT(presetValues);
+    state.fan = fanValues[n % COUNT(fanValues)];
+    n /= COUNT(fanValues);
+    state.mode = modeValues[n % COUNT(modeValues)];
+    n /= COUNT(modeValues);
+    state.state = powerValues[n % COUNT(powerValues)];
+    return state;
+}
+
+static FanMode expectedFan(const SharpState& state) {
+    if (state.mode == PowerMode::fan && state.fan == FanMode::auto_fan) return FanMode::low;
+    if (state.preset == Preset::FULLPOWER) return FanMode::auto_fan;
+    return state.fan;
+}
+
+enum Field { power, mode, fan, preset, ion, swingH, swingV, temperature, checksum, FieldCount };
+
+static const char* const fieldNames[FieldCount] = {"power",        "mode",         "fan",
+                                                   "preset",       "ion",          "horizontal vane",
+                                                   "vertical vane", "temperature", "checksum"};
+
+// Bit per field that did not survive the trip
+static uint32_t compare(const SharpState& state, SharpModeFrame& decoded) {
+    uint32_t mismatch = 0;
+    if (decoded.getState() != state.state) mismatch |= 1 << power;
+    if (decoded.getPowerMode() != state.mode) mismatch |= 1 << mode;
+    if (decoded.getFanMode() != expectedFan(state)) mismatch |= 1 << fan;
+    if (decoded.getPreset() != state.preset) mismatch |= 1 << preset;
+    if (decoded.getIon() != state.ion) mismatch |= 1 << ion;
+    if (decoded.getSwingHorizontal() != state.swingH) mismatch |= 1 << swingH;
+    if (decoded.getSwingVertical() != state.swingV) mismatch |= 1 << swingV;
+    if ((state.mode == PowerMode::cool || state.mode == PowerMode::heat) &&
+        decoded.getTemperature() != state.temperature)
+        mismatch |= 1 << temperature;
+    if (!decoded.validateChecksum()) mismatch |= 1 << checksum;
+    return mismatch;
+}
+
+// Fields that have to fail for every state they are checked in
+static const uint32_t expectedFailures = 1 << temperature;
+
+static bool checked(const SharpState& state, int field) {
+    return field != temperature || state.mode == PowerMode::cool || state.mode == PowerMode::heat;
+}
+
+static void printState(const SharpState& state) {
+    printf("power %d mode 0x%x fan 0x%x preset %d ion %d vanes 0x%x/0x%x %d°C", state.state,
+           static_cast<int>(state.mode), static_cast<int>(state.fan), static_cast<int>(state.preset), state.ion,
+           static_cast<int>(state.swingH), static_cast<int>(state.swingV), state.temperature);
+}
+
+int main() {
+    printf("\n╔════════════════════════════════════════════════════╗\n");
+    printf("║   Sharp AC Command Frame Round Trip               ║\n");
+    printf("╚════════════════════════════════════════════════════╝\n");
+    printf("\n  %zu states\n", stateCount);
+
+    uint32_t mismatches[FieldCount] = {};
+    uint32_t checks[FieldCount] = {};
+    size_t failed = 0;
+    const size_t examplesShown = 5;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < stateCount; n++) {
+        SharpState state = stateAt(n);
+        SharpCommandFrame command = state.toFrame();
+        command.setChecksum();
+
+        SharpModeFrame decoded(command.getData());
+        uint32_t mismatch = compare(state, decoded);
+        for (int field = 0; field < FieldCount; field++) {
+            if (checked(state, field)) checks[field]++;
+            if (mismatch & (1 << field)) mismatches[field]++;
+        }
+        if ((mismatch & ~expectedFailures) == 0) continue;
+
+        if (failed++ < examplesShown) {
+            printf("  ✗ ");
+            printState(state);
+            printf("\n    ");
+            for (size_t i = 0; i < command.getSize(); i++) printf("%02x ", command.getData()[i]);
+            printf("\n");
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("\n  %.1f ms, %.0f ns per encode + decode\n", seconds * 1000, seconds * 1e9 / stateCount);
+    bool fixed = false;
+    for (int field = 0; field < FieldCount; field++) {
+        if (expectedFailures & (1 << field)) {
+            printf("  %-16s %u of %u mismatches, expected\n", fieldNames[field], mismatches[field], checks[field]);
+            fixed |= mismatches[field] != checks[field];
+        } else if (mismatches[field]) {
+            printf("  %-16s %u mismatches\n", fieldNames[field], mismatches[field]);
+        }
+    }
+
+    if (failed > 0) {
+        printf("\n✗ %zu of %zu states did not survive the round trip\n\n", failed, stateCount);
+        return 1;
+    }
+    if (fixed) {
+        printf("\n✗ An expected failure no longer fails everywhere, update expectedFailures\n\n");
+        return 1;
+    }
+    // The whole space is meant to be cheap enough to run on every build
+    if (seconds >= 1.0) {
+        printf("\n✗ Round trip took %.2f s, more than a second\n\n", seconds);
+        return 1;
+    }
+    printf("\n✓ All states survived the round trip, apart from the expected failures\n\n");
+    return 0;
+}
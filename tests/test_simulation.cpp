@@ -0,0 +1,458 @@
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "core_logic.h"
+#include "simulator.h"
+#include "emulated_ac.h"
+#include "alloc_hook.h"
+
+using namespace esphome::sharp_ac;
+
+static const uint64_t SECOND = 1000000ULL;
+static const uint64_t MINUTE = 60 * SECOND;
+static const uint64_t HOUR = 60 * MINUTE;
+static const uint64_t DAY = 24 * HOUR;
+
+// ============================================================================
+// Test Utilities
+// ============================================================================
+
+struct SimRun {
+    Simulator sim;
+    EmulatedAc ac;
+    SharpAcCore core;
+
+    explicit SimRun(uint64_t seed) : sim(seed), core(&sim, &sim) {
+        ac.faults.delayMicros = 2000;
+        ac.faults.jitterMicros = 18000;
+        sim.attach(&core, &ac);
+        core.setup();
+    }
+};
+
+// Runs in loop interval steps until the AC has the target temperature,
+// returns the time it took or 0 if it did not converge within a minute
+static uint64_t converge_temperature(SimRun& run, int temperature) {
+    uint64_t start = run.sim.now();
+    run.core.controlTemperature(temperature);
+    while (run.sim.now() - start < MINUTE) {
+        run.sim.run(16000);
+        if (run.ac.state.temperature == temperature) {
+            return run.sim.now() - start;
+        }
+    }
+    return 0;
+}
+
+static void print_stats(const Simulator& sim, double wallMillis) {
+    const SimStats& stats = sim.getStats();
+    printf("  Simulated time:     %.1f h in %.1f ms wall time (%llu loop calls)\n",
+           sim.now() / 3600e6, wallMillis, (unsigned long long)stats.loops);
+    printf("  TX:                 %llu frames, %llu bytes\n",
+           (unsigned long long)stats.txFrames, (unsigned long long)stats.txBytes);
+    printf("  RX:                 %llu frames, %llu bytes\n",
+           (unsigned long long)stats.rxFrames, (unsigned long long)stats.rxBytes);
+    printf("  Polls:              %llu\n", (unsigned long long)stats.polls);
+    printf("  Connects:           %llu (reconnects %llu)\n",
+           (unsigned long long)stats.connects, (unsigned long long)stats.reconnects);
+    printf("  Response latency:   avg %llu us, min %llu us, max %llu us\n",
+           (unsigned long long)stats.responseLatency.averageMicros(),
+           (unsigned long long)stats.responseLatency.minMicros,
+           (unsigned long long)stats.responseLatency.maxMicros);
+    printf("  Time to connect:    avg %llu us, max %llu us\n",
+           (unsigned long long)stats.connectTime.averageMicros(),
+           (unsigned long long)stats.connectTime.maxMicros);
+}
+
+// ============================================================================
+// Simulation Tests
+// ============================================================================
+
+/**
+ * Test: Handshake Converges
+ * Verifies that the core connects to the simulated AC within a second
+ */
+bool test_sim_handshake() {
+    std::cout << "\n=== Test: Handshake Converges ===" << std::endl;
+
+    SimRun run(1);
+    bool passed = run.sim.runUntilConnected(SECOND);
+
+    const SimStats& stats = run.sim.getStats();
+    printf("  Connected after %llu us, %llu frames sent\n",
+           (unsigned long long)run.sim.now(), (unsigned long long)stats.txFrames);
+
+    passed &= (stats.connects == 1);
+    passed &= (stats.reconnects == 0);
+    passed &= (run.core.getCurrentTemperature() == 23.0f);
+    return passed;
+}
+
+/**
+ * Test: One Day Of Polling
+ * Runs 24 hours of protocol time and checks the 60 second poll cadence
+ */
+bool test_sim_one_day() {
+    std::cout << "\n=== Test: One Day Of Polling ===" << std::endl;
+
+    SimRun run(2);
+    auto start = std::chrono::steady_clock::now();
+    run.sim.run(DAY);
+    auto end = std::chrono::steady_clock::now();
+
+    print_stats(run.sim, std::chrono::duration<double, std::milli>(end - start).count());
+
+    const SimStats& stats = run.sim.getStats();
+    bool passed = true;
+    passed &= (run.sim.getStatus() == 8);
+    passed &= (stats.polls >= 1439 && stats.polls <= 1440);
+    passed &= (stats.connects == 1);
+    passed &= (stats.reconnects == 0);
+    passed &= (stats.responseLatency.minMicros >= 2000);
+    passed &= (stats.responseLatency.maxMicros < 100000);
+    return passed;
+}
+
+/**
+ * Test: Deterministic From Seed
+ * Verifies that a seed reproduces a run exactly and that another seed
+ * changes the timing
+ */
+bool test_sim_deterministic() {
+    std::cout << "\n=== Test: Deterministic From Seed ===" << std::endl;
+
+    SimRun a(42);
+    SimRun b(42);
+    SimRun c(43);
+    a.sim.run(6 * HOUR);
+    b.sim.run(6 * HOUR);
+    c.sim.run(6 * HOUR);
+
+    const SimStats& sa = a.sim.getStats();
+    const SimStats& sb = b.sim.getStats();
+    const SimStats& sc = c.sim.getStats();
+
+    bool passed = true;
+    passed &= (sa.loops == sb.loops);
+    passed &= (sa.txBytes == sb.txBytes);
+    passed &= (sa.rxBytes == sb.rxBytes);
+    passed &= (sa.responseLatency.totalMicros == sb.responseLatency.totalMicros);
+    passed &= (sa.responseLatency.totalMicros != sc.responseLatency.totalMicros);
+    return passed;
+}
+
+/**
+ * Test: Reconnect After Outage
+ * The AC stops answering for five minutes: the core times out and retries,
+ * then reconnects once the AC is back
+ */
+bool test_sim_outage() {
+    std::cout << "\n=== Test: Reconnect After Outage ===" << std::endl;
+
+    SimRun run(3);
+    bool passed = run.sim.runUntilConnected(SECOND);
+
+    run.sim.run(30 * MINUTE);
+    run.ac.online = false;
+    run.sim.run(5 * MINUTE);
+    passed &= (run.sim.getStatus() != 8);
+
+    uint64_t reconnects = run.sim.getStats().reconnects;
+    run.ac.online = true;
+    run.sim.run(30 * SECOND);
+
+    const SimStats& stats = run.sim.getStats();
+    printf("  Reconnects during outage: %llu\n", (unsigned long long)reconnects);
+
+    passed &= (reconnects >= 5);
+    passed &= (run.sim.getStatus() == 8);
+    passed &= (stats.connects == 2);
+    return passed;
+}
+
+/**
+ * Test: Commands And Remote Control
+ * Commands reach the emulated AC and remote control changes reach the core
+ */
+bool test_sim_commands() {
+    std::cout << "\n=== Test: Commands And Remote Control ===" << std::endl;
+
+    SimRun run(4);
+    bool passed = run.sim.runUntilConnected(SECOND);
+
+    uint64_t latency = converge_temperature(run, 19);
+    printf("  Temperature command applied after %llu us\n", (unsigned long long)latency);
+    passed &= (latency > 0 && latency < SECOND);
+    passed &= (run.ac.getStats().commands == 1);
+
+    run.core.controlFan(FanMode::high);
+    run.sim.run(SECOND);
+    passed &= (run.ac.state.fan == FanMode::high);
+
+    SharpState remote = run.ac.state;
+    remote.mode = PowerMode::heat;
+    remote.temperature = 27;
+    run.ac.remoteControl(run.sim, remote);
+    run.sim.run(SECOND);
+    passed &= (run.core.getState().mode == PowerMode::heat);
+    passed &= (run.core.getState().temperature == 27);
+    return passed;
+}
+
+/**
+ * Test: Line Conditions
+ * Runs a day per fault profile and reports how long connecting takes, how
+ * often the core reconnects and how fast commands reach the AC
+ */
+bool test_sim_line_conditions() {
+    std::cout << "\n=== Test: Line Conditions ===" << std::endl;
+
+    struct Profile {
+        const char* name;
+        uint32_t delayMicros;
+        uint32_t jitterMicros;
+        double byteDrop;
+        double bitFlip;
+        double duplicate;
+    };
+    const Profile profiles[] = {
+        {"clean", 5000, 0, 0.0, 0.0, 0.0},
+        {"slow + jitter", 50000, 200000, 0.0, 0.0, 0.0},
+        {"byte drop 0.1%", 5000, 5000, 0.001, 0.0, 0.0},
+        {"bit flip 0.1%", 5000, 5000, 0.0, 0.001, 0.0},
+        {"duplicates 5%", 5000, 5000, 0.0, 0.0, 0.05},
+        {"noisy (all)", 20000, 50000, 0.002, 0.002, 0.02},
+    };
+    const int commandsPerDay = 96;
+
+    bool passed = true;
+    printf("\n  %-16s %10s %10s %8s %12s %10s %8s\n", "Profile", "connect", "reconn/d", "polls",
+           "cmd avg", "cmd max", "lost");
+
+    for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+        const Profile& profile = profiles[p];
+        SimRun run(100 + p);
+        run.ac.faults.delayMicros = profile.delayMicros;
+        run.ac.faults.jitterMicros = profile.jitterMicros;
+        run.ac.faults.byteDrop = profile.byteDrop;
+        run.ac.faults.bitFlip = profile.bitFlip;
+        run.ac.faults.duplicate = profile.duplicate;
+
+        SimLatency command = {0, 0, 0, 0};
+        int lost = 0;
+        for (int i = 0; i < commandsPerDay; i++) {
+            run.sim.run(DAY / commandsPerDay - MINUTE);
+            uint64_t latency = converge_temperature(run, 18 + i % 10);
+            if (latency > 0) {
+                command.add(latency);
+            } else {
+                lost++;
+            }
+            run.sim.run(MINUTE - (latency ? latency : MINUTE));
+        }
+
+        const SimStats& stats = run.sim.getStats();
+        printf("  %-16s %8llums %10llu %8llu %10llums %8llums %8d\n", profile.name,
+               (unsigned long long)stats.connectTime.averageMicros() / 1000,
+               (unsigned long long)stats.reconnects, (unsigned long long)stats.polls,
+               (unsigned long long)command.averageMicros() / 1000,
+               (unsigned long long)command.maxMicros / 1000, lost);
+
+        // Even on a bad line the core must keep talking to the AC
+        passed &= (stats.connects >= 1);
+        passed &= (stats.polls > 1000);
+        if (p < 2) {
+            passed &= (stats.reconnects == 0);
+            passed &= (lost == 0);
+        }
+    }
+    return passed;
+}
+
+/**
+ * Test: Soak Across millis() Rollover
+ * Runs 60 days of protocol time. millis() wraps after ~49.7 days and
+ * micros() every ~71.6 minutes: polling must keep its cadence and no
+ * timeout may fire because of a wrap.
+ */
+bool test_sim_soak_rollover() {
+    std::cout << "\n=== Test: Soak Across millis() Rollover ===" << std::endl;
+
+    const uint64_t days = 60;
+    const uint64_t wrapMicros = (1ULL << 32) * 1000;
+
+    SimRun run(5);
+    AllocCounters startHeap = alloc_counters();
+    auto start = std::chrono::steady_clock::now();
+
+    // Day by day to watch the hours around the wrap separately
+    uint64_t reconnectsNearWrap = 0;
+    for (uint64_t day = 0; day < days; day++) {
+        uint64_t before = run.sim.getStats().reconnects;
+        run.sim.run(DAY);
+        if (run.sim.now() >= wrapMicros && run.sim.now() - wrapMicros < DAY) {
+            reconnectsNearWrap = run.sim.getStats().reconnects - before;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    AllocCounters endHeap = alloc_counters();
+    print_stats(run.sim, std::chrono::duration<double, std::milli>(end - start).count());
+
+    const SimStats& stats = run.sim.getStats();
+    long liveBlocks = static_cast<long>(endHeap.allocations - endHeap.frees) -
+                      static_cast<long>(startHeap.allocations - startHeap.frees);
+    printf("  Poll interval:      avg %.3f s, min %.3f s, max %.3f s\n",
+           stats.pollInterval.averageMicros() / 1e6, stats.pollInterval.minMicros / 1e6,
+           stats.pollInterval.maxMicros / 1e6);
+    printf("  Reconnects:         %llu (day of the wrap: %llu)\n",
+           (unsigned long long)stats.reconnects, (unsigned long long)reconnectsNearWrap);
+    printf("  Heap:               %lu allocations, %lu frees, %ld live blocks gained\n",
+           endHeap.allocations - startHeap.allocations, endHeap.frees - startHeap.frees, liveBlocks);
+    printf("  Core footprint:     %u bytes\n", (unsigned)sizeof(SharpAcCore));
+
+    bool passed = true;
+    passed &= (run.sim.getStatus() == 8);
+    passed &= (stats.connects == 1);
+    passed &= (stats.reconnects == 0);
+    passed &= (stats.polls >= days * 1440 - 2);
+    passed &= (stats.pollInterval.minMicros >= 59 * SECOND);
+    passed &= (stats.pollInterval.maxMicros <= 61 * SECOND);
+    passed &= (liveBlocks < 64);
+    return passed;
+}
+
+/**
+ * Test: Timeout Across The Wrap
+ * A request sent just before millis() wraps still times out after 10s:
+ * it is sent again twice, 10s apart, then the unit reconnects
+ */
+bool test_sim_timeout_at_wrap() {
+    std::cout << "\n=== Test: Timeout Across The Wrap ===" << std::endl;
+
+    SimRun run(6);
+    // Connecting polls right away, the next poll goes out 60s later,
+    // about 4.6s before millis() wraps
+    run.sim.setClockOffset((1ULL << 32) - 65000);
+    bool passed = run.sim.runUntilConnected(SECOND);
+    run.sim.run(SECOND);
+    run.ac.online = false;
+
+    // Just past the wrap
+    run.sim.run(65 * SECOND);
+    passed &= (run.sim.getStats().polls == 2);
+    passed &= (run.sim.getStats().reconnects == 0);
+
+    // 10s after the poll
+    run.sim.run(6 * SECOND);
+    passed &= (run.core.getTxStats().retried == 1);
+    passed &= (run.sim.getStats().reconnects == 0);
+
+    // 30s after the poll
+    run.sim.run(20 * SECOND);
+    passed &= (run.core.getTxStats().retried == 2);
+    passed &= (run.sim.getStats().reconnects == 1);
+    return passed;
+}
+
+/**
+ * Test: Node Scheduler Staggers Units
+ * Four units of one node share a scheduler: their handshakes start at
+ * least the spacing apart and their polls spread over the interval
+ */
+bool test_sim_node_staggered() {
+    std::cout << "\n=== Test: Node Scheduler Staggers Units ===" << std::endl;
+
+    const int UNITS = 4;
+    SharpAcScheduler scheduler;
+    std::vector<std::unique_ptr<SimRun>> runs;
+    bool passed = true;
+    for (int i = 0; i < UNITS; i++) {
+        runs.emplace_back(new SimRun(20 + i));
+        passed &= runs.back()->core.setScheduler(&scheduler);
+    }
+
+    // Lockstep in whole milliseconds, like cores on one clock
+    for (uint64_t t = 0; t < 5 * MINUTE; t += 1000) {
+        for (auto& run : runs) run->sim.run(1000);
+    }
+
+    std::vector<uint64_t> connected;
+    std::vector<uint64_t> phases;
+    for (int i = 0; i < UNITS; i++) {
+        const SimStats& stats = runs[i]->sim.getStats();
+        const SharpNodeUnitStats& unit = scheduler.getStats(i);
+        printf("  Unit %d: connected after %llu ms, last poll at %llu ms, %u requests, %u handshakes\n", i,
+               (unsigned long long)(stats.connectTime.maxMicros / 1000),
+               (unsigned long long)(runs[i]->sim.getLastPoll() / 1000), unit.requests, unit.handshakes);
+        passed &= (runs[i]->sim.getStatus() == 8);
+        passed &= (stats.connects == 1 && stats.reconnects == 0);
+        passed &= (unit.handshakes == 1 && unit.timeouts == 0);
+        connected.push_back(stats.connectTime.maxMicros);
+        phases.push_back(runs[i]->sim.getLastPoll() % MINUTE);
+    }
+
+    // Handshakes in slot order, each one after the previous has waited out the spacing
+    for (int i = 1; i < UNITS; i++) {
+        passed &= (connected[i] >= connected[i - 1] + 400000);
+    }
+    std::sort(phases.begin(), phases.end());
+    for (int i = 0; i < UNITS; i++) {
+        uint64_t gap = (phases[(i + 1) % UNITS] + MINUTE - phases[i]) % MINUTE;
+        passed &= (gap >= 14 * SECOND && gap <= 16 * SECOND);
+    }
+
+    printf("  Node: %u frames, response p50 %u us, p99 %u us, max %u us\n", scheduler.getFrames(),
+           scheduler.latencyPercentile(50), scheduler.latencyPercentile(99), scheduler.getMaxLatency());
+    passed &= (scheduler.latencyPercentile(50) >= 2000);
+    passed &= (scheduler.getMaxLatency() < 100000);
+    return passed;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║          Sharp AC Simulation Tests                           ║" << std::endl;
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    int passed = 0;
+    int total = 0;
+
+    #define RUN_TEST(test) \
+        total++; \
+        if (test()) { \
+            passed++; \
+            std::cout << "✓ Test passed\n"; \
+        } else { \
+            std::cout << "✗ Test FAILED\n"; \
+        }
+
+    RUN_TEST(test_sim_handshake);
+    RUN_TEST(test_sim_one_day);
+    RUN_TEST(test_sim_deterministic);
+    RUN_TEST(test_sim_outage);
+    RUN_TEST(test_sim_commands);
+    RUN_TEST(test_sim_line_conditions);
+    RUN_TEST(test_sim_soak_rollover);
+    RUN_TEST(test_sim_timeout_at_wrap);
+    RUN_TEST(test_sim_node_staggered);
+
+    std::cout << "\n╔══════════════════════════════════════════════════════════════╗" << std::endl;
+    printf("║  Tests Passed: %2d / %2d                                        ║\n", passed, total);
+    std::cout << "╚══════════════════════════════════════════════════════════════╝" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\n✓✓✓ All simulation tests passed! ✓✓✓\n" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n✗✗✗ Some simulation tests failed! ✗✗✗\n" << std::endl;
+        return 1;
+    }
+}
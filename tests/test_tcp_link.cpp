@@ -0,0 +1,359 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <netinet/tcp.h>
+
+#include "gateway.h"
+#include "host_tcp.h"
+#include "emulated_ac.h"
+#include "fd_line.h"
+
+// ============================================================================
+// Test Utilities
+// ============================================================================
+//
+// SharpTcpPort against a listening socket on the loopback interface that
+// stands in for a network serial bridge: every connection it accepts gets
+// an FdLine with the EmulatedAc behind it, like a pty master. Core, bridge
+// and AC take turns on one thread, on the wall clock.
+
+void print_test_header(const char* test_name) {
+    std::cout << "\n=== Test: " << test_name << " ===" << std::endl;
+}
+
+void print_test_result(const char* test_name, bool passed) {
+    if (passed) {
+        std::cout << "✓ " << test_name << " passed" << std::endl;
+    } else {
+        std::cout << "✗ " << test_name << " FAILED" << std::endl;
+    }
+}
+
+static uint64_t wallMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static const uint64_t connectTimeout = 10000000;
+
+class StatusCallback : public SharpAcStateCallback {
+public:
+    int status = 0;
+    void on_state_update() override {}
+    void on_ion_state_update(bool state) override { (void)state; }
+    void on_vane_horizontal_update(SwingHorizontal val) override { (void)val; }
+    void on_vane_vertical_update(SwingVertical val) override { (void)val; }
+    void on_connection_status_update(int status) override { this->status = status; }
+};
+
+// The bridge: one EmulatedAc per accepted connection, in accept order,
+// unless all connections share one AC
+struct BridgeStandIn {
+    uint16_t port = 0;
+    int listener;
+    std::vector<int> clients;
+    std::vector<std::unique_ptr<FdLine>> lines;
+    std::vector<std::unique_ptr<EmulatedAc>> acs;
+    EmulatedAc* shared = nullptr;
+
+    BridgeStandIn() : listener(openListener(port)) {}
+
+    ~BridgeStandIn() {
+        for (size_t i = 0; i < clients.size(); i++) {
+            if (clients[i] >= 0) close(clients[i]);
+        }
+        if (listener >= 0) close(listener);
+    }
+
+    std::string address() const { return "tcp://127.0.0.1:" + std::to_string(port); }
+
+    void service() {
+        int client;
+        while ((client = accept(listener, nullptr, nullptr)) >= 0) {
+            EmulatedAc* ac = shared;
+            if (ac == nullptr) {
+                acs.push_back(std::unique_ptr<EmulatedAc>(new EmulatedAc()));
+                ac = acs.back().get();
+            }
+            clients.push_back(client);
+            lines.push_back(std::unique_ptr<FdLine>(new FdLine(client, ac, clients.size())));
+        }
+        for (size_t i = 0; i < clients.size(); i++) {
+            if (clients[i] >= 0 && !lines[i]->service(0)) hangUp(i);
+        }
+    }
+
+    void hangUp(size_t index) {
+        close(clients[index]);
+        clients[index] = -1;
+    }
+};
+
+// ============================================================================
+// TCP Port Tests
+// ============================================================================
+
+/**
+ * Test 1: Core Over TCP
+ * Verifies the handshake and a command through SharpTcpPort, with Nagle
+ * off and every frame in a single send()
+ */
+bool test_core_over_tcp() {
+    print_test_header("Core Over TCP");
+
+    BridgeStandIn bridge;
+    EmulatedAc ac;
+    bridge.shared = &ac;
+    SharpTcpPort port;
+    bool passed = bridge.listener >= 0 && port.open("127.0.0.1", bridge.port);
+    if (!passed) std::cout << "  " << port.lastError() << std::endl;
+
+    int noDelay = 0;
+    socklen_t len = sizeof(noDelay);
+    passed &= getsockopt(port.getFd(), IPPROTO_TCP, TCP_NODELAY, &noDelay, &len) == 0 && noDelay != 0;
+
+    StatusCallback callback;
+    SharpAcCore core(&port, &callback);
+    core.setLineTiming(9600, 11);
+    core.setup();
+
+    uint64_t start = wallMicros();
+    while (passed && callback.status != 8 && wallMicros() - start < connectTimeout) {
+        core.loop();
+        bridge.service();
+        usleep(200);
+    }
+    passed &= (callback.status == 8);
+    passed &= ac.isConnected();
+    std::cout << "  Connected after " << (wallMicros() - start) / 1000 << " ms" << std::endl;
+
+    core.controlTemperature(27);
+    start = wallMicros();
+    while (passed && ac.state.temperature != 27 && wallMicros() - start < 2000000) {
+        core.loop();
+        bridge.service();
+        usleep(200);
+    }
+    passed &= (ac.state.temperature == 27);
+    passed &= (ac.getStats().corrupted == 0);
+
+    printf("  %u frames, %llu sends, %llu bytes\n", core.getTxStats().frames,
+           static_cast<unsigned long long>(port.sends), static_cast<unsigned long long>(port.bytesSent));
+    passed &= (port.sends == core.getTxStats().frames);
+    passed &= (port.dropped == 0);
+
+    print_test_result("Core Over TCP", passed);
+    return passed;
+}
+
+/**
+ * Test 2: Unreachable Bridge
+ * Verifies that open() reports a bridge that isn't listening and a bad
+ * address instead of leaving a half open port
+ */
+bool test_unreachable_bridge() {
+    print_test_header("Unreachable Bridge");
+
+    uint16_t freePort = 0;
+    int listener = openListener(freePort);
+    bool passed = listener >= 0;
+    close(listener);
+
+    SharpTcpPort port;
+    passed &= !port.open("127.0.0.1", freePort, 1000);
+    passed &= !port.isOpen();
+    passed &= (port.getFd() == -1);
+    passed &= (strstr(port.lastError(), "refused") != nullptr);
+    std::cout << "  " << port.lastError() << std::endl;
+
+    std::string host;
+    uint16_t number = 0;
+    passed &= SharpTcpPort::parseAddress("tcp://bridge.local:2000", host, number);
+    passed &= (host == "bridge.local" && number == 2000);
+    passed &= SharpTcpPort::parseAddress("[::1]:4001", host, number);
+    passed &= (host == "::1" && number == 4001);
+    passed &= !SharpTcpPort::parseAddress("/dev/ttyUSB0", host, number);
+    passed &= !SharpTcpPort::parseAddress("bridge:70000", host, number);
+    passed &= !SharpTcpPort::parseAddress("bridge:", host, number);
+
+    print_test_result("Unreachable Bridge", passed);
+    return passed;
+}
+
+/**
+ * Test 3: Bridge Reconnect
+ * Verifies that the port reconnects by itself after the bridge dropped
+ * the connection and the core keeps talking to the AC without a new
+ * handshake
+ */
+bool test_bridge_reconnect() {
+    print_test_header("Bridge Reconnect");
+
+    BridgeStandIn bridge;
+    EmulatedAc ac;
+    bridge.shared = &ac;
+    SharpTcpPort port;
+    port.reconnectMs = 50;
+    bool passed = bridge.listener >= 0 && port.open("127.0.0.1", bridge.port);
+
+    StatusCallback callback;
+    SharpAcCore core(&port, &callback);
+    core.setLineTiming(9600, 11);
+    core.setup();
+    uint64_t start = wallMicros();
+    while (passed && callback.status != 8 && wallMicros() - start < connectTimeout) {
+        core.loop();
+        bridge.service();
+        usleep(200);
+    }
+    passed &= (callback.status == 8);
+    uint32_t handshakes = ac.getStats().handshakes;
+
+    bridge.service();
+    bridge.hangUp(0);
+    start = wallMicros();
+    while (port.isConnected() && wallMicros() - start < 1000000) {
+        core.loop();
+        usleep(200);
+    }
+    passed &= !port.isConnected();
+    passed &= (port.getFd() == -1);
+    passed &= (port.millisUntilRetry() <= 50);
+    std::cout << "  Lost: " << port.lastError() << std::endl;
+
+    start = wallMicros();
+    while (passed && !(port.isConnected() && bridge.clients.size() == 2) && wallMicros() - start < 2000000) {
+        core.loop();
+        bridge.service();
+        usleep(200);
+    }
+    passed &= port.isConnected();
+    passed &= (port.reconnects == 1);
+    passed &= (port.getSockets() == 2);
+    std::cout << "  Reconnected after " << (wallMicros() - start) / 1000 << " ms" << std::endl;
+
+    core.controlTemperature(19);
+    start = wallMicros();
+    while (passed && ac.state.temperature != 19 && wallMicros() - start < 2000000) {
+        core.loop();
+        bridge.service();
+        usleep(200);
+    }
+    passed &= (ac.state.temperature == 19);
+    passed &= (callback.status == 8);
+    passed &= (ac.getStats().handshakes == handshakes);
+
+    print_test_result("Bridge Reconnect", passed);
+    return passed;
+}
+
+// ============================================================================
+// Gateway Tests
+// ============================================================================
+
+/**
+ * Test 4: Gateway On Bridges
+ * Verifies gateway units on TCP bridges: all connect, a dropped bridge
+ * doesn't keep the loop busy while it is down and its unit is back once
+ * the bridge accepts again
+ */
+bool test_gateway_on_bridges() {
+    print_test_header("Gateway On Bridges");
+
+    const int units = 8;
+    BridgeStandIn bridge;
+    Gateway gateway;
+    bool passed = bridge.listener >= 0 && gateway.ok();
+    for (int i = 0; i < units && passed; i++) {
+        GatewayUnit* unit = gateway.addTcpUnit("ac" + std::to_string(i), bridge.address());
+        passed &= unit != nullptr;
+        if (unit == nullptr) std::cout << "  " << gateway.lastError() << std::endl;
+        // The bridge accepts in the order the units connected
+        bridge.service();
+    }
+    passed &= (bridge.acs.size() == static_cast<size_t>(units));
+
+    auto run = [&](uint64_t micros) {
+        uint64_t loops = 0;
+        uint64_t end = wallMicros() + micros;
+        while (wallMicros() < end) {
+            loops += gateway.runOnce(1);
+            bridge.service();
+        }
+        return loops;
+    };
+
+    uint64_t start = wallMicros();
+    while (passed && gateway.connectedCount() < gateway.size() && wallMicros() - start < connectTimeout) run(10000);
+    passed &= (gateway.connectedCount() == gateway.size());
+    printf("  %zu / %d connected after %llu ms\n", gateway.connectedCount(), units,
+           static_cast<unsigned long long>((wallMicros() - start) / 1000));
+
+    SharpTcpPort* port3 = static_cast<SharpTcpPort*>(gateway.unit(3)->link.get());
+    port3->reconnectMs = 300;
+    bridge.hangUp(3);
+    run(100000);
+    passed &= !port3->isConnected();
+    passed &= (gateway.unit(3)->fd == -1);
+    uint64_t loops = run(150000);
+    printf("  %llu loop() calls in 150 ms with one bridge down\n", static_cast<unsigned long long>(loops));
+    passed &= (loops < 8);
+
+    start = wallMicros();
+    while (passed && !port3->isConnected() && wallMicros() - start < 2000000) run(10000);
+    passed &= port3->isConnected();
+    passed &= (gateway.unit(3)->fd == port3->getFd());
+
+    gateway.unit(3)->core.controlTemperature(18);
+    gateway.wake(gateway.unit(3));
+    start = wallMicros();
+    // The reconnected socket is the bridge's ninth client
+    while (passed && bridge.acs.back()->state.temperature != 18 && wallMicros() - start < 2000000) run(10000);
+    passed &= (bridge.acs.size() == static_cast<size_t>(units + 1));
+    passed &= (bridge.acs.back()->state.temperature == 18);
+    for (int i = 0; i < units; i++) {
+        if (i != 3) passed &= (gateway.unit(i)->status == 8 && gateway.unit(i)->reconnects == 0);
+    }
+    gateway.printStats(stdout);
+
+    print_test_result("Gateway On Bridges", passed);
+    return passed;
+}
+
+int main() {
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║     Sharp AC TCP Bridge Tests (loopback)                   ║" << std::endl;
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    int passed = 0;
+    int total = 0;
+
+    #define RUN_TEST(test_func) \
+        total++; \
+        if (test_func()) passed++;
+
+    RUN_TEST(test_core_over_tcp);
+    RUN_TEST(test_unreachable_bridge);
+    RUN_TEST(test_bridge_reconnect);
+    RUN_TEST(test_gateway_on_bridges);
+
+    std::cout << "\n╔════════════════════════════════════════════════════════════╗" << std::endl;
+    std::cout << "║                      Test Summary                          ║" << std::endl;
+    std::cout << "╠════════════════════════════════════════════════════════════╣" << std::endl;
+    printf("║  Tests Passed: %2d / %2d                                      ║\n", passed, total);
+    std::cout << "╚════════════════════════════════════════════════════════════╝" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\n✓✓✓ All tests passed! ✓✓✓\n" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n✗✗✗ Some tests failed! ✗✗✗\n" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,458 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "core_logic.h"
+#include "core_registry.h"
+#include "capture_log.h"
+
+// ============================================================================
+// Binary Capture Format
+// ============================================================================
+//
+// All integers little endian.
+//
+//   header   "SHCP" u8 version=1, u8[3] reserved, u64 start time (us)
+//   record   varint time delta (us) to the previous record or the start,
+//            u8 direction (bit 7 = TX) and length (1..127), bytes
+//   index    u64 record time (us), u64 file offset, for every
+//            BINARY_CAPTURE_INDEX_STRIDE-th record
+//   footer   u64 index offset, u32 index entries, "SHCI"
+//
+// A capture that was never closed has no footer, readers then scan it from
+// the start instead of seeking.
+
+const uint8_t BINARY_CAPTURE_VERSION = 1;
+const size_t BINARY_CAPTURE_HEADER_SIZE = 16;
+const size_t BINARY_CAPTURE_FOOTER_SIZE = 16;
+const size_t BINARY_CAPTURE_INDEX_ENTRY_SIZE = 16;
+const size_t BINARY_CAPTURE_MAX_RECORD = 127;
+const uint32_t BINARY_CAPTURE_INDEX_STRIDE = 64;
+
+namespace binary_capture {
+
+inline void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline void putU64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+inline uint64_t getU64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+// LEB128, returns the number of bytes written (at most 10)
+inline size_t putVarint(uint8_t* p, uint64_t v) {
+    size_t n = 0;
+    do {
+        uint8_t byte = v & 0x7F;
+        v >>= 7;
+        p[n++] = static_cast<uint8_t>(byte | (v ? 0x80 : 0));
+    } while (v);
+    return n;
+}
+
+// Returns the number of bytes read, 0 if the varint runs past end
+inline size_t getVarint(const uint8_t* p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (size_t n = 0; n < 10 && p + n < end; n++) {
+        v |= static_cast<uint64_t>(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) return n + 1;
+    }
+    return 0;
+}
+
+}  // namespace binary_capture
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+class BinaryCaptureWriter {
+public:
+    BinaryCaptureWriter() {}
+    ~BinaryCaptureWriter() { close(); }
+
+    bool open(const char* path, uint64_t startMicros) {
+        close();
+        file = fopen(path, "wb");
+        if (!file) return false;
+
+        uint8_t header[BINARY_CAPTURE_HEADER_SIZE] = {'S', 'H', 'C', 'P', BINARY_CAPTURE_VERSION};
+        binary_capture::putU64(header + 8, startMicros);
+        fwrite(header, 1, sizeof(header), file);
+        offset = sizeof(header);
+        last = startMicros;
+        records = 0;
+        index.clear();
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+    uint64_t getRecords() const { return records; }
+
+    // Frames longer than a record are split, times must not go backwards
+    void write(uint64_t micros, bool tx, const uint8_t* data, size_t len) {
+        if (!file) return;
+        if (micros < last) micros = last;
+
+        while (len > 0) {
+            size_t chunk = len < BINARY_CAPTURE_MAX_RECORD ? len : BINARY_CAPTURE_MAX_RECORD;
+            if (records % BINARY_CAPTURE_INDEX_STRIDE == 0) {
+                IndexEntry entry = {micros, offset};
+                index.push_back(entry);
+            }
+
+            uint8_t head[11];
+            size_t n = binary_capture::putVarint(head, micros - last);
+            head[n++] = static_cast<uint8_t>((tx ? 0x80 : 0x00) | chunk);
+            fwrite(head, 1, n, file);
+            fwrite(data, 1, chunk, file);
+
+            offset += n + chunk;
+            last = micros;
+            records++;
+            data += chunk;
+            len -= chunk;
+        }
+    }
+
+    // Writes the index and footer
+    void close() {
+        if (!file) return;
+
+        uint64_t indexOffset = offset;
+        for (size_t i = 0; i < index.size(); i++) {
+            uint8_t entry[BINARY_CAPTURE_INDEX_ENTRY_SIZE];
+            binary_capture::putU64(entry, index[i].micros);
+            binary_capture::putU64(entry + 8, index[i].offset);
+            fwrite(entry, 1, sizeof(entry), file);
+        }
+
+        uint8_t footer[BINARY_CAPTURE_FOOTER_SIZE];
+        binary_capture::putU64(footer, indexOffset);
+        binary_capture::putU32(footer + 8, static_cast<uint32_t>(index.size()));
+        memcpy(footer + 12, "SHCI", 4);
+        fwrite(footer, 1, sizeof(footer), file);
+
+        fclose(file);
+        file = nullptr;
+    }
+
+private:
+    struct IndexEntry {
+        uint64_t micros;
+        uint64_t offset;
+    };
+
+    FILE* file = nullptr;
+    uint64_t offset = 0;
+    uint64_t last = 0;
+    uint64_t records = 0;
+    std::vector<IndexEntry> index;
+
+    BinaryCaptureWriter(const BinaryCaptureWriter&);
+    BinaryCaptureWriter& operator=(const BinaryCaptureWriter&);
+};
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+class BinaryCaptureReader {
+public:
+    BinaryCaptureReader() {}
+    ~BinaryCaptureReader() { close(); }
+
+    // True if the file starts with the binary capture magic
+    static bool isBinaryCapture(const char* path) {
+        FILE* file = fopen(path, "rb");
+        if (!file) return false;
+        char magic[4] = {0};
+        size_t n = fread(magic, 1, sizeof(magic), file);
+        fclose(file);
+        return n == 4 && memcmp(magic, "SHCP", 4) == 0;
+    }
+
+    bool open(const char* path) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < BINARY_CAPTURE_HEADER_SIZE) {
+            ::close(fd);
+            return false;
+        }
+        size = st.st_size;
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+        base = static_cast<const uint8_t*>(map);
+
+        if (memcmp(base, "SHCP", 4) != 0 || base[4] != BINARY_CAPTURE_VERSION) {
+            close();
+            return false;
+        }
+        start = binary_capture::getU64(base + 8);
+        recordsEnd = base + size;
+        indexEntries = 0;
+
+        // Closed captures end in an index
+        if (size >= BINARY_CAPTURE_HEADER_SIZE + BINARY_CAPTURE_FOOTER_SIZE) {
+            const uint8_t* footer = base + size - BINARY_CAPTURE_FOOTER_SIZE;
+            uint64_t indexOffset = binary_capture::getU64(footer);
+            uint32_t entries = binary_capture::getU32(footer + 8);
+            if (memcmp(footer + 12, "SHCI", 4) == 0 && indexOffset >= BINARY_CAPTURE_HEADER_SIZE &&
+                indexOffset + static_cast<uint64_t>(entries) * BINARY_CAPTURE_INDEX_ENTRY_SIZE ==
+                    size - BINARY_CAPTURE_FOOTER_SIZE) {
+                recordsEnd = base + indexOffset;
+                index = base + indexOffset;
+                indexEntries = entries;
+            }
+        }
+        rewind();
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(const_cast<uint8_t*>(base), size);
+        base = nullptr;
+        size = 0;
+        index = nullptr;
+        indexEntries = 0;
+    }
+
+    bool isIndexed() const { return indexEntries > 0; }
+    uint32_t getIndexEntries() const { return indexEntries; }
+    uint64_t getStartMicros() const { return start; }
+
+    // Time and file offset of an index entry, for splitting the capture
+    uint64_t indexTime(uint32_t i) const { return binary_capture::getU64(index + i * BINARY_CAPTURE_INDEX_ENTRY_SIZE); }
+    uint64_t indexOffset(uint32_t i) const {
+        return binary_capture::getU64(index + i * BINARY_CAPTURE_INDEX_ENTRY_SIZE + 8);
+    }
+
+    void rewind() {
+        pos = base + BINARY_CAPTURE_HEADER_SIZE;
+        time = start;
+        limit = recordsEnd;
+    }
+
+    // Reads records from offset up to endOffset (0: to the end), the first
+    // one at the given absolute time. Offsets must come from the index.
+    void range(uint64_t offset, uint64_t micros, uint64_t endOffset = 0) {
+        pos = base + offset;
+        time = micros;
+        limit = endOffset ? base + endOffset : recordsEnd;
+        firstOfRange = true;
+    }
+
+    // Positions before the first record at or after micros: binary search
+    // over the index, then at most one stride of records
+    void seek(uint64_t micros) {
+        if (indexEntries == 0) {
+            rewind();
+        } else {
+            uint32_t lo = 0, hi = indexEntries;
+            while (hi - lo > 1) {
+                uint32_t mid = lo + (hi - lo) / 2;
+                if (indexTime(mid) <= micros) lo = mid;
+                else hi = mid;
+            }
+            range(indexOffset(lo), indexTime(lo));
+        }
+
+        const uint8_t* savedPos = pos;
+        uint64_t savedTime = time;
+        bool savedFirst = firstOfRange;
+        CaptureFrame frame;
+        while (next(frame) && frame.timeMicros < micros) {
+            savedPos = pos;
+            savedTime = time;
+            savedFirst = false;
+        }
+        pos = savedPos;
+        time = savedTime;
+        firstOfRange = savedFirst;
+    }
+
+    // Next record, false at the end or on a truncated record
+    bool next(CaptureFrame& frame) {
+        if (pos >= limit) return false;
+        uint64_t delta;
+        size_t n = binary_capture::getVarint(pos, limit, delta);
+        if (n == 0 || pos + n >= limit) return false;
+        uint8_t head = pos[n];
+        size_t len = head & 0x7F;
+        const uint8_t* data = pos + n + 1;
+        if (len == 0 || data + len > limit) return false;
+
+        // Index entries hold the time of their record itself
+        if (firstOfRange) firstOfRange = false;
+        else time += delta;
+
+        frame.timeMicros = time;
+        frame.timed = true;
+        frame.tx = (head & 0x80) != 0;
+        frame.bytes.assign(data, data + len);
+        pos = data + len;
+        return true;
+    }
+
+private:
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    const uint8_t* recordsEnd = nullptr;
+    const uint8_t* index = nullptr;
+    uint32_t indexEntries = 0;
+    uint64_t start = 0;
+
+    const uint8_t* pos = nullptr;
+    const uint8_t* limit = nullptr;
+    uint64_t time = 0;
+    bool firstOfRange = false;
+
+    BinaryCaptureReader(const BinaryCaptureReader&);
+    BinaryCaptureReader& operator=(const BinaryCaptureReader&);
+};
+
+// Text log or binary capture, whichever the file is
+inline bool loadCapture(const char* path, std::vector<CaptureFrame>& frames) {
+    if (!BinaryCaptureReader::isBinaryCapture(path)) return loadCaptureLog(path, frames);
+
+    BinaryCaptureReader reader;
+    if (!reader.open(path)) return false;
+    CaptureFrame frame;
+    while (reader.next(frame)) frames.push_back(frame);
+    return true;
+}
+
+// ============================================================================
+// Tracing Decorator
+// ============================================================================
+//
+// Wraps the hardware interface of a SharpAcCore and records its traffic.
+// Every write is one TX record. Received bytes are cut into RX records
+// with the message registry the parser uses. Bytes that match no frame
+// are recorded once a read comes back empty, the idle signal the parser
+// uses to end a frame, or when the core writes.
+
+class TracingHardwareInterface : public esphome::sharp_ac::SharpAcHardwareInterface {
+public:
+    TracingHardwareInterface(esphome::sharp_ac::SharpAcHardwareInterface* inner, BinaryCaptureWriter* writer)
+        : inner(inner), writer(writer) {}
+
+    ~TracingHardwareInterface() override { flushRx(); }
+
+    size_t read_array(uint8_t* data, size_t len) override {
+        size_t count = inner->read_array(data, len);
+        if (count == 0) flushRx();
+        else received(data, count);
+        return count;
+    }
+
+    size_t available() override { return inner->available(); }
+
+    void write_array(const uint8_t* data, size_t len) override {
+        flushRx();
+        writer->write(now(), true, data, len);
+        inner->write_array(data, len);
+    }
+
+    uint8_t peek() override { return inner->peek(); }
+
+    uint8_t read() override {
+        uint8_t value = inner->read();
+        received(&value, 1);
+        return value;
+    }
+
+    unsigned long get_millis() override { return inner->get_millis(); }
+    unsigned long get_micros() override { return inner->get_micros(); }
+
+    void log_debug(const char* tag, const char* format, ...) override {
+        char message[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(message, sizeof(message), format, args);
+        va_end(args);
+        inner->log_debug(tag, "%s", message);
+    }
+
+    bool log_debug_enabled() override { return inner->log_debug_enabled(); }
+
+    std::string format_hex_pretty(const uint8_t* data, size_t len) override {
+        return inner->format_hex_pretty(data, len);
+    }
+
+    // Records bytes still waiting for the end of their frame
+    void flushRx() {
+        if (rxLength == 0) return;
+        writer->write(rxTime, false, rxBuffer, rxLength);
+        rxLength = 0;
+    }
+
+private:
+    esphome::sharp_ac::SharpAcHardwareInterface* inner;
+    BinaryCaptureWriter* writer;
+
+    uint8_t rxBuffer[BINARY_CAPTURE_MAX_RECORD];
+    size_t rxLength = 0;
+    uint64_t rxTime = 0;
+
+    // micros() wraps at 32 bits, the capture keeps counting
+    uint32_t lastMicros = 0;
+    uint64_t micros64 = 0;
+    bool started = false;
+
+    uint64_t now() {
+        uint32_t micros = static_cast<uint32_t>(inner->get_micros());
+        if (started) micros64 += static_cast<uint32_t>(micros - lastMicros);
+        else micros64 = micros;
+        started = true;
+        lastMicros = micros;
+        return micros64;
+    }
+
+    void received(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            if (rxLength == sizeof(rxBuffer)) flushRx();
+            if (rxLength == 0) rxTime = now();
+            rxBuffer[rxLength++] = data[i];
+            splitFrames();
+        }
+    }
+
+    void splitFrames() {
+        using esphome::sharp_ac::SharpMessageRegistry;
+        if (rxLength < SharpMessageRegistry::headerBytes(rxBuffer[0])) return;
+        uint8_t slot = SharpMessageRegistry::find(rxBuffer, rxLength);
+        if (slot == SHARP_NO_HANDLER) return;
+        size_t frameLength = SharpMessageRegistry::frameLength(slot, rxBuffer);
+        if (frameLength == 0 || frameLength > rxLength) return;
+
+        writer->write(rxTime, false, rxBuffer, frameLength);
+        rxLength -= frameLength;
+        memmove(rxBuffer, rxBuffer + frameLength, rxLength);
+        rxTime = now();
+    }
+};
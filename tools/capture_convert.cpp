@@ -0,0 +1,105 @@
+// Converts DEBUG capture logs to the binary capture format and back
+//
+//   capture_convert capture.log capture.bin
+//   capture_convert --dump [--from HH:MM:SS] capture.bin
+//
+// --dump prints a binary capture as RX:/TX: log lines, starting at the
+// first record at or after --from, found through the capture's index.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "binary_capture.h"
+
+static void printFrame(const CaptureFrame& frame) {
+    uint64_t ms = frame.timeMicros / 1000;
+    printf("[%02llu:%02llu:%02llu.%03llu] %s: ", static_cast<unsigned long long>(ms / 3600000 % 24),
+           static_cast<unsigned long long>(ms / 60000 % 60), static_cast<unsigned long long>(ms / 1000 % 60),
+           static_cast<unsigned long long>(ms % 1000), frame.tx ? "TX" : "RX");
+    if (!frame.tx && frame.bytes.size() == 1 && frame.bytes[0] == 0x06) {
+        printf("ACK\n");
+        return;
+    }
+    SharpFrame hex(frame.bytes.data(), frame.bytes.size());
+    char text[SHARP_HEX_BUFFER_SIZE];
+    hex.formatHex(text, sizeof(text));
+    printf("%s\n", text);
+}
+
+static int dump(const char* path, const char* from) {
+    BinaryCaptureReader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "capture_convert: %s is not a binary capture\n", path);
+        return 2;
+    }
+
+    if (from) {
+        char line[32];
+        snprintf(line, sizeof(line), "[%s]", from);
+        uint64_t micros;
+        if (!capture_log::parseTime(line, micros)) {
+            fprintf(stderr, "capture_convert: bad time %s\n", from);
+            return 2;
+        }
+        // The capture may span days, seek within its first one
+        uint64_t day = 24ULL * 3600ULL * 1000000ULL;
+        micros += reader.getStartMicros() / day * day;
+        if (micros < reader.getStartMicros()) micros += day;
+        reader.seek(micros);
+    }
+
+    CaptureFrame frame;
+    while (reader.next(frame)) printFrame(frame);
+    return 0;
+}
+
+static int convert(const char* in, const char* out) {
+    std::vector<CaptureFrame> frames;
+    if (!loadCaptureLog(in, frames)) {
+        fprintf(stderr, "capture_convert: cannot read %s\n", in);
+        return 2;
+    }
+
+    uint64_t start = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (frames[i].timed) {
+            start = frames[i].timeMicros;
+            break;
+        }
+    }
+
+    BinaryCaptureWriter writer;
+    if (!writer.open(out, start)) {
+        fprintf(stderr, "capture_convert: cannot write %s\n", out);
+        return 2;
+    }
+    // Untimed lines keep the time of the line before them
+    uint64_t last = start;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (frames[i].timed) last = frames[i].timeMicros;
+        writer.write(last, frames[i].tx, frames[i].bytes.data(), frames[i].bytes.size());
+    }
+    uint64_t records = writer.getRecords();
+    writer.close();
+
+    printf("%s: %zu frames, %llu records\n", out, frames.size(), static_cast<unsigned long long>(records));
+    return 0;
+}
+
+static int usage() {
+    fprintf(stderr,
+            "usage: capture_convert capture.log capture.bin\n"
+            "       capture_convert --dump [--from HH:MM:SS] capture.bin\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "--dump") == 0) {
+        if (argc == 3) return dump(argv[2], nullptr);
+        if (argc == 5 && strcmp(argv[2], "--from") == 0) return dump(argv[4], argv[3]);
+        return usage();
+    }
+    if (argc == 3) return convert(argv[1], argv[2]);
+    return usage();
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// ============================================================================
+// UART Capture Logs
+// ============================================================================
+//
+// Reads the RX:/TX: frame lines the component logs at DEBUG level:
+//
+//   [12:34:56][D][sharp_ac.climate:081]: TX: DD.02.FD.62.9F (5)
+//   [12:34:56.789][D][sharp_ac.climate:243]: RX: ACK
+//   RX: 0xDC 0x0B 0xFC ...
+//   [12:40:00][I][sharp_ac:412]: @2000 RX: DC.0B.FC... (14)
+//
+// Frames are ESPHome's format_hex_pretty layout or space separated 0x bytes.
+// The [HH:MM:SS(.mmm)] prefix is optional, any other line is skipped.
+// Frame trace dumps carry the device millis() of each frame after an "@",
+// which is used instead of the time the dump was logged.
+
+struct CaptureFrame {
+    // Time of day from the log prefix, valid if timed
+    uint64_t timeMicros;
+    bool timed;
+    bool tx;
+    std::vector<uint8_t> bytes;
+};
+
+namespace capture_log {
+
+inline int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// "[HH:MM:SS]" or "[HH:MM:SS.mmm]" at the start of the line
+inline bool parseTime(const char* line, uint64_t& micros) {
+    unsigned h, m, s, ms = 0;
+    int n = 0;
+    if (sscanf(line, "[%2u:%2u:%2u%n", &h, &m, &s, &n) != 3) return false;
+    if (line[n] == '.') {
+        int n2 = 0;
+        if (sscanf(line + n, ".%3u%n", &ms, &n2) != 1) return false;
+        n += n2;
+    }
+    if (line[n] != ']') return false;
+    micros = ((h * 3600ULL + m * 60ULL + s) * 1000ULL + ms) * 1000ULL;
+    return true;
+}
+
+// Hex bytes up to the end of the line or a " (len)" suffix
+inline bool parseBytes(const char* p, std::vector<uint8_t>& bytes) {
+    bytes.clear();
+    while (*p) {
+        while (*p == ' ' || *p == '.') p++;
+        if (*p == '\0' || *p == '\r' || *p == '\n' || *p == '(') break;
+        if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+        int hi = hexDigit(p[0]);
+        int lo = hi < 0 ? -1 : hexDigit(p[1]);
+        if (lo < 0) return false;
+        bytes.push_back(static_cast<uint8_t>(hi << 4 | lo));
+        p += 2;
+        if (*p && *p != ' ' && *p != '.' && *p != '\r' && *p != '\n') return false;
+    }
+    return !bytes.empty();
+}
+
+}  // namespace capture_log
+
+// One log line, false if it does not carry a frame
+inline bool parseCaptureLine(const char* line, CaptureFrame& frame) {
+    const char* rx = strstr(line, "RX: ");
+    const char* tx = strstr(line, "TX: ");
+    const char* tag = rx && (!tx || rx < tx) ? rx : tx;
+    if (!tag) return false;
+
+    frame.tx = tag == tx;
+    frame.timed = capture_log::parseTime(line, frame.timeMicros);
+    if (!frame.timed) frame.timeMicros = 0;
+
+    // "@<millis> " right in front of the tag
+    const char* p = tag;
+    while (p > line && p[-1] == ' ') p--;
+    const char* digits = p;
+    while (digits > line && isdigit(static_cast<unsigned char>(digits[-1]))) digits--;
+    if (digits < p && digits > line && digits[-1] == '@') {
+        frame.timeMicros = strtoull(digits, nullptr, 10) * 1000ULL;
+        frame.timed = true;
+    }
+
+    const char* payload = tag + 4;
+    if (strncmp(payload, "ACK", 3) == 0) {
+        frame.bytes.assign(1, 0x06);
+        return true;
+    }
+    return capture_log::parseBytes(payload, frame.bytes);
+}
+
+// All frames of a log file, in file order. Times of day are unrolled over
+// midnight so they only ever increase.
+inline bool loadCaptureLog(const char* path, std::vector<CaptureFrame>& frames) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[1024];
+    CaptureFrame frame;
+    uint64_t dayOffset = 0;
+    uint64_t last = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (!parseCaptureLine(line, frame)) continue;
+        if (frame.timed) {
+            frame.timeMicros += dayOffset;
+            if (frame.timeMicros + 3600ULL * 1000000ULL < last) {
+                dayOffset += 24ULL * 3600ULL * 1000000ULL;
+                frame.timeMicros += 24ULL * 3600ULL * 1000000ULL;
+            }
+            last = frame.timeMicros;
+        }
+        frames.push_back(frame);
+    }
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,398 @@
+#include "coro_session.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+
+uint64_t SharpCoroFrames::live = 0;
+uint64_t SharpCoroFrames::liveBytes = 0;
+uint64_t SharpCoroFrames::allocated = 0;
+
+static const int MAX_EVENTS = 64;
+// Frame gap in character times, SharpAcCore's default
+static const uint8_t FRAME_GAP = 4;
+
+static uint64_t monotonicMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Message constants leave out the checksum
+static SharpFrame messageFrame(const uint8_t* msg, size_t size) {
+    SharpFrame frame;
+    frame.setSize(size + 1);
+    memcpy(frame.getData(), msg, size);
+    frame.setChecksum();
+    return frame;
+}
+
+// ============================================================================
+// Session
+// ============================================================================
+
+SharpSession::SharpSession(SharpCoroLoop& loop, SharpAcHardwareInterface* link, SharpAcStateCallback* callback)
+    : loop(loop), link(link), callback(callback) {
+    setLineTiming(9600, 11);
+}
+
+void SharpSession::setLineTiming(uint32_t baudRate, uint8_t bitsPerChar) {
+    if (baudRate == 0 || bitsPerChar == 0) return;
+    parser.setTiming(bitsPerChar * 1000000UL / baudRate, FRAME_GAP);
+}
+
+SharpTask<void> SharpSession::run() {
+    for (;;) {
+        // Not inside the if: GCC 12 miscompiles a co_await in a condition
+        bool connected = co_await handshake();
+        if (connected) {
+            stats.connects++;
+            co_await serve();
+            stats.reconnects++;
+        }
+        // Like SharpAcCore after a timeout: start over right away, the
+        // next init_msg waits for its answer anyway
+        setStatus(0);
+    }
+}
+
+SharpTask<bool> SharpSession::handshake() {
+    setStatus(0);
+    parser.reset();
+    inboxCount = 0;
+    commandPending = false;
+
+    SharpRxFrame reply = co_await request(init_msg, sizeof(init_msg));
+    if (reply.getType() != SharpFrameType::handshake) co_return false;
+
+    setStatus(1);
+    reply = co_await request(init_msg2, sizeof(init_msg2));
+    if (reply.getType() != SharpFrameType::handshake) co_return false;
+
+    // Acknowledged, then followed by the subscription's answer
+    setStatus(2);
+    reply = co_await request(subscribe_msg, sizeof(subscribe_msg));
+    if (reply.getType() != SharpFrameType::ack) co_return false;
+    setStatus(3);
+    reply = co_await receive();
+    if (reply.getType() != SharpFrameType::handshake) co_return false;
+
+    setStatus(4);
+    reply = co_await request(subscribe_msg2, sizeof(subscribe_msg2));
+    if (reply.getType() != SharpFrameType::handshake) co_return false;
+
+    setStatus(5);
+    reply = co_await request(get_state, sizeof(get_state));
+    if (reply.getType() != SharpFrameType::mode_response) co_return false;
+    handle(reply);
+
+    setStatus(6);
+    reply = co_await request(get_status, sizeof(get_status));
+    if (reply.getType() != SharpFrameType::status_response) co_return false;
+    handle(reply);
+
+    setStatus(7);
+    reply = co_await request(connected_msg, sizeof(connected_msg));
+    if (reply.getType() != SharpFrameType::ack) co_return false;
+
+    setStatus(8);
+    co_return true;
+}
+
+SharpTask<bool> SharpSession::serve() {
+    uint64_t nextPoll = loop.now() + POLL_INTERVAL_MS * 1000ULL;
+    for (;;) {
+        co_await wait(nextPoll, true);
+
+        SharpRxFrame frame;
+        if (popFrame(frame)) {
+            // The AC reports changes made with the IR remote by itself
+            stats.unsolicited++;
+            handle(frame);
+        } else if (commandPending) {
+            commandPending = false;
+            SharpCommandFrame command = state.toFrame();
+            command.setChecksum();
+            uint64_t sent = loop.now();
+            SharpRxFrame reply = co_await request(command);
+            if (reply.getType() == SharpFrameType::none) co_return false;
+            stats.commands++;
+            if (reply.getType() == SharpFrameType::ack) {
+                stats.commandMicros = static_cast<uint32_t>(loop.now() - sent);
+                if (stats.commandMicros > stats.maxCommandMicros) stats.maxCommandMicros = stats.commandMicros;
+            } else {
+                handle(reply);
+            }
+        } else if (loop.now() >= nextPoll) {
+            nextPoll = loop.now() + POLL_INTERVAL_MS * 1000ULL;
+            stats.polls++;
+            SharpRxFrame reply = co_await request(get_status, sizeof(get_status));
+            if (reply.getType() == SharpFrameType::none) co_return false;
+            handle(reply);
+        }
+    }
+}
+
+SharpTask<SharpRxFrame> SharpSession::request(const uint8_t* msg, size_t size) {
+    co_return co_await request(messageFrame(msg, size));
+}
+
+// The frame's checksum is already set: SharpCommandFrame has its own and
+// would lose it as a plain SharpFrame
+SharpTask<SharpRxFrame> SharpSession::request(SharpFrame frame) {
+    write(frame);
+    stats.requests++;
+    co_return co_await receive();
+}
+
+// The next frame, or an empty one (type none) after RESPONSE_TIMEOUT_MS
+SharpTask<SharpRxFrame> SharpSession::receive() {
+    SharpRxFrame frame;
+    Wake reason = co_await wait(loop.now() + RESPONSE_TIMEOUT_MS * 1000ULL, false);
+    if (reason == Wake::frame) {
+        popFrame(frame);
+    } else {
+        stats.timeouts++;
+    }
+    co_return frame;
+}
+
+bool SharpSession::WaitAwaiter::await_ready() {
+    if (session.inboxCount > 0) {
+        session.wake = Wake::frame;
+        return true;
+    }
+    if (commands && session.commandPending) {
+        session.wake = Wake::command;
+        return true;
+    }
+    if (session.loop.now() >= deadline) {
+        session.wake = Wake::timeout;
+        return true;
+    }
+    return false;
+}
+
+void SharpSession::WaitAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    session.waiter = handle;
+    session.waitingForCommands = commands;
+    session.loop.arm(session, deadline);
+}
+
+void SharpSession::write(SharpFrame& frame) {
+    link->write_array(frame.getData(), frame.getSize());
+}
+
+void SharpSession::setStatus(int status) {
+    if (status == this->status) return;
+    this->status = status;
+    if (callback) callback->on_connection_status_update(status);
+}
+
+// Decoded as in SharpAcCore::onModeResponse() and onStatusResponse()
+void SharpSession::handle(SharpRxFrame& frame) {
+    if (status == 8 && frame.getSize() > 1) {
+        SharpACKFrame ack;
+        ack.setChecksum();
+        write(ack);
+    }
+
+    if (frame.getType() == SharpFrameType::mode_response) {
+        SharpModeFrame mode(frame.getData());
+        if (isKnown(mode.getFanMode())) state.fan = mode.getFanMode();
+        if (isKnown(mode.getPowerMode())) state.mode = mode.getPowerMode();
+        if (isKnown(mode.getSwingHorizontal())) state.swingH = mode.getSwingHorizontal();
+        if (isKnown(mode.getSwingVertical())) state.swingV = mode.getSwingVertical();
+        state.state = mode.getState();
+        state.preset = mode.getPreset();
+        state.ion = mode.getIon();
+        if (state.state && (state.mode == PowerMode::cool || state.mode == PowerMode::heat))
+            state.temperature = mode.getTemperature();
+    } else if (frame.getType() == SharpFrameType::status_response) {
+        SharpStatusFrame statusFrame(frame.getData());
+        currentTemperature = statusFrame.getTemperature();
+    } else {
+        return;
+    }
+
+    // No 0°C before the first status frame
+    if (callback && currentTemperature > 0.0f) {
+        callback->on_state_update();
+        callback->on_ion_state_update(state.ion);
+        callback->on_vane_horizontal_update(state.swingH);
+        callback->on_vane_vertical_update(state.swingV);
+    }
+}
+
+bool SharpSession::popFrame(SharpRxFrame& frame) {
+    if (inboxCount == 0) return false;
+    frame = inbox[inboxHead];
+    inboxHead = static_cast<uint8_t>((inboxHead + 1) % INBOX_SIZE);
+    inboxCount--;
+    return true;
+}
+
+void SharpSession::queueCommand() {
+    commandPending = true;
+    // Due at once: the loop resumes the session on its next pass instead
+    // of in the middle of the caller
+    if (waiter && waitingForCommands) loop.arm(*this, 0);
+}
+
+void SharpSession::controlMode(PowerMode mode, bool on) {
+    state.state = on;
+    if (on) state.mode = mode;
+    queueCommand();
+}
+
+void SharpSession::controlTemperature(int temperature) {
+    state.temperature = temperature;
+    queueCommand();
+}
+
+void SharpSession::controlFan(FanMode fan) {
+    state.fan = fan;
+    queueCommand();
+}
+
+void SharpSession::controlSwing(SwingHorizontal h, SwingVertical v) {
+    state.swingH = h;
+    state.swingV = v;
+    queueCommand();
+}
+
+void SharpSession::controlPreset(Preset preset) {
+    state.preset = preset;
+    queueCommand();
+}
+
+void SharpSession::pump(uint64_t now) {
+    uint8_t chunk[SHARP_MAX_FRAME_SIZE];
+    for (;;) {
+        SharpRxFrame frame = parser.next();
+        if (frame.getType() != SharpFrameType::none) {
+            if (inboxCount == INBOX_SIZE) {
+                // Nobody reads them: drop the oldest
+                inboxHead = static_cast<uint8_t>((inboxHead + 1) % INBOX_SIZE);
+                inboxCount--;
+                stats.overflows++;
+            }
+            inbox[(inboxHead + inboxCount) % INBOX_SIZE] = frame;
+            inboxCount++;
+            continue;
+        }
+
+        size_t len = parser.wanted();
+        size_t available = link->available();
+        if (len > available) len = available;
+        if (len == 0) break;
+        len = link->read_array(chunk, len);
+        if (len == 0) break;
+        parser.push(chunk, len, static_cast<uint32_t>(now));
+    }
+
+    if (waiter && inboxCount > 0) resume(Wake::frame);
+}
+
+void SharpSession::resume(Wake reason) {
+    if (!waiter) return;
+    std::coroutine_handle<> handle = waiter;
+    waiter = nullptr;
+    // Whatever timer is still queued for this wait is stale now
+    generation++;
+    wake = reason;
+    loop.resumes++;
+    handle.resume();
+}
+
+// ============================================================================
+// Loop
+// ============================================================================
+
+SharpCoroLoop::SharpCoroLoop() : startMicros(monotonicMicros()) {}
+
+SharpCoroLoop::~SharpCoroLoop() {
+    if (epollFd >= 0) close(epollFd);
+}
+
+void SharpCoroLoop::add(SharpSession& session) {
+    session.task = session.run();
+    session.task.start();
+}
+
+bool SharpCoroLoop::watch(SharpSession& session, int fd) {
+    if (epollFd < 0) epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) return false;
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = &session;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) return false;
+    session.fd = fd;
+    return true;
+}
+
+void SharpCoroLoop::arm(SharpSession& session, uint64_t due) {
+    session.generation++;
+    Timer timer = {due, session.generation, &session};
+    timers.push(timer);
+}
+
+void SharpCoroLoop::readable(SharpSession& session, uint64_t now) {
+    clock = now;
+    session.pump(now);
+}
+
+size_t SharpCoroLoop::runDue(uint64_t now) {
+    clock = now;
+    size_t count = 0;
+    while (!timers.empty() && timers.top().due <= now) {
+        Timer timer = timers.top();
+        timers.pop();
+        SharpSession& session = *timer.session;
+        if (timer.generation != session.generation || !session.waiter) continue;
+        // A frame cut short by an idle line is dropped before the session
+        // looks at its inbox
+        session.parser.checkGap(static_cast<uint32_t>(now));
+        count++;
+        session.resume(session.waitingForCommands && session.commandPending ? SharpSession::Wake::command
+                                                                             : SharpSession::Wake::timeout);
+    }
+    return count;
+}
+
+uint64_t SharpCoroLoop::nextDue() {
+    while (!timers.empty() && timers.top().generation != timers.top().session->generation) timers.pop();
+    return timers.empty() ? UINT64_MAX : timers.top().due;
+}
+
+int SharpCoroLoop::runOnce(int maxWaitMs) {
+    uint64_t resumed = resumes;
+    uint64_t now = monotonicMicros() - startMicros;
+    uint64_t due = nextDue();
+    int timeout = maxWaitMs;
+    if (due != UINT64_MAX) {
+        uint64_t wait = due > now ? (due - now + 999) / 1000 : 0;
+        if (wait < static_cast<uint64_t>(timeout)) timeout = static_cast<int>(wait);
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    int ready = epollFd >= 0 ? epoll_wait(epollFd, events, MAX_EVENTS, timeout) : 0;
+    if (epollFd < 0 && timeout > 0) usleep(static_cast<useconds_t>(timeout) * 1000);
+
+    now = monotonicMicros() - startMicros;
+    for (int i = 0; i < ready; i++) {
+        SharpSession& session = *static_cast<SharpSession*>(events[i].data.ptr);
+        readable(session, now);
+        if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+            // Level triggered, it would wake us forever. The session times
+            // out on its own.
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+            session.fd = -1;
+        }
+    }
+    runDue(now);
+    return static_cast<int>(resumes - resumed);
+}
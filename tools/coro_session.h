@@ -0,0 +1,277 @@
+#pragma once
+
+// C++20, host builds only: the component itself stays on C++11 and
+// SharpAcCore.
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "core_logic.h"
+
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Coroutine Sessions
+// ============================================================================
+//
+// The same protocol as SharpAcCore, written as one coroutine per unit:
+//
+//     reply = co_await request(subscribe_msg);
+//     if (reply.getType() != SharpFrameType::ack) co_return false;
+//
+// instead of a state machine spread over status, awaitingResponse and
+// timestamps. A suspended session is a few hundred bytes of coroutine
+// frame and no stack, so one thread can keep thousands of them waiting on
+// their links. Frame parsing, message constants and command encoding are
+// the core's (core_parser.h, core_messages.h, SharpState::toFrame()).
+//
+// SharpCoroLoop resumes a session when its link has a frame, when a
+// command was queued for it or when its timeout expires. Links are either
+// fds on the loop's epoll instance (runOnce()), or driven from outside
+// with readable() and runDue(), e.g. on a simulated clock.
+
+class SharpCoroLoop;
+class SharpSession;
+
+// Heap use of all live coroutine frames, for the per unit memory figures
+struct SharpCoroFrames {
+    static uint64_t live;
+    static uint64_t liveBytes;
+    static uint64_t allocated;
+};
+
+template <typename T>
+struct SharpTaskResult {
+    T value{};
+    void return_value(T result) { value = std::move(result); }
+    T take() { return std::move(value); }
+};
+
+template <>
+struct SharpTaskResult<void> {
+    void return_void() {}
+    void take() {}
+};
+
+// Lazily started coroutine whose result is co_awaited by its caller. The
+// caller resumes right where it left off when the task finishes (symmetric
+// transfer, no recursion on the stack however long the session runs).
+template <typename T>
+class SharpTask {
+public:
+    struct promise_type : SharpTaskResult<T> {
+        std::coroutine_handle<> continuation;
+
+        SharpTask get_return_object() { return SharpTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> done) noexcept {
+                std::coroutine_handle<> next = done.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(size_t size) {
+            SharpCoroFrames::live++;
+            SharpCoroFrames::liveBytes += size;
+            SharpCoroFrames::allocated++;
+            return ::operator new(size);
+        }
+        static void operator delete(void* frame, size_t size) {
+            SharpCoroFrames::live--;
+            SharpCoroFrames::liveBytes -= size;
+            ::operator delete(frame);
+        }
+    };
+
+    SharpTask() = default;
+    explicit SharpTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    SharpTask(SharpTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    SharpTask& operator=(SharpTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    SharpTask(const SharpTask&) = delete;
+    SharpTask& operator=(const SharpTask&) = delete;
+    ~SharpTask() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        handle.promise().continuation = caller;
+        return handle;
+    }
+    T await_resume() { return handle.promise().take(); }
+
+    // Runs a top level task up to its first suspension
+    void start() { handle.resume(); }
+    bool done() const { return !handle || handle.done(); }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+struct SharpSessionStats {
+    uint32_t requests = 0;
+    uint32_t timeouts = 0;
+    uint32_t connects = 0;
+    uint32_t reconnects = 0;
+    uint32_t commands = 0;
+    uint32_t polls = 0;
+    uint32_t unsolicited = 0;
+    // Frames that arrived while the inbox was full
+    uint32_t overflows = 0;
+    // Command frame written until the AC's ACK, last and worst
+    uint32_t commandMicros = 0;
+    uint32_t maxCommandMicros = 0;
+};
+
+class SharpSession {
+public:
+    // SharpAcCore's responseTimeout and interval
+    static const uint32_t RESPONSE_TIMEOUT_MS = 10000;
+    static const uint32_t POLL_INTERVAL_MS = 60000;
+
+    SharpSession(SharpCoroLoop& loop, SharpAcHardwareInterface* link, SharpAcStateCallback* callback = nullptr);
+    SharpSession(const SharpSession&) = delete;
+    SharpSession& operator=(const SharpSession&) = delete;
+
+    void setLineTiming(uint32_t baudRate, uint8_t bitsPerChar);
+
+    // Like SharpAcCore: change the wanted state, the session sends one
+    // command frame with all of it the next time it runs
+    void controlMode(PowerMode mode, bool on);
+    void controlTemperature(int temperature);
+    void controlFan(FanMode fan);
+    void controlSwing(SwingHorizontal h, SwingVertical v);
+    void controlPreset(Preset preset);
+
+    int getStatus() const { return status; }
+    const SharpState& getState() const { return state; }
+    float getCurrentTemperature() const { return currentTemperature; }
+    const SharpSessionStats& getStats() const { return stats; }
+    SharpAcHardwareInterface* getLink() { return link; }
+
+private:
+    friend class SharpCoroLoop;
+
+    enum class Wake { frame, command, timeout };
+
+    // co_await wait(deadline, commands): suspends until a frame is in the
+    // inbox, a command is queued (if commands) or the loop's clock passes
+    // deadline
+    struct WaitAwaiter {
+        SharpSession& session;
+        uint64_t deadline;
+        bool commands;
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> handle);
+        Wake await_resume() { return session.wake; }
+    };
+
+    SharpTask<void> run();
+    SharpTask<bool> handshake();
+    // false when the AC stopped answering
+    SharpTask<bool> serve();
+    SharpTask<SharpRxFrame> request(const uint8_t* msg, size_t size);
+    SharpTask<SharpRxFrame> request(SharpFrame frame);
+    SharpTask<SharpRxFrame> receive();
+    WaitAwaiter wait(uint64_t deadline, bool commands) { return WaitAwaiter{*this, deadline, commands}; }
+
+    void write(SharpFrame& frame);
+    void setStatus(int status);
+    // Decodes state and status frames, ACKs them once connected
+    void handle(SharpRxFrame& frame);
+    bool popFrame(SharpRxFrame& frame);
+    void queueCommand();
+
+    // Called by the loop
+    void pump(uint64_t now);
+    void resume(Wake reason);
+
+    SharpCoroLoop& loop;
+    SharpAcHardwareInterface* link;
+    SharpAcStateCallback* callback;
+    SharpFrameParser parser;
+    SharpTask<void> task;
+    std::coroutine_handle<> waiter;
+    bool waitingForCommands = false;
+    Wake wake = Wake::timeout;
+    // Timer entries with an older generation are stale
+    uint32_t generation = 0;
+    int fd = -1;
+
+    // Frames received but not yet looked at by the coroutine
+    static const int INBOX_SIZE = 4;
+    SharpRxFrame inbox[INBOX_SIZE];
+    uint8_t inboxHead = 0;
+    uint8_t inboxCount = 0;
+
+    int status = 0;
+    SharpState state;
+    float currentTemperature = 0.0f;
+    bool commandPending = false;
+    SharpSessionStats stats;
+};
+
+class SharpCoroLoop {
+public:
+    SharpCoroLoop();
+    ~SharpCoroLoop();
+
+    // Starts the session's coroutine: it sends init_msg right away. The
+    // session has to stay alive as long as the loop runs.
+    void add(SharpSession& session);
+    // Puts the session's link fd on the loop's epoll instance for
+    // runOnce(), false if it can't
+    bool watch(SharpSession& session, int fd);
+
+    // Driving from outside: the link has bytes, or time moved on. now is
+    // in microseconds on any monotonic clock, as long as it is the same
+    // for every call.
+    void readable(SharpSession& session, uint64_t now);
+    // Resumes every session whose deadline is <= now, returns how many
+    size_t runDue(uint64_t now);
+    // Earliest deadline, UINT64_MAX without one
+    uint64_t nextDue();
+
+    // Driving on real fds: waits up to maxWaitMs on epoll, on the
+    // monotonic clock counted from the loop's creation. Returns the number
+    // of sessions resumed.
+    int runOnce(int maxWaitMs);
+
+    // Time of the event being handled, what sessions measure against
+    uint64_t now() const { return clock; }
+    uint64_t getResumes() const { return resumes; }
+
+private:
+    friend class SharpSession;
+
+    struct Timer {
+        uint64_t due;
+        uint32_t generation;
+        SharpSession* session;
+        bool operator>(const Timer& other) const { return due > other.due; }
+    };
+
+    void arm(SharpSession& session, uint64_t due);
+
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    uint64_t clock = 0;
+    uint64_t startMicros;
+    uint64_t resumes = 0;
+    int epollFd = -1;
+};
@@ -0,0 +1,341 @@
+#include "gateway.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+
+#include "host_serial.h"
+
+// epoll user data: unit index, or this bit plus the watcher index
+static const uint64_t WATCHER_BIT = 1ULL << 32;
+static const int MAX_EVENTS = 64;
+// A unit that still has bytes to read runs again in the same pass, up to
+// this many times, so one chatty link can't starve the others
+static const int MAX_LOOPS_PER_RUN = 8;
+
+static uint64_t monotonicMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+void GatewayLatency::add(uint32_t micros) {
+    if (samples.size() < GATEWAY_LATENCY_SAMPLES) {
+        samples.push_back(micros);
+    } else {
+        samples[next] = micros;
+        next = (next + 1) % GATEWAY_LATENCY_SAMPLES;
+    }
+    count++;
+    if (micros > max) max = micros;
+}
+
+uint32_t GatewayLatency::percentile(double p) const {
+    if (samples.empty()) return 0;
+    std::vector<uint32_t> sorted(samples);
+    size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+size_t MeteredLink::read_array(uint8_t* data, size_t len) {
+    size_t count = link->read_array(data, len);
+    if (count > 0) {
+        rxBytes += count;
+        if (awaiting) {
+            response.add(static_cast<uint32_t>(link->get_micros()) - requestMicros);
+            awaiting = false;
+        }
+    }
+    return count;
+}
+
+uint8_t MeteredLink::read() {
+    uint8_t value = 0;
+    read_array(&value, 1);
+    return value;
+}
+
+void MeteredLink::write_array(const uint8_t* data, size_t len) {
+    // An ACK is not answered
+    if (!(len == 1 && data[0] == 0x06)) {
+        awaiting = true;
+        requestMicros = static_cast<uint32_t>(link->get_micros());
+    }
+    txFrames++;
+    link->write_array(data, len);
+}
+
+void MeteredLink::log_debug(const char* tag, const char* format, ...) {
+    if (!verbose) return;
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "[%s][%s] ", name.c_str(), tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+// ============================================================================
+// Units
+// ============================================================================
+
+GatewayUnit::GatewayUnit(const std::string& name, std::unique_ptr<SharpAcHardwareInterface> link, int fd)
+    : name(name), link(std::move(link)), fd(fd), metered(this->link.get(), name), core(&metered, this) {}
+
+void GatewayUnit::on_connection_status_update(int status) {
+    if (status == 8 && this->status != 8) connects++;
+    if (status == 0 && this->status == 8) reconnects++;
+    this->status = status;
+}
+
+// ============================================================================
+// Event Loop
+// ============================================================================
+
+Gateway::Gateway() : epollFd(epoll_create1(EPOLL_CLOEXEC)) {
+    if (epollFd < 0) error = std::string("epoll_create1: ") + strerror(errno);
+}
+
+Gateway::~Gateway() {
+    if (epollFd >= 0) close(epollFd);
+}
+
+GatewayUnit* Gateway::addUnit(const std::string& name, std::unique_ptr<SharpAcHardwareInterface> link, int fd) {
+    uint32_t index = static_cast<uint32_t>(units.size());
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = index;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        error = name + ": epoll_ctl: " + strerror(errno);
+        return nullptr;
+    }
+
+    units.push_back(std::unique_ptr<GatewayUnit>(new GatewayUnit(name, std::move(link), fd)));
+    GatewayUnit* unit = units.back().get();
+    unit->metered.verbose = verbose;
+    unit->core.setup();
+    schedule(index, monotonicMicros());
+    return unit;
+}
+
+GatewayUnit* Gateway::addTcpUnit(const std::string& name, const std::string& address, uint32_t baudRate) {
+    std::string host;
+    uint16_t port = 0;
+    if (!SharpTcpPort::parseAddress(address, host, port)) {
+        error = name + ": not host:port: " + address;
+        return nullptr;
+    }
+    std::unique_ptr<SharpTcpPort> bridge(new SharpTcpPort());
+    if (!bridge->open(host, port)) {
+        error = name + ": " + bridge->lastError();
+        return nullptr;
+    }
+    SharpTcpPort* tcp = bridge.get();
+    int fd = tcp->getFd();
+    GatewayUnit* unit = addUnit(name, std::move(bridge), fd);
+    if (unit != nullptr) {
+        unit->tcp = tcp;
+        unit->sockets = tcp->getSockets();
+        unit->events = EPOLLIN;
+        unit->core.setLineTiming(baudRate, 11);
+    }
+    return unit;
+}
+
+GatewayUnit* Gateway::addSerialUnit(const std::string& name, const char* path, uint32_t baudRate) {
+    std::unique_ptr<SharpSerialPort> port(new SharpSerialPort());
+    if (!port->open(path, baudRate)) {
+        error = name + ": " + port->lastError();
+        return nullptr;
+    }
+    int fd = port->getFd();
+    GatewayUnit* unit = addUnit(name, std::move(port), fd);
+    // 8E1: start bit + 8 data bits + parity + stop bit
+    if (unit != nullptr) unit->core.setLineTiming(baudRate, 11);
+    return unit;
+}
+
+bool Gateway::watch(int fd, std::function<void()> onReadable) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = WATCHER_BIT | watchers.size();
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        error = std::string("epoll_ctl: ") + strerror(errno);
+        return false;
+    }
+    Watcher watcher = {fd, onReadable};
+    watchers.push_back(watcher);
+    return true;
+}
+
+void Gateway::unwatch(int fd) {
+    for (size_t i = 0; i < watchers.size(); i++) {
+        if (watchers[i].fd == fd) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            watchers[i].fd = -1;
+            watchers[i].onReadable = nullptr;
+        }
+    }
+}
+
+GatewayUnit* Gateway::find(const std::string& name) {
+    for (size_t i = 0; i < units.size(); i++) {
+        if (units[i]->name == name) return units[i].get();
+    }
+    return nullptr;
+}
+
+size_t Gateway::connectedCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < units.size(); i++) {
+        if (units[i]->status == 8) count++;
+    }
+    return count;
+}
+
+void Gateway::schedule(uint32_t index, uint64_t now) {
+    GatewayUnit& unit = *units[index];
+    uint32_t millis = unit.core.millisUntilDue();
+    // 0 while a frame is in progress or the TX queue waits for a quiet
+    // line: check again in a millisecond, about one character time at
+    // 9600 baud, instead of spinning
+    if (unit.tcp != nullptr) {
+        uint32_t retry = unit.tcp->millisUntilRetry();
+        if (retry < millis) millis = retry == 0 ? 1 : retry;
+    }
+    if (millis == 0) {
+        unit.due = now + (unit.link->available() > 0 ? 0 : 1000);
+    } else {
+        unit.due = now + static_cast<uint64_t>(millis) * 1000;
+    }
+    unit.generation++;
+    Timer timer = {unit.due, unit.generation, index};
+    timers.push(timer);
+}
+
+void Gateway::wake(GatewayUnit* unit) {
+    for (uint32_t i = 0; i < units.size(); i++) {
+        if (units[i].get() == unit) schedule(i, monotonicMicros());
+    }
+}
+
+int Gateway::run(uint32_t index, uint64_t now, bool timer) {
+    GatewayUnit& unit = *units[index];
+    if (timer && now >= unit.due) unit.lateness.add(static_cast<uint32_t>(now - unit.due));
+
+    int loops = 0;
+    do {
+        unit.core.loop();
+        loops++;
+    } while (loops < MAX_LOOPS_PER_RUN && unit.link->available() > 0);
+    unit.loops += loops;
+
+    if (unit.tcp != nullptr) track(index);
+    schedule(index, monotonicMicros());
+    return loops;
+}
+
+void Gateway::track(uint32_t index) {
+    GatewayUnit& unit = *units[index];
+    int fd = unit.tcp->getFd();
+    uint32_t events = unit.tcp->wantsWrite() ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    bool replaced = fd != unit.fd || unit.tcp->getSockets() != unit.sockets;
+    if (!replaced && events == unit.events) return;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u64 = index;
+    if (replaced) {
+        // A closed socket already left the epoll set on its own
+        if (fd >= 0 && epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            fprintf(stderr, "%s: epoll_ctl: %s\n", unit.name.c_str(), strerror(errno));
+        }
+    } else if (fd >= 0) {
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+    }
+    unit.fd = fd;
+    unit.sockets = unit.tcp->getSockets();
+    unit.events = events;
+}
+
+int Gateway::runOnce(int maxWaitMs) {
+    uint64_t now = monotonicMicros();
+    while (!timers.empty() && timers.top().generation != units[timers.top().index]->generation) timers.pop();
+
+    int timeout = maxWaitMs;
+    if (!timers.empty()) {
+        uint64_t due = timers.top().due;
+        uint64_t wait = due > now ? (due - now + 999) / 1000 : 0;
+        if (wait < static_cast<uint64_t>(timeout)) timeout = static_cast<int>(wait);
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    int ready = epoll_wait(epollFd, events, MAX_EVENTS, timeout);
+    if (ready < 0) {
+        // EINTR: a signal, the caller checks why
+        return 0;
+    }
+
+    int loops = 0;
+    now = monotonicMicros();
+    for (int i = 0; i < ready; i++) {
+        uint64_t data = events[i].data.u64;
+        if (data & WATCHER_BIT) {
+            Watcher& watcher = watchers[static_cast<size_t>(data & ~WATCHER_BIT)];
+            if (watcher.onReadable) watcher.onReadable();
+            continue;
+        }
+
+        uint32_t index = static_cast<uint32_t>(data);
+        GatewayUnit& unit = *units[index];
+        loops += run(index, now, false);
+        // A TCP unit noticed the hangup itself and reconnects
+        if (unit.tcp == nullptr && (events[i].events & (EPOLLHUP | EPOLLERR))) {
+            // Level triggered, it would wake us forever. What was left to
+            // read went to the core above.
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, unit.fd, nullptr);
+            unit.linkDown = true;
+            fprintf(stderr, "%s: link hung up\n", unit.name.c_str());
+        }
+    }
+
+    now = monotonicMicros();
+    while (!timers.empty() && timers.top().due <= now) {
+        Timer timer = timers.top();
+        timers.pop();
+        if (timer.generation != units[timer.index]->generation) continue;
+        loops += run(timer.index, now, true);
+    }
+    return loops;
+}
+
+void Gateway::printStats(FILE* out) {
+    fprintf(out, "%-16s %-12s %8s %8s %8s %8s %10s %10s %8s\n", "unit", "status", "resp p50", "p99", "max",
+            "late p99", "loops", "rx bytes", "reconn");
+    for (size_t i = 0; i < units.size(); i++) {
+        GatewayUnit& unit = *units[i];
+        char status[16];
+        if (unit.linkDown) snprintf(status, sizeof(status), "link down");
+        else if (unit.tcp != nullptr && !unit.tcp->isConnected()) snprintf(status, sizeof(status), "bridge down");
+        else if (unit.status == 8) snprintf(status, sizeof(status), "connected");
+        else snprintf(status, sizeof(status), "connecting %d", unit.status);
+        fprintf(out, "%-16s %-12s %6.1fms %6.1fms %6.1fms %6.1fms %10llu %10llu %8u\n", unit.name.c_str(), status,
+                unit.metered.response.percentile(0.5) / 1000.0, unit.metered.response.percentile(0.99) / 1000.0,
+                unit.metered.response.getMax() / 1000.0, unit.lateness.percentile(0.99) / 1000.0,
+                static_cast<unsigned long long>(unit.loops), static_cast<unsigned long long>(unit.metered.rxBytes),
+                unit.reconnects);
+    }
+}
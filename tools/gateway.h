@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "core_logic.h"
+#include "host_tcp.h"
+
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Gateway
+// ============================================================================
+//
+// Many AC units on one Linux host, one thread: every unit is a SharpAcCore
+// on its own link (serial port or TCP bridge), and all links are multiplexed on a single
+// epoll instance with non-blocking I/O. Nothing polls: a unit's loop() runs
+// when its link has bytes, or when the shared scheduler says the core has
+// time driven work (status poll, response timeout), using
+// SharpAcCore::millisUntilDue(). Each unit keeps latency metrics.
+
+// Samples of the last GATEWAY_LATENCY_SAMPLES events, for percentiles
+const size_t GATEWAY_LATENCY_SAMPLES = 1024;
+
+class GatewayLatency {
+public:
+    void add(uint32_t micros);
+    // p in [0, 1] over the kept samples, 0 without samples
+    uint32_t percentile(double p) const;
+    uint32_t getMax() const { return max; }
+    uint64_t getCount() const { return count; }
+
+private:
+    std::vector<uint32_t> samples;
+    size_t next = 0;
+    uint64_t count = 0;
+    uint32_t max = 0;
+};
+
+// Sits between a core and its link and timestamps the traffic: the time
+// from writing a request until the first byte of the answer is the
+// response latency.
+class MeteredLink : public SharpAcHardwareInterface {
+public:
+    MeteredLink(SharpAcHardwareInterface* link, const std::string& name) : link(link), name(name) {}
+
+    size_t read_array(uint8_t* data, size_t len) override;
+    size_t available() override { return link->available(); }
+    void write_array(const uint8_t* data, size_t len) override;
+    uint8_t peek() override { return link->peek(); }
+    uint8_t read() override;
+    unsigned long get_millis() override { return link->get_millis(); }
+    unsigned long get_micros() override { return link->get_micros(); }
+    void log_debug(const char* tag, const char* format, ...) override;
+    bool log_debug_enabled() override { return verbose; }
+    std::string format_hex_pretty(const uint8_t* data, size_t len) override {
+        return link->format_hex_pretty(data, len);
+    }
+
+    GatewayLatency response;
+    uint64_t rxBytes = 0;
+    uint64_t txFrames = 0;
+    bool verbose = false;
+
+private:
+    SharpAcHardwareInterface* link;
+    std::string name;
+    bool awaiting = false;
+    uint32_t requestMicros = 0;
+};
+
+class GatewayUnit : public SharpAcStateCallback {
+public:
+    GatewayUnit(const std::string& name, std::unique_ptr<SharpAcHardwareInterface> link, int fd);
+
+    const std::string name;
+    std::unique_ptr<SharpAcHardwareInterface> link;
+    // Changes when a TCP unit reconnects, -1 while its bridge is down
+    int fd;
+    MeteredLink metered;
+    SharpAcCore core;
+
+    int status = 0;
+    // The link reported a hangup, only the core's timers still run
+    bool linkDown = false;
+    uint32_t connects = 0;
+    uint32_t reconnects = 0;
+    uint64_t stateUpdates = 0;
+    uint64_t loops = 0;
+    // How late loop() ran after the scheduler's due time
+    GatewayLatency lateness;
+
+    // SharpAcStateCallback
+    void on_state_update() override { stateUpdates++; }
+    void on_ion_state_update(bool state) override { (void)state; }
+    void on_vane_horizontal_update(SwingHorizontal val) override { (void)val; }
+    void on_vane_vertical_update(SwingVertical val) override { (void)val; }
+    void on_connection_status_update(int status) override;
+
+private:
+    friend class Gateway;
+    uint64_t due = 0;
+    uint32_t generation = 0;
+    // Set for units on a TCP bridge, whose socket comes and goes
+    SharpTcpPort* tcp = nullptr;
+    uint32_t sockets = 0;
+    uint32_t events = 0;
+};
+
+class Gateway {
+public:
+    Gateway();
+    ~Gateway();
+
+    bool ok() const { return epollFd >= 0; }
+    const char* lastError() const { return error.c_str(); }
+
+    // Takes over a link whose fd becomes readable when it has bytes
+    GatewayUnit* addUnit(const std::string& name, std::unique_ptr<SharpAcHardwareInterface> link, int fd);
+    // Opens a serial port 8E1, nullptr and lastError() if it can't
+    GatewayUnit* addSerialUnit(const std::string& name, const char* path, uint32_t baudRate = 9600);
+    // Connects to a raw TCP serial bridge (ser2net and the like), "host:port"
+    // or "tcp://host:port". The bridge sets the line up, baudRate only
+    // tells the core the character time.
+    GatewayUnit* addTcpUnit(const std::string& name, const std::string& address, uint32_t baudRate = 9600);
+    // Something else to wait on in the same loop, e.g. a control socket
+    bool watch(int fd, std::function<void()> onReadable);
+    void unwatch(int fd);
+
+    // Runs the unit in the next runOnce(). Needed after a control*() call
+    // from outside the loop: the scheduler only knows the core's timers and
+    // would leave the queued frame until the next status poll.
+    void wake(GatewayUnit* unit);
+
+    // Waits up to maxWaitMs for a link or a due timer, runs every unit
+    // that has work and returns how many loop() calls that took
+    int runOnce(int maxWaitMs);
+
+    size_t size() const { return units.size(); }
+    GatewayUnit* unit(size_t index) { return units[index].get(); }
+    GatewayUnit* find(const std::string& name);
+    size_t connectedCount() const;
+
+    // One line per unit with status and latency percentiles
+    void printStats(FILE* out);
+
+    bool verbose = false;
+
+private:
+    struct Timer {
+        uint64_t due;
+        uint32_t generation;
+        uint32_t index;
+        bool operator>(const Timer& other) const { return due > other.due; }
+    };
+
+    struct Watcher {
+        int fd;
+        std::function<void()> onReadable;
+    };
+
+    int epollFd;
+    std::string error;
+    std::vector<std::unique_ptr<GatewayUnit>> units;
+    std::vector<Watcher> watchers;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+
+    // Returns the number of loop() calls
+    int run(uint32_t index, uint64_t now, bool timer);
+    void schedule(uint32_t index, uint64_t now);
+    // Follows a TCP unit's socket across reconnects
+    void track(uint32_t index);
+};
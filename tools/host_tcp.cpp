@@ -0,0 +1,366 @@
+#include "host_tcp.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "core_frame.h"
+
+// Linux reports a write to a closed connection as EPIPE only with this,
+// macOS has the socket option SO_NOSIGPIPE instead
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // Bytes read per recv(), a handful of frames
+    static const size_t RX_CHUNK = 256;
+    // Bytes kept while the socket has no room, beyond that the bridge is
+    // not keeping up and newer bytes are dropped
+    static const size_t TX_LIMIT = 1024;
+
+    static uint64_t monotonicMicros()
+    {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+    }
+
+    SharpTcpPort::SharpTcpPort() : startMicros(monotonicMicros()) {}
+
+    SharpTcpPort::~SharpTcpPort()
+    {
+      this->close();
+    }
+
+    bool SharpTcpPort::parseAddress(const std::string &address, std::string &host, uint16_t &port)
+    {
+      std::string rest = address;
+      if (rest.compare(0, 6, "tcp://") == 0)
+        rest = rest.substr(6);
+      size_t colon = rest.rfind(':');
+      if (colon == std::string::npos || colon == 0 || colon + 1 == rest.size())
+        return false;
+      char *end = nullptr;
+      long number = strtol(rest.c_str() + colon + 1, &end, 10);
+      if (*end != '\0' || number <= 0 || number > 65535)
+        return false;
+      host = rest.substr(0, colon);
+      // [::1]:2000
+      if (host.size() > 2 && host[0] == '[' && host[host.size() - 1] == ']')
+        host = host.substr(1, host.size() - 2);
+      port = static_cast<uint16_t>(number);
+      return true;
+    }
+
+    bool SharpTcpPort::open(const std::string &host, uint16_t port, int timeoutMs)
+    {
+      this->close();
+      this->host = host;
+      this->port = port;
+
+      this->startConnect();
+      // service() moves on to the next address when one fails
+      uint64_t deadline = monotonicMicros() + static_cast<uint64_t>(timeoutMs) * 1000;
+      while (this->state == State::connecting)
+      {
+        uint64_t now = monotonicMicros();
+        struct pollfd pfd = {this->fd, POLLOUT, 0};
+        if (now >= deadline || poll(&pfd, 1, static_cast<int>((deadline - now + 999) / 1000)) <= 0)
+          this->lost("connect timed out", 0);
+        else
+          this->service();
+      }
+      if (this->state != State::connected)
+      {
+        // lost() has the reason and set up a retry, which is not wanted
+        // for a bridge that was never there
+        this->close();
+        return false;
+      }
+      this->error.clear();
+      return true;
+    }
+
+    void SharpTcpPort::close()
+    {
+      if (this->fd >= 0)
+        ::close(this->fd);
+      this->fd = -1;
+      this->state = State::closed;
+      this->addresses.clear();
+      this->rxBuffer.clear();
+      this->rxHead = 0;
+      this->txBuffer.clear();
+    }
+
+    // Resolves again on every attempt, a bridge on DHCP may come back
+    // with a new address
+    void SharpTcpPort::startConnect()
+    {
+      struct addrinfo hints;
+      memset(&hints, 0, sizeof(hints));
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      hints.ai_flags = AI_NUMERICSERV;
+      struct addrinfo *results = nullptr;
+      std::string service = std::to_string(this->port);
+      int resolved = getaddrinfo(this->host.c_str(), service.c_str(), &hints, &results);
+      if (resolved != 0 || results == nullptr)
+      {
+        this->error = this->host + ": " + gai_strerror(resolved);
+        this->lost(nullptr, 0);
+        return;
+      }
+
+      this->addresses.clear();
+      for (struct addrinfo *ai = results; ai != nullptr; ai = ai->ai_next)
+      {
+        Address address;
+        memcpy(&address.addr, ai->ai_addr, ai->ai_addrlen);
+        address.len = ai->ai_addrlen;
+        this->addresses.push_back(address);
+      }
+      freeaddrinfo(results);
+      this->nextAddress = 0;
+      this->connectNext("connect", 0);
+    }
+
+    // Tries the resolved addresses in order, as getaddrinfo() sorted them;
+    // a name with an IPv6 and an IPv4 address still reaches a bridge that
+    // only listens on one of them
+    void SharpTcpPort::connectNext(const char *what, int err)
+    {
+      if (this->fd >= 0)
+        ::close(this->fd);
+      this->fd = -1;
+      while (this->nextAddress < this->addresses.size())
+      {
+        const Address &address = this->addresses[this->nextAddress++];
+        this->fd = socket(address.addr.ss_family, SOCK_STREAM, 0);
+        if (this->fd < 0)
+        {
+          what = "socket";
+          err = errno;
+          continue;
+        }
+        this->sockets++;
+        fcntl(this->fd, F_SETFL, fcntl(this->fd, F_GETFL) | O_NONBLOCK);
+        fcntl(this->fd, F_SETFD, FD_CLOEXEC);
+        int one = 1;
+        setsockopt(this->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+        setsockopt(this->fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        int result = connect(this->fd, reinterpret_cast<const struct sockaddr *>(&address.addr), address.len);
+        // Even an immediate success (loopback) finishes in service()
+        if (result == 0 || errno == EINPROGRESS)
+        {
+          this->state = State::connecting;
+          return;
+        }
+        what = "connect";
+        err = errno;
+        ::close(this->fd);
+        this->fd = -1;
+      }
+      this->lost(what, err);
+    }
+
+    void SharpTcpPort::lost(const char *what, int err)
+    {
+      if (what != nullptr)
+        this->error = this->host + ":" + std::to_string(this->port) + ": " + what + (err != 0 ? ": " : "") +
+                      (err != 0 ? strerror(err) : "");
+      this->log_debug(TAG, "Bridge %s, retrying in %u ms", this->error.c_str(), (unsigned)this->reconnectMs);
+      if (this->fd >= 0)
+        ::close(this->fd);
+      this->fd = -1;
+      this->state = State::waiting;
+      this->retryAt = monotonicMicros() + static_cast<uint64_t>(this->reconnectMs) * 1000;
+      this->rxBuffer.clear();
+      this->rxHead = 0;
+      this->dropped += this->txBuffer.size();
+      this->txBuffer.clear();
+    }
+
+    void SharpTcpPort::service()
+    {
+      if (this->state == State::waiting)
+      {
+        if (monotonicMicros() >= this->retryAt)
+          this->startConnect();
+      }
+
+      if (this->state == State::connecting)
+      {
+        struct pollfd pfd = {this->fd, POLLOUT, 0};
+        if (poll(&pfd, 1, 0) <= 0)
+          return;
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(this->fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0)
+          err = errno;
+        if (err != 0)
+        {
+          this->connectNext("connect", err);
+          return;
+        }
+        this->state = State::connected;
+        if (this->connections++ > 0)
+          this->reconnects++;
+        this->log_debug(TAG, "Bridge %s:%u connected", this->host.c_str(), (unsigned)this->port);
+      }
+
+      if (this->state == State::connected && !this->txBuffer.empty())
+        this->sendPending();
+    }
+
+    void SharpTcpPort::sendPending()
+    {
+      ssize_t sent = send(this->fd, this->txBuffer.data(), this->txBuffer.size(), MSG_NOSIGNAL);
+      this->sends++;
+      if (sent > 0)
+      {
+        this->bytesSent += static_cast<uint64_t>(sent);
+        this->txBuffer.erase(this->txBuffer.begin(), this->txBuffer.begin() + sent);
+      }
+      else if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+      {
+        this->lost("send", errno);
+      }
+    }
+
+    void SharpTcpPort::fill()
+    {
+      if (this->state != State::connected || this->rxHead < this->rxBuffer.size())
+        return;
+      this->rxBuffer.resize(RX_CHUNK);
+      this->rxHead = 0;
+      ssize_t got = recv(this->fd, this->rxBuffer.data(), RX_CHUNK, 0);
+      this->rxBuffer.resize(got > 0 ? static_cast<size_t>(got) : 0);
+      if (got == 0)
+        this->lost("connection closed", 0);
+      else if (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        this->lost("recv", errno);
+    }
+
+    bool SharpTcpPort::wantsWrite() const
+    {
+      return this->state == State::connecting || (this->state == State::connected && !this->txBuffer.empty());
+    }
+
+    uint32_t SharpTcpPort::millisUntilRetry()
+    {
+      if (this->state != State::waiting)
+        return UINT32_MAX;
+      uint64_t now = monotonicMicros();
+      return this->retryAt > now ? static_cast<uint32_t>((this->retryAt - now + 999) / 1000) : 0;
+    }
+
+    size_t SharpTcpPort::available()
+    {
+      this->service();
+      this->fill();
+      return this->rxBuffer.size() - this->rxHead;
+    }
+
+    size_t SharpTcpPort::read_array(uint8_t *data, size_t len)
+    {
+      size_t n = 0;
+      while (n < len)
+      {
+        this->fill();
+        size_t buffered = this->rxBuffer.size() - this->rxHead;
+        if (buffered == 0)
+          break;
+        size_t count = len - n < buffered ? len - n : buffered;
+        memcpy(data + n, this->rxBuffer.data() + this->rxHead, count);
+        this->rxHead += count;
+        n += count;
+      }
+      return n;
+    }
+
+    uint8_t SharpTcpPort::peek()
+    {
+      return this->available() > 0 ? this->rxBuffer[this->rxHead] : 0;
+    }
+
+    uint8_t SharpTcpPort::read()
+    {
+      uint8_t value = 0;
+      this->read_array(&value, 1);
+      return value;
+    }
+
+    void SharpTcpPort::write_array(const uint8_t *data, size_t len)
+    {
+      this->service();
+      if (this->state != State::connected && this->state != State::connecting)
+      {
+        this->dropped += len;
+        return;
+      }
+      size_t room = TX_LIMIT - this->txBuffer.size();
+      if (len > room)
+      {
+        this->log_debug(TAG, "Bridge write dropped %u of %u bytes", (unsigned)(len - room), (unsigned)len);
+        this->dropped += len - room;
+        len = room;
+      }
+      this->txBuffer.insert(this->txBuffer.end(), data, data + len);
+      if (this->state == State::connected)
+        this->sendPending();
+    }
+
+    unsigned long SharpTcpPort::get_millis()
+    {
+      return static_cast<uint32_t>((monotonicMicros() - this->startMicros) / 1000);
+    }
+
+    unsigned long SharpTcpPort::get_micros()
+    {
+      return static_cast<uint32_t>(monotonicMicros() - this->startMicros);
+    }
+
+    void SharpTcpPort::log_debug(const char *tag, const char *format, ...)
+    {
+      if (!this->verbose)
+        return;
+      va_list args;
+      va_start(args, format);
+      fprintf(stderr, "[%s] ", tag);
+      vfprintf(stderr, format, args);
+      fputc('\n', stderr);
+      va_end(args);
+    }
+
+    std::string SharpTcpPort::format_hex_pretty(const uint8_t *data, size_t len)
+    {
+      SharpFrame frame(data, len);
+      char hex[SHARP_HEX_BUFFER_SIZE];
+      frame.formatHex(hex, sizeof(hex));
+      return hex;
+    }
+  }
+}
+
+#endif
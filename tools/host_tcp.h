@@ -0,0 +1,122 @@
+#pragma once
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "core_logic.h"
+
+namespace esphome
+{
+  namespace sharp_ac
+  {
+    // SharpAcHardwareInterface on a TCP connection to a network serial
+    // bridge in raw mode (ser2net `raw`, ESP-Link, most Wi-Fi/Ethernet
+    // serial servers): every byte on the socket is a byte on CN13, the
+    // bridge owns the line settings.
+    //
+    // Nothing blocks once the first connection is up. The socket is
+    // non-blocking with Nagle disabled, since a frame is a few bytes that
+    // wait for an answer. Each frame the core writes goes out in one
+    // send(); whatever the socket couldn't take yet stays in a small buffer
+    // and leaves together with the next frame. Received bytes are read in
+    // chunks, so available() costs one recv() per empty buffer.
+    //
+    // When the bridge drops the connection the port reconnects on its own
+    // after reconnectMs, while the core carries on: bytes written in
+    // between are dropped like on a disconnected cable and the core's
+    // response timeout restarts the handshake if the AC missed something.
+    class SharpTcpPort : public SharpAcHardwareInterface
+    {
+    public:
+      SharpTcpPort();
+      ~SharpTcpPort() override;
+
+      // Splits "host:port" or "tcp://host:port", false if it is neither
+      static bool parseAddress(const std::string &address, std::string &host, uint16_t &port);
+
+      // Connects to the bridge, waiting up to timeoutMs. Returns false and
+      // keeps the reason in lastError() if it can't be reached.
+      bool open(const std::string &host, uint16_t port, int timeoutMs = 3000);
+      void close();
+      bool isOpen() const { return this->state != State::closed; }
+      bool isConnected() const { return this->state == State::connected; }
+      // -1 while waiting to reconnect, a new socket after each reconnect
+      int getFd() const { return this->fd; }
+      // Counts the sockets opened, tells a reconnect from a reused fd number
+      uint32_t getSockets() const { return this->sockets; }
+      // Connecting, or bytes waiting for room in the socket: worth waking
+      // up for the socket becoming writable
+      bool wantsWrite() const;
+      // Milliseconds until the next reconnect attempt, UINT32_MAX if none
+      // is pending
+      uint32_t millisUntilRetry();
+      const char *lastError() const { return this->error.c_str(); }
+
+      size_t read_array(uint8_t *data, size_t len) override;
+      size_t available() override;
+      void write_array(const uint8_t *data, size_t len) override;
+      uint8_t peek() override;
+      uint8_t read() override;
+      unsigned long get_millis() override;
+      unsigned long get_micros() override;
+      // Prints to stderr, only when verbose is set
+      void log_debug(const char *tag, const char *format, ...) override;
+      bool log_debug_enabled() override { return this->verbose; }
+      std::string format_hex_pretty(const uint8_t *data, size_t len) override;
+
+      bool verbose{false};
+      uint32_t reconnectMs{2000};
+
+      // send() calls, bytes handed to the socket and bytes dropped while
+      // the bridge was unreachable
+      uint64_t sends{0};
+      uint64_t bytesSent{0};
+      uint64_t dropped{0};
+      uint32_t reconnects{0};
+
+    private:
+      enum class State
+      {
+        closed,
+        waiting,
+        connecting,
+        connected
+      };
+
+      void startConnect();
+      void connectNext(const char *what, int err);
+      void service();
+      void fill();
+      void sendPending();
+      void lost(const char *what, int err);
+
+      State state{State::closed};
+      int fd{-1};
+      uint32_t sockets{0};
+      uint32_t connections{0};
+      std::string host;
+      uint16_t port{0};
+      struct Address
+      {
+        struct sockaddr_storage addr;
+        socklen_t len;
+      };
+      std::vector<Address> addresses;
+      size_t nextAddress{0};
+      uint64_t retryAt{0};
+      std::vector<uint8_t> rxBuffer;
+      size_t rxHead{0};
+      std::vector<uint8_t> txBuffer;
+      uint64_t startMicros;
+      std::string error;
+    };
+  }
+}
+
+#endif
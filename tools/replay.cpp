@@ -0,0 +1,395 @@
+// Replays a captured UART log through SharpAcCore
+//
+//   replay [options] capture.log|capture.bin
+//
+//   --connected      Start connected instead of waiting for a handshake in
+//                    the capture (detected automatically if omitted)
+//   --repeat N       Replay the capture N times with a fresh core each time,
+//                    for throughput numbers
+//   --states FILE    Write the decoded state after every RX frame
+//   --record FILE    Write the traffic of the first pass as a binary capture,
+//                    times counted from the start of the replay
+//   --expect FILE    Compare the decoded states with a file written by
+//                    --states, exit 1 on any difference
+//   -v               Print every mismatch
+//
+// RX frames from the capture are fed to the core as fast as possible on a
+// virtual clock that follows the capture timestamps. The TX frames the core
+// writes are diffed against the captured TX frames: event driven frames
+// (handshake, ACKs) in order, status polls by count since their phase
+// depends on when the unit booted. Command frames come from Home Assistant,
+// not from the core, and are only counted.
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "core_logic.h"
+#include "binary_capture.h"
+
+using namespace esphome::sharp_ac;
+
+// ============================================================================
+// Replay Hardware
+// ============================================================================
+
+class ReplayHardware : public SharpAcHardwareInterface {
+public:
+    uint64_t clock = 0;
+    std::deque<uint8_t> rx;
+    // Every frame the core wrote
+    std::vector<std::vector<uint8_t>> emitted;
+
+    size_t read_array(uint8_t* data, size_t len) override {
+        size_t count = 0;
+        while (count < len && !rx.empty()) {
+            data[count++] = rx.front();
+            rx.pop_front();
+        }
+        return count;
+    }
+
+    size_t available() override { return rx.size(); }
+
+    void write_array(const uint8_t* data, size_t len) override {
+        emitted.push_back(std::vector<uint8_t>(data, data + len));
+    }
+
+    uint8_t peek() override { return rx.empty() ? 0 : rx.front(); }
+
+    uint8_t read() override {
+        uint8_t value = 0;
+        read_array(&value, 1);
+        return value;
+    }
+
+    unsigned long get_millis() override { return static_cast<uint32_t>(clock / 1000); }
+    unsigned long get_micros() override { return static_cast<uint32_t>(clock); }
+
+    void log_debug(const char* tag, const char* format, ...) override {
+        (void)tag;
+        (void)format;
+    }
+
+    std::string format_hex_pretty(const uint8_t* data, size_t len) override {
+        SharpFrame frame(data, len);
+        char hex[SHARP_HEX_BUFFER_SIZE];
+        frame.formatHex(hex, sizeof(hex));
+        return hex;
+    }
+};
+
+class ReplayCallback : public SharpAcStateCallback {
+public:
+    void on_state_update() override {}
+    void on_ion_state_update(bool state) override { (void)state; }
+    void on_vane_horizontal_update(SwingHorizontal val) override { (void)val; }
+    void on_vane_vertical_update(SwingVertical val) override { (void)val; }
+    void on_connection_status_update(int status) override { (void)status; }
+};
+
+class ReplayCore : public SharpAcCore {
+public:
+    ReplayCore(SharpAcHardwareInterface* hardware, SharpAcStateCallback* callback) : SharpAcCore(hardware, callback) {}
+
+    // Captures that start mid-session never show the handshake
+    void setConnected() {
+        this->status = 8;
+        this->previousMillis = this->nowMillis();
+    }
+};
+
+// ============================================================================
+// Frame Classes
+// ============================================================================
+
+static bool isPoll(const std::vector<uint8_t>& f) { return f.size() >= 3 && f[0] == 0xdd && f[1] == 0x02 && f[2] == 0xfd; }
+static bool isCommand(const std::vector<uint8_t>& f) { return f.size() >= 3 && f[0] == 0xdd && f[2] == 0xfb; }
+static bool isInit(const std::vector<uint8_t>& f) {
+    return f.size() >= sizeof(init_msg) && memcmp(f.data(), init_msg, sizeof(init_msg)) == 0;
+}
+static bool isConnectedMsg(const std::vector<uint8_t>& f) {
+    return f.size() >= sizeof(connected_msg) && memcmp(f.data(), connected_msg, sizeof(connected_msg)) == 0;
+}
+
+static std::string hex(const std::vector<uint8_t>& bytes) {
+    SharpFrame frame(bytes.data(), bytes.size());
+    char buf[SHARP_HEX_BUFFER_SIZE];
+    frame.formatHex(buf, sizeof(buf));
+    return buf;
+}
+
+static std::string describe(const SharpState& s, float room) {
+    char line[160];
+    snprintf(line, sizeof(line), "power=%d mode=%d fan=%d temp=%d swingH=%d swingV=%d preset=%d ion=%d room=%.1f",
+             s.state ? 1 : 0, static_cast<int>(s.mode), static_cast<int>(s.fan), s.temperature,
+             static_cast<int>(s.swingH), static_cast<int>(s.swingV), static_cast<int>(s.preset), s.ion ? 1 : 0, room);
+    return line;
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+struct ReplayReport {
+    uint64_t rxFrames = 0;
+    uint64_t expectedTx = 0;
+    uint64_t matchedTx = 0;
+    uint64_t mismatchedTx = 0;
+    uint64_t missingTx = 0;
+    uint64_t extraTx = 0;
+    uint64_t expectedPolls = 0;
+    uint64_t emittedPolls = 0;
+    uint64_t commands = 0;
+    double decodeNanos = 0;
+    double maxDecodeNanos = 0;
+    std::vector<std::string> states;
+};
+
+static void runLoop(ReplayHardware& hw, ReplayCore& core, uint64_t until) {
+    // Like ESPHome: loop() about every 16ms while busy, skip idle stretches
+    while (hw.clock < until) {
+        core.loop();
+        uint32_t due = core.millisUntilDue();
+        uint64_t step = due == 0 ? 16000 : static_cast<uint64_t>(due) * 1000;
+        hw.clock = hw.clock + step < until ? hw.clock + step : until;
+    }
+}
+
+// Walks both event driven TX sequences, resynchronizing after a mismatch
+static void diffTx(const std::vector<std::vector<uint8_t>>& expected, const std::vector<std::vector<uint8_t>>& emitted,
+                   ReplayReport& report, bool verbose) {
+    size_t e = 0, m = 0;
+    while (e < expected.size() && m < emitted.size()) {
+        if (expected[e] == emitted[m]) {
+            report.matchedTx++;
+            e++;
+            m++;
+            continue;
+        }
+
+        // A frame only on one side?
+        size_t skipE = 0, skipM = 0;
+        for (size_t k = 1; k <= 8 && !skipE && !skipM; k++) {
+            if (e + k < expected.size() && expected[e + k] == emitted[m]) skipE = k;
+            else if (m + k < emitted.size() && emitted[m + k] == expected[e]) skipM = k;
+        }
+        if (skipE) {
+            report.missingTx += skipE;
+            if (verbose) printf("  missing TX #%zu: %s\n", e, hex(expected[e]).c_str());
+            e += skipE;
+        } else if (skipM) {
+            report.extraTx += skipM;
+            if (verbose) printf("  extra TX: %s\n", hex(emitted[m]).c_str());
+            m += skipM;
+        } else {
+            report.mismatchedTx++;
+            if (verbose) printf("  TX #%zu: expected %s, got %s\n", e, hex(expected[e]).c_str(), hex(emitted[m]).c_str());
+            e++;
+            m++;
+        }
+    }
+    report.missingTx += expected.size() - e;
+    report.extraTx += emitted.size() - m;
+}
+
+// One pass over the capture with a fresh core
+static void replay(const std::vector<CaptureFrame>& capture, bool connected, bool recordStates,
+                   BinaryCaptureWriter* recorder, ReplayReport& report, bool verbose) {
+    ReplayHardware hw;
+    ReplayCallback callback;
+    TracingHardwareInterface tracing(&hw, recorder);
+    ReplayCore core(recorder ? static_cast<SharpAcHardwareInterface*>(&tracing) : &hw, &callback);
+    core.setup();
+    if (connected) {
+        core.setConnected();
+    }
+
+    uint64_t origin = 0;
+    for (size_t i = 0; i < capture.size(); i++) {
+        if (capture[i].timed) {
+            origin = capture[i].timeMicros;
+            break;
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> expected;
+    bool captureConnected = connected;
+    uint64_t last = 0;
+    for (size_t i = 0; i < capture.size(); i++) {
+        const CaptureFrame& frame = capture[i];
+        // Untimed lines: assume 20ms between frames
+        uint64_t at = frame.timed ? frame.timeMicros - origin : last + 20000;
+        if (at > hw.clock) runLoop(hw, core, at);
+        last = at;
+
+        if (frame.tx) {
+            if (isCommand(frame.bytes)) {
+                report.commands++;
+            } else if (isPoll(frame.bytes) && captureConnected) {
+                report.expectedPolls++;
+            } else {
+                if (isInit(frame.bytes)) captureConnected = false;
+                if (isConnectedMsg(frame.bytes)) captureConnected = true;
+                expected.push_back(frame.bytes);
+            }
+            continue;
+        }
+
+        // RX: decode the frame and let the core answer it, mode and status
+        // frames add a line to the state sequence
+        report.rxFrames++;
+        hw.rx.insert(hw.rx.end(), frame.bytes.begin(), frame.bytes.end());
+        auto start = std::chrono::steady_clock::now();
+        core.loop();
+        double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        report.decodeNanos += nanos;
+        if (nanos > report.maxDecodeNanos) report.maxDecodeNanos = nanos;
+
+        if (recordStates && frame.bytes[0] == 0xdc) {
+            report.states.push_back(describe(core.getState(), core.getCurrentTemperature()));
+        }
+    }
+    runLoop(hw, core, hw.clock + 1000000);
+
+    // Separate timer driven polls from the core output the same way
+    std::vector<std::vector<uint8_t>> events;
+    bool coreConnected = connected;
+    for (size_t i = 0; i < hw.emitted.size(); i++) {
+        const std::vector<uint8_t>& bytes = hw.emitted[i];
+        if (isPoll(bytes) && coreConnected) {
+            report.emittedPolls++;
+            continue;
+        }
+        if (isInit(bytes)) coreConnected = false;
+        if (isConnectedMsg(bytes)) coreConnected = true;
+        events.push_back(bytes);
+    }
+
+    report.expectedTx += expected.size();
+    diffTx(expected, events, report, verbose);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static int usage() {
+    fprintf(stderr, "usage: replay [--connected] [--repeat N] [--states FILE] [--record FILE] [--expect FILE] [-v]\n"
+                    "              capture.log|capture.bin\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    const char* statesPath = nullptr;
+    const char* recordPath = nullptr;
+    const char* expectPath = nullptr;
+    int connected = -1;
+    int repeat = 1;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--connected") == 0) connected = 1;
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--states") == 0 && i + 1 < argc) statesPath = argv[++i];
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (strcmp(argv[i], "--expect") == 0 && i + 1 < argc) expectPath = argv[++i];
+        else if (strcmp(argv[i], "-v") == 0) verbose = true;
+        else if (argv[i][0] == '-' || path) return usage();
+        else path = argv[i];
+    }
+    if (!path || repeat < 1) return usage();
+
+    std::vector<CaptureFrame> capture;
+    if (!loadCapture(path, capture)) {
+        fprintf(stderr, "replay: cannot read %s\n", path);
+        return 2;
+    }
+
+    // A capture that opens with our init message shows the handshake
+    if (connected < 0) {
+        connected = 1;
+        for (size_t i = 0; i < capture.size(); i++) {
+            if (capture[i].tx) {
+                connected = isInit(capture[i].bytes) ? 0 : 1;
+                break;
+            }
+        }
+    }
+
+    BinaryCaptureWriter recorder;
+    if (recordPath && !recorder.open(recordPath, 0)) {
+        fprintf(stderr, "replay: cannot write %s\n", recordPath);
+        return 2;
+    }
+
+    ReplayReport report;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < repeat; pass++) {
+        bool first = pass == 0;
+        replay(capture, connected == 1, first, first && recorder.isOpen() ? &recorder : nullptr, report,
+               verbose && first);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    recorder.close();
+
+    printf("Capture:        %s (%zu frames, %s)\n", path, capture.size(), connected ? "connected" : "with handshake");
+    printf("RX frames:      %llu in %.3f s, %.0f frames/s\n", (unsigned long long)report.rxFrames, seconds,
+           report.rxFrames / (seconds > 0 ? seconds : 1e-9));
+    printf("Decode cost:    avg %.0f ns, max %.0f ns per RX frame\n",
+           report.rxFrames ? report.decodeNanos / report.rxFrames : 0.0, report.maxDecodeNanos);
+    printf("TX frames:      %llu expected, %llu matched, %llu differing, %llu missing, %llu extra\n",
+           (unsigned long long)report.expectedTx, (unsigned long long)report.matchedTx,
+           (unsigned long long)report.mismatchedTx, (unsigned long long)report.missingTx,
+           (unsigned long long)report.extraTx);
+    printf("Status polls:   %llu captured, %llu emitted\n", (unsigned long long)report.expectedPolls,
+           (unsigned long long)report.emittedPolls);
+    printf("Commands:       %llu (from Home Assistant, not replayed)\n", (unsigned long long)report.commands);
+
+    bool ok = report.mismatchedTx == 0 && report.missingTx == 0 && report.extraTx == 0;
+    long long pollDiff = static_cast<long long>(report.expectedPolls) - static_cast<long long>(report.emittedPolls);
+    ok &= pollDiff >= -repeat && pollDiff <= repeat;
+
+    if (statesPath) {
+        FILE* out = fopen(statesPath, "w");
+        if (!out) {
+            fprintf(stderr, "replay: cannot write %s\n", statesPath);
+            return 2;
+        }
+        for (size_t i = 0; i < report.states.size(); i++) fprintf(out, "%s\n", report.states[i].c_str());
+        fclose(out);
+    }
+
+    if (expectPath) {
+        FILE* in = fopen(expectPath, "r");
+        if (!in) {
+            fprintf(stderr, "replay: cannot read %s\n", expectPath);
+            return 2;
+        }
+        char line[256];
+        size_t index = 0, differing = 0;
+        while (fgets(line, sizeof(line), in)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (index >= report.states.size() || report.states[index] != line) {
+                if (verbose || differing == 0) {
+                    printf("  state #%zu: expected \"%s\", got \"%s\"\n", index, line,
+                           index < report.states.size() ? report.states[index].c_str() : "(none)");
+                }
+                differing++;
+            }
+            index++;
+        }
+        fclose(in);
+        if (index != report.states.size()) differing++;
+        printf("States:         %zu decoded, %zu differ from %s\n", report.states.size(), differing, expectPath);
+        ok &= differing == 0;
+    }
+
+    printf("%s\n", ok ? "OK" : "MISMATCH");
+    return ok ? 0 : 1;
+}
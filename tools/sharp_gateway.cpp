@@ -0,0 +1,191 @@
+// Drives many AC units from one Linux host, one serial port or network
+// serial bridge per unit
+//
+//   sharp_gateway [options] [name=]device...
+//
+//   --baud N         Baud rate of every port (default 9600), for bridges
+//                    it must match the bridge's own setting
+//   --stats S        Print the per unit metrics every S seconds (default 60,
+//                    0 turns it off)
+//   -v               Print every message of every core
+//
+// A device is a serial device path, or tcp://host:port for a bridge in raw
+// mode (ser2net, ESP-Link). Units are named after their device unless
+// given as name=device. All ports run on one thread, see gateway.h.
+// Commands are read from stdin, one per line, where <unit> is a unit name
+// or * for all of them:
+//
+//   <unit> on|off
+//   <unit> mode cool|heat|dry|fan
+//   <unit> temp 16..30
+//   <unit> fan auto|low|mid|high|highest
+//   <unit> reconnect
+//   state            The decoded state of every unit
+//   stats            The metrics of every unit
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "gateway.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) { running = 0; }
+
+static void printState(GatewayUnit& unit) {
+    const SharpState& s = unit.core.getState();
+    printf("%-16s %s mode=%d fan=%d temp=%d swingH=%d swingV=%d preset=%d ion=%d room=%.1f\n", unit.name.c_str(),
+           s.state ? "on " : "off", static_cast<int>(s.mode), static_cast<int>(s.fan), s.temperature,
+           static_cast<int>(s.swingH), static_cast<int>(s.swingV), static_cast<int>(s.preset), s.ion ? 1 : 0,
+           unit.core.getCurrentTemperature());
+}
+
+// False if the command is not understood
+static bool apply(Gateway& gateway, GatewayUnit& unit, const std::string& verb, const std::string& arg) {
+    SharpAcCore& core = unit.core;
+    if (verb == "on" || verb == "off") {
+        core.controlMode(core.getState().mode, verb == "on");
+    } else if (verb == "mode") {
+        if (arg == "cool") core.controlMode(PowerMode::cool, true);
+        else if (arg == "heat") core.controlMode(PowerMode::heat, true);
+        else if (arg == "dry") core.controlMode(PowerMode::dry, true);
+        else if (arg == "fan") core.controlMode(PowerMode::fan, true);
+        else return false;
+    } else if (verb == "temp") {
+        int temperature = atoi(arg.c_str());
+        if (temperature < 16 || temperature > 30) return false;
+        core.controlTemperature(temperature);
+    } else if (verb == "fan") {
+        if (arg == "auto") core.controlFan(FanMode::auto_fan);
+        else if (arg == "low") core.controlFan(FanMode::low);
+        else if (arg == "mid") core.controlFan(FanMode::mid);
+        else if (arg == "high") core.controlFan(FanMode::high);
+        else if (arg == "highest") core.controlFan(FanMode::highest);
+        else return false;
+    } else if (verb == "reconnect") {
+        core.resetConnection();
+    } else {
+        return false;
+    }
+    gateway.wake(&unit);
+    return true;
+}
+
+static void command(Gateway& gateway, const std::string& line) {
+    char target[64] = "", verb[32] = "", arg[32] = "";
+    int fields = sscanf(line.c_str(), "%63s %31s %31s", target, verb, arg);
+    if (fields < 1) return;
+
+    if (strcmp(target, "stats") == 0) {
+        gateway.printStats(stdout);
+    } else if (strcmp(target, "state") == 0) {
+        for (size_t i = 0; i < gateway.size(); i++) printState(*gateway.unit(i));
+    } else if (strcmp(target, "*") == 0) {
+        for (size_t i = 0; i < gateway.size(); i++) {
+            if (!apply(gateway, *gateway.unit(i), verb, arg)) {
+                printf("? %s\n", line.c_str());
+                break;
+            }
+        }
+    } else {
+        GatewayUnit* unit = gateway.find(target);
+        if (unit == nullptr) printf("no unit %s\n", target);
+        else if (!apply(gateway, *unit, verb, arg)) printf("? %s\n", line.c_str());
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    uint32_t baudRate = 9600;
+    int statsSeconds = 60;
+    bool verbose = false;
+    std::vector<std::string> devices;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+            baudRate = static_cast<uint32_t>(atol(argv[++i]));
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            statsSeconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [--baud N] [--stats S] [-v] [name=]device...\n", argv[0]);
+            return 2;
+        } else {
+            devices.push_back(argv[i]);
+        }
+    }
+    if (devices.empty()) {
+        fprintf(stderr, "usage: %s [--baud N] [--stats S] [-v] [name=]device...\n", argv[0]);
+        return 2;
+    }
+
+    Gateway gateway;
+    if (!gateway.ok()) {
+        fprintf(stderr, "%s\n", gateway.lastError());
+        return 1;
+    }
+    gateway.verbose = verbose;
+
+    for (size_t i = 0; i < devices.size(); i++) {
+        std::string name = devices[i];
+        std::string path = devices[i];
+        size_t equals = devices[i].find('=');
+        if (equals != std::string::npos) {
+            name = devices[i].substr(0, equals);
+            path = devices[i].substr(equals + 1);
+        } else if (name.compare(0, 6, "tcp://") == 0) {
+            name = name.substr(6);
+        } else if (name.rfind('/') != std::string::npos) {
+            name = name.substr(name.rfind('/') + 1);
+        }
+        GatewayUnit* unit = path.compare(0, 6, "tcp://") == 0 ? gateway.addTcpUnit(name, path, baudRate)
+                                                              : gateway.addSerialUnit(name, path.c_str(), baudRate);
+        if (unit == nullptr) {
+            fprintf(stderr, "%s\n", gateway.lastError());
+            return 1;
+        }
+    }
+
+    std::string input;
+    fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+    gateway.watch(STDIN_FILENO, [&]() {
+        char buffer[512];
+        ssize_t got = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (got <= 0) {
+            // EOF: keep running without commands
+            if (got == 0) gateway.unwatch(STDIN_FILENO);
+            return;
+        }
+        input.append(buffer, static_cast<size_t>(got));
+        size_t end;
+        while ((end = input.find('\n')) != std::string::npos) {
+            command(gateway, input.substr(0, end));
+            input.erase(0, end + 1);
+        }
+    });
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    fprintf(stderr, "%zu units\n", gateway.size());
+
+    time_t nextStats = statsSeconds > 0 ? time(nullptr) + statsSeconds : 0;
+    while (running) {
+        gateway.runOnce(1000);
+        if (nextStats != 0 && time(nullptr) >= nextStats) {
+            gateway.printStats(stdout);
+            fflush(stdout);
+            nextStats += statsSeconds;
+        }
+    }
+
+    gateway.printStats(stdout);
+    return 0;
+}
@@ -0,0 +1,368 @@
+// Aggregates decoded frames over large UART capture logs
+//
+//   trace_stats [-j N] [--scaling] capture.log|capture.bin...
+//
+//   -j N         Decode with N threads (default: all cores)
+//   --scaling    Decode once per thread count from 1 to N and report the
+//                throughput of each, to check the decoder scales with cores
+//
+// Every file is memory-mapped and cut into one chunk per thread. Chunks end
+// at line breaks, and since the text logs carry one frame per line that is
+// also a frame boundary, so the threads never share a frame. Each thread
+// decodes its RX mode and status frames through SharpModeFrame and
+// SharpStatusFrame into its own counters, which are summed at the end.
+// Binary captures are cut at their index entries instead, each thread
+// reading its range through its own BinaryCaptureReader.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "core_frame.h"
+#include "binary_capture.h"
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+struct TraceStats {
+    uint64_t lines;
+    uint64_t bytes;
+    uint64_t rxFrames;
+    uint64_t txFrames;
+    uint64_t acks;
+    uint64_t modeFrames;
+    uint64_t statusFrames;
+    uint64_t commandFrames;
+    uint64_t otherFrames;
+    // Checksum failures of mode, status and other frames
+    uint64_t badMode;
+    uint64_t badStatus;
+    uint64_t badOther;
+    // Indexed by the raw nibble, so unexpected values show up too
+    uint64_t mode[16];
+    uint64_t fan[16];
+    uint64_t swingV[16];
+    uint64_t swingH[16];
+    uint64_t preset[3];
+    uint64_t power[2];
+    uint64_t ion[2];
+    // Set point from mode frames, room temperature from status frames
+    uint64_t setpoint[32];
+    uint64_t room[64];
+
+    void merge(const TraceStats& other) {
+        const uint64_t* in = reinterpret_cast<const uint64_t*>(&other);
+        uint64_t* out = reinterpret_cast<uint64_t*>(this);
+        for (size_t i = 0; i < sizeof(TraceStats) / sizeof(uint64_t); i++) out[i] += in[i];
+    }
+};
+
+static void decodeFrame(const CaptureFrame& frame, TraceStats& stats) {
+    const std::vector<uint8_t>& b = frame.bytes;
+    if (frame.tx) {
+        stats.txFrames++;
+        if (b.size() == 14 && b[0] == 0xdd && b[2] == 0xfb) stats.commandFrames++;
+        return;
+    }
+
+    stats.rxFrames++;
+    if (b.size() == 1) {
+        stats.acks++;
+        return;
+    }
+
+    SharpFrame raw(b.data(), b.size());
+    bool valid = raw.validateChecksum();
+
+    if (b.size() == 14 && b[0] == 0xdc && b[1] == 0x0b) {
+        if (!valid) {
+            stats.badMode++;
+            return;
+        }
+        SharpModeFrame mode(b.data());
+        stats.modeFrames++;
+        stats.mode[static_cast<int>(mode.getPowerMode()) & 0x0F]++;
+        stats.fan[static_cast<int>(mode.getFanMode()) & 0x0F]++;
+        stats.swingV[static_cast<int>(mode.getSwingVertical()) & 0x0F]++;
+        stats.swingH[static_cast<int>(mode.getSwingHorizontal()) & 0x0F]++;
+        stats.preset[static_cast<int>(mode.getPreset()) % 3]++;
+        stats.power[mode.getState() ? 1 : 0]++;
+        stats.ion[mode.getIon() ? 1 : 0]++;
+        stats.setpoint[mode.getTemperature() & 0x1F]++;
+    } else if (b.size() == 18 && b[0] == 0xdc && b[1] == 0x0f) {
+        if (!valid) {
+            stats.badStatus++;
+            return;
+        }
+        SharpStatusFrame status(b.data());
+        stats.statusFrames++;
+        stats.room[status.getTemperature() & 0x3F]++;
+    } else {
+        if (!valid) stats.badOther++;
+        stats.otherFrames++;
+    }
+}
+
+// Decodes the whole lines in [begin, end)
+static void decodeChunk(const char* begin, const char* end, TraceStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->bytes = end - begin;
+
+    char line[1024];
+    CaptureFrame frame;
+    const char* p = begin;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        size_t len = eol - p;
+        if (len >= sizeof(line)) len = sizeof(line) - 1;
+        memcpy(line, p, len);
+        line[len] = '\0';
+        p = eol + 1;
+
+        stats->lines++;
+        if (parseCaptureLine(line, frame)) decodeFrame(frame, *stats);
+    }
+}
+
+// ============================================================================
+// Files
+// ============================================================================
+
+struct MappedFile {
+    const char* data;
+    size_t size;
+};
+
+static bool mapFile(const char* path, MappedFile& file) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    file.size = st.st_size;
+    file.data = nullptr;
+    if (file.size > 0) {
+        void* map = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(map, file.size, MADV_SEQUENTIAL);
+        file.data = static_cast<const char*>(map);
+    }
+    close(fd);
+    return true;
+}
+
+// Cuts all files into about threads chunks of equal size, each ending
+// after a line break
+static void splitChunks(const std::vector<MappedFile>& files, unsigned threads,
+                        std::vector<std::pair<const char*, const char*>>& chunks) {
+    size_t total = 0;
+    for (size_t i = 0; i < files.size(); i++) total += files[i].size;
+    size_t target = total / threads + 1;
+
+    for (size_t i = 0; i < files.size(); i++) {
+        const char* p = files[i].data;
+        const char* end = p + files[i].size;
+        while (p < end) {
+            const char* cut = end - p > static_cast<ptrdiff_t>(target) ? p + target : end;
+            if (cut < end) {
+                const char* eol = static_cast<const char*>(memchr(cut, '\n', end - cut));
+                cut = eol ? eol + 1 : end;
+            }
+            chunks.push_back(std::make_pair(p, cut));
+            p = cut;
+        }
+    }
+}
+
+// Records between two index entries of a binary capture, last == entries
+// reads to the end
+struct BinaryRange {
+    const char* path;
+    uint32_t first;
+    uint32_t last;
+};
+
+static void decodeRange(BinaryRange range, TraceStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    BinaryCaptureReader reader;
+    if (!reader.open(range.path)) return;
+    if (reader.isIndexed()) {
+        reader.range(reader.indexOffset(range.first), reader.indexTime(range.first),
+                     range.last < reader.getIndexEntries() ? reader.indexOffset(range.last) : 0);
+    }
+
+    CaptureFrame frame;
+    while (reader.next(frame)) {
+        stats->lines++;
+        stats->bytes += frame.bytes.size();
+        decodeFrame(frame, *stats);
+    }
+}
+
+static void splitRanges(const std::vector<const char*>& paths, unsigned threads, std::vector<BinaryRange>& ranges) {
+    for (size_t i = 0; i < paths.size(); i++) {
+        BinaryCaptureReader reader;
+        if (!reader.open(paths[i])) continue;
+        uint32_t entries = reader.getIndexEntries();
+        if (entries == 0) {
+            // Not closed: no index, one thread scans it all
+            BinaryRange range = {paths[i], 0, 0};
+            ranges.push_back(range);
+            continue;
+        }
+        uint32_t parts = threads < entries ? threads : entries;
+        for (uint32_t p = 0; p < parts; p++) {
+            BinaryRange range = {paths[i], static_cast<uint32_t>(static_cast<uint64_t>(entries) * p / parts),
+                                 static_cast<uint32_t>(static_cast<uint64_t>(entries) * (p + 1) / parts)};
+            ranges.push_back(range);
+        }
+    }
+}
+
+static TraceStats decodeAll(const std::vector<MappedFile>& files, const std::vector<const char*>& binaries,
+                            unsigned threads) {
+    std::vector<std::pair<const char*, const char*>> chunks;
+    splitChunks(files, threads, chunks);
+    std::vector<BinaryRange> ranges;
+    splitRanges(binaries, threads, ranges);
+
+    std::vector<TraceStats> partial(chunks.size() + ranges.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        workers.push_back(std::thread(decodeChunk, chunks[i].first, chunks[i].second, &partial[i]));
+    }
+    for (size_t i = 0; i < ranges.size(); i++) {
+        workers.push_back(std::thread(decodeRange, ranges[i], &partial[chunks.size() + i]));
+    }
+
+    TraceStats total;
+    memset(&total, 0, sizeof(total));
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+        total.merge(partial[i]);
+    }
+    return total;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+static void printDistribution(const char* name, const uint64_t* counts, size_t n, const char* const* labels,
+                              int offset) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += counts[i];
+    if (sum == 0) return;
+
+    printf("\n%s\n", name);
+    for (size_t i = 0; i < n; i++) {
+        if (counts[i] == 0) continue;
+        if (labels && labels[i]) printf("  %-10s", labels[i]);
+        else printf("  %-10d", static_cast<int>(i) + offset);
+        printf(" %12llu  %5.1f%%\n", static_cast<unsigned long long>(counts[i]), 100.0 * counts[i] / sum);
+    }
+}
+
+static void printReport(const TraceStats& s) {
+    static const char* const modes[16] = {nullptr, "heat", "cool", "dry", "fan"};
+    static const char* const fans[16] = {nullptr, nullptr, "auto", "mid", "low", "high", nullptr, "highest"};
+    static const char* const presets[3] = {"none", "eco", "fullpower"};
+    static const char* const onOff[2] = {"off", "on"};
+    static const char* const swingV[16] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                           "auto", "highest", "high", "mid", "low", "lowest", nullptr, "swing"};
+    static const char* const swingH[16] = {nullptr, "middle", "right", "left", nullptr, nullptr, nullptr, nullptr,
+                                           nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, "swing"};
+
+    printf("Lines/records:  %llu\n", static_cast<unsigned long long>(s.lines));
+    printf("RX frames:      %llu (%llu ACK, %llu mode, %llu status, %llu other)\n",
+           static_cast<unsigned long long>(s.rxFrames), static_cast<unsigned long long>(s.acks),
+           static_cast<unsigned long long>(s.modeFrames), static_cast<unsigned long long>(s.statusFrames),
+           static_cast<unsigned long long>(s.otherFrames));
+    printf("TX frames:      %llu (%llu commands)\n", static_cast<unsigned long long>(s.txFrames),
+           static_cast<unsigned long long>(s.commandFrames));
+    printf("Bad checksums:  %llu mode, %llu status, %llu other\n", static_cast<unsigned long long>(s.badMode),
+           static_cast<unsigned long long>(s.badStatus), static_cast<unsigned long long>(s.badOther));
+
+    printDistribution("Power", s.power, 2, onOff, 0);
+    printDistribution("Mode", s.mode, 16, modes, 0);
+    printDistribution("Fan", s.fan, 16, fans, 0);
+    printDistribution("Preset", s.preset, 3, presets, 0);
+    printDistribution("Ion", s.ion, 2, onOff, 0);
+    printDistribution("Vane vertical", s.swingV, 16, swingV, 0);
+    printDistribution("Vane horizontal", s.swingH, 16, swingH, 0);
+    printDistribution("Set point (C)", s.setpoint, 32, nullptr, 0);
+    printDistribution("Room temperature (C)", s.room, 64, nullptr, 0);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+static int usage() {
+    fprintf(stderr, "usage: trace_stats [-j N] [--scaling] capture.log|capture.bin...\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    bool scaling = false;
+    std::vector<MappedFile> files;
+    std::vector<const char*> binaries;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            if (n < 1) return usage();
+            threads = n;
+        } else if (strcmp(argv[i], "--scaling") == 0) {
+            scaling = true;
+        } else if (argv[i][0] == '-') {
+            return usage();
+        } else if (BinaryCaptureReader::isBinaryCapture(argv[i])) {
+            binaries.push_back(argv[i]);
+        } else {
+            MappedFile file;
+            if (!mapFile(argv[i], file)) {
+                fprintf(stderr, "trace_stats: cannot map %s\n", argv[i]);
+                return 2;
+            }
+            files.push_back(file);
+        }
+    }
+    if (files.empty() && binaries.empty()) return usage();
+
+    TraceStats stats;
+    unsigned first = scaling ? 1 : threads;
+    for (unsigned n = first; n <= threads; n++) {
+        auto start = std::chrono::steady_clock::now();
+        stats = decodeAll(files, binaries, n);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds <= 0) seconds = 1e-9;
+        printf("%2u threads:     %.3f s, %.1f MB/s, %.0f frames/s\n", n, seconds, stats.bytes / seconds / 1e6,
+               (stats.rxFrames + stats.txFrames) / seconds);
+    }
+    printf("\n");
+    printReport(stats);
+
+    for (size_t i = 0; i < files.size(); i++) {
+        if (files[i].data) munmap(const_cast<char*>(files[i].data), files[i].size);
+    }
+    return 0;
+}